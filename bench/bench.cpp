@@ -0,0 +1,211 @@
+/***********************************
+ * bench.cpp
+ *
+ * Benchmark of the iou kernels: reproducible
+ * random shapes, timing and allocation counts.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "bench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<long long> _alloc_count(0);
+const double PI = 3.14159265358979323846;
+}
+
+// Count every allocation of the process.
+// GCC takes free() after the inlined replaced new for a mismatch.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size)
+{
+    ++_alloc_count;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == 0)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+namespace Bench
+{
+
+volatile double sink = 0.0;
+
+long long allocCount()
+{
+    return _alloc_count.load();
+}
+
+ShapeGen::ShapeGen(const unsigned int seed, const double _overlap)
+    : engine(seed), overlap(_overlap)
+{
+}
+
+double ShapeGen::uniform(const double a, const double b)
+{
+    return std::uniform_real_distribution<double>(a, b)(engine);
+}
+
+Point ShapeGen::offset(const double r1, const double r2)
+{
+    // Over: centers closer than half the sum of the radii.
+    // Apart: circles disjoint, so the shapes are too.
+    const double d = uniform(0.0, 1.0) < overlap ?
+        uniform(0.0, 0.5) * (r1 + r2) :
+        uniform(1.05, 2.0) * (r1 + r2);
+    const double a = uniform(0.0, 2.0*PI);
+    return Point(d*cos(a), d*sin(a));
+}
+
+RotatedRect ShapeGen::rotatedRect()
+{
+    return RotatedRect(uniform(0.0, 1000.0), uniform(0.0, 1000.0),
+                       uniform(5.0, 50.0), uniform(5.0, 50.0),
+                       uniform(-PI, PI));
+}
+RotatedRect ShapeGen::rotatedRectNear(const RotatedRect &R)
+{
+    RotatedRect R2 = rotatedRect();
+    const double r1 = sqrt(R.w*R.w + R.h*R.h) / 2.0;
+    const double r2 = sqrt(R2.w*R2.w + R2.h*R2.h) / 2.0;
+    R2.center = R.center + offset(r1, r2);
+    return R2;
+}
+
+Vertexes ShapeGen::polygonAt(const Point &center, const int n)
+{
+    // Decreasing angles on an ellipse give a convex clockwise polygon.
+    std::vector<double> angs(n);
+    for (int i = 0; i < n; ++i)
+        angs[i] = uniform(0.0, 2.0*PI);
+    std::sort(angs.begin(), angs.end());
+    const double ra = uniform(10.0, 25.0);
+    const double rb = uniform(10.0, 25.0);
+    const double phi = uniform(-PI, PI);
+    const Point u(cos(phi), sin(phi));
+    const Point v(-sin(phi), cos(phi));
+    Vertexes C;
+    C.reserve(n);
+    for (int i = n - 1; i >= 0; --i)
+        C.push_back(center + u*(ra*cos(angs[i])) + v*(rb*sin(angs[i])));
+    return C;
+}
+Vertexes ShapeGen::polygon(const int n)
+{
+    return polygonAt(Point(uniform(0.0, 1000.0), uniform(0.0, 1000.0)), n);
+}
+Vertexes ShapeGen::polygonNear(const Vertexes &C, const int n)
+{
+    Point center(0.0, 0.0);
+    for (size_t i = 0; i < C.size(); ++i)
+        center = center + C[i];
+    center = center / (double)C.size();
+    return polygonAt(center + offset(25.0, 25.0), n);
+}
+
+namespace
+{
+Pointf toFloat(const Point &p)
+{
+    return Pointf((float)p.x, (float)p.y);
+}
+Vertexesf toFloat(const Vertexes &C)
+{
+    Vertexesf Cf;
+    Cf.reserve(C.size());
+    for (size_t i = 0; i < C.size(); ++i)
+        Cf.push_back(toFloat(C[i]));
+    return Cf;
+}
+Quadf toFloat(const Quad &Q)
+{
+    return Quadf(toFloat(Q.p1()), toFloat(Q.p2()), toFloat(Q.p3()), toFloat(Q.p4()));
+}
+} // namespace
+
+DataSet::DataSet(const int nPairs, const int nSides,
+                 const unsigned int seed, const double overlap)
+{
+    ShapeGen gen(seed, overlap);
+    for (int i = 0; i < nPairs; ++i) {
+        const RotatedRect R1 = gen.rotatedRect();
+        const RotatedRect R2 = gen.rotatedRectNear(R1);
+        rot1.push_back(R1);
+        rot2.push_back(R2);
+        quad1.push_back(R1.toQuad());
+        quad2.push_back(R2.toQuad());
+
+        // Axis-aligned rectangles of the same sizes and centers.
+        rect1.push_back(Rect(R1.center.x - R1.w/2.0, R1.center.y - R1.h/2.0,
+                             R1.center.x + R1.w/2.0, R1.center.y + R1.h/2.0));
+        rect2.push_back(Rect(R2.center.x - R2.w/2.0, R2.center.y - R2.h/2.0,
+                             R2.center.x + R2.w/2.0, R2.center.y + R2.h/2.0));
+
+        poly1.push_back(gen.polygon(nSides));
+        poly2.push_back(gen.polygonNear(poly1.back(), nSides));
+
+        quadf1.push_back(toFloat(quad1.back()));
+        quadf2.push_back(toFloat(quad2.back()));
+        polyf1.push_back(toFloat(poly1.back()));
+        polyf2.push_back(toFloat(poly2.back()));
+    }
+}
+
+Result measure(const std::string &name, const long long nPairs, const int repeat,
+               const std::function<void()> &body)
+{
+    typedef std::chrono::steady_clock Clock;
+    body();
+
+    double best = -1.0;
+    long long allocs = 0;
+    for (int r = 0; r < std::max(repeat, 1); ++r) {
+        const long long a0 = allocCount();
+        const Clock::time_point t0 = Clock::now();
+        body();
+        const double t = std::chrono::duration<double>(Clock::now() - t0).count();
+        allocs = allocCount() - a0;
+        if (best < 0.0 || t < best)
+            best = t;
+    }
+
+    Result res;
+    res.name = name;
+    res.nsPerPair = best * 1e9 / nPairs;
+    res.pairsPerSec = best > 0.0 ? nPairs / best : 0.0;
+    res.allocsPerPair = (double)allocs / nPairs;
+    return res;
+}
+
+void printHeader()
+{
+    std::printf("%-36s %12s %14s %14s\n", "kernel", "ns/pair", "pairs/s", "allocs/pair");
+}
+void printResult(const Result &r)
+{
+    std::printf("%-36s %12.2f %14.4g %14.3f\n",
+                r.name.c_str(), r.nsPerPair, r.pairsPerSec, r.allocsPerPair);
+}
+
+}
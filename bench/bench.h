@@ -0,0 +1,83 @@
+/***********************************
+ * bench.h
+ *
+ * Benchmark of the iou kernels: reproducible
+ * random shapes, timing and allocation counts.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_BENCH_H_FILE_
+#define _IOU_BENCH_H_FILE_
+
+#include "../src/iou.h"
+#include "../src/rect.h"
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Bench
+{
+    using namespace IOU;
+
+    // Random shapes in pairs. With probability overlap the second shape of
+    // a pair is placed over the first one, otherwise apart from it, so
+    // that overlap sets the ratio of pairs going through the full
+    // intersection instead of an early-out.
+    class ShapeGen {
+    public:
+        ShapeGen(const unsigned int seed, const double overlap);
+
+        RotatedRect rotatedRect();
+        RotatedRect rotatedRectNear(const RotatedRect &R);
+        // Convex polygon of n vertexes on an ellipse, clockwise.
+        Vertexes polygon(const int n);
+        Vertexes polygonNear(const Vertexes &C, const int n);
+
+    private:
+        double uniform(const double a, const double b);
+        // Offset of the second center for shapes of circle radii r1 and r2.
+        Point offset(const double r1, const double r2);
+        Vertexes polygonAt(const Point &center, const int n);
+
+        std::mt19937 engine;
+        double overlap;
+    };
+
+    // Data set of nPairs pairs of each kind, from the same seed.
+    struct DataSet {
+        DataSet(const int nPairs, const int nSides,
+                const unsigned int seed, const double overlap);
+
+        std::vector<Rect> rect1, rect2;
+        std::vector<RotatedRect> rot1, rot2;
+        std::vector<Quad> quad1, quad2;
+        std::vector<Vertexes> poly1, poly2;
+        // Same quadrilaterals and polygons in single precision.
+        std::vector<Quadf> quadf1, quadf2;
+        std::vector<Vertexesf> polyf1, polyf2;
+    };
+
+    // Number of calls to operator new so far.
+    long long allocCount();
+
+    struct Result {
+        std::string name;
+        double nsPerPair;
+        double pairsPerSec;
+        double allocsPerPair;
+    };
+
+    // Run body, which handles nPairs pairs, repeat times after one warm-up
+    // run, and keep the fastest run.
+    Result measure(const std::string &name, const long long nPairs, const int repeat,
+                   const std::function<void()> &body);
+
+    void printHeader();
+    void printResult(const Result &r);
+
+    // Sink for computed values, so the compiler keeps the loops.
+    extern volatile double sink;
+}
+#endif // !_IOU_BENCH_H_FILE_
@@ -0,0 +1,49 @@
+TEMPLATE = app
+CONFIG += console c++11 release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+TARGET = bench
+
+unix: LIBS += -lpthread
+
+SOURCES += \
+    ../src/convexset.cpp \
+    ../src/evaluator.cpp \
+    ../src/incremental.cpp \
+    ../src/iou.cpp \
+    ../src/join.cpp \
+    ../src/nms.cpp \
+    ../src/polyfile.cpp \
+    ../src/predicates.cpp \
+    ../src/rect.cpp \
+    ../src/rtree.cpp \
+    ../src/shard.cpp \
+    ../src/simd.cpp \
+    ../src/simd_avx2.cpp \
+    ../src/stats.cpp \
+    ../src/threadpool.cpp \
+    bench.cpp \
+    main.cpp
+
+HEADERS += \
+    ../src/convexset.h \
+    ../src/evaluator.h \
+    ../src/fileio.h \
+    ../src/fixed.h \
+    ../src/gpu.h \
+    ../src/incremental.h \
+    ../src/iou.h \
+    ../src/join.h \
+    ../src/nms.h \
+    ../src/polyfile.h \
+    ../src/predicates.h \
+    ../src/rect.h \
+    ../src/rtree.h \
+    ../src/shard.h \
+    ../src/simd.h \
+    ../src/simd_kernel.h \
+    ../src/stats.h \
+    ../src/sweep.h \
+    ../src/threadpool.h \
+    bench.h
@@ -0,0 +1,455 @@
+/***********************************
+ * main.cpp
+ *
+ * Benchmark of the iou kernels.
+ *
+ * Usage: bench [-n pairs] [-s sides] [-o overlap]
+ *              [-r repeat] [-t threads] [-seed seed]
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "bench.h"
+#include "../src/convexset.h"
+#include "../src/evaluator.h"
+#include "../src/fixed.h"
+#ifdef IOU_ENABLE_CUDA
+#include "../src/gpu.h"
+#endif
+#include "../src/incremental.h"
+#include "../src/join.h"
+#include "../src/rtree.h"
+#include "../src/shard.h"
+#include "../src/simd.h"
+#include "../src/stats.h"
+#include "../src/threadpool.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Bench;
+
+namespace
+{
+
+struct Options {
+    int nPairs;
+    int nSides;
+    double overlap;
+    int repeat;
+    int nThreads;
+    unsigned int seed;
+};
+
+bool parseOptions(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc)
+            return false;
+        const char *key = argv[i];
+        const char *val = argv[++i];
+        if (std::strcmp(key, "-n") == 0)
+            opt.nPairs = std::atoi(val);
+        else if (std::strcmp(key, "-s") == 0)
+            opt.nSides = std::atoi(val);
+        else if (std::strcmp(key, "-o") == 0)
+            opt.overlap = std::atof(val);
+        else if (std::strcmp(key, "-r") == 0)
+            opt.repeat = std::atoi(val);
+        else if (std::strcmp(key, "-t") == 0)
+            opt.nThreads = std::atoi(val);
+        else if (std::strcmp(key, "-seed") == 0)
+            opt.seed = (unsigned int)std::strtoul(val, 0, 10);
+        else
+            return false;
+    }
+    return opt.nPairs > 0 && opt.nSides >= 3 && opt.overlap >= 0.0 && opt.overlap <= 1.0;
+}
+
+// Levels the running CPU supports, the others would fall back.
+bool available(const SimdLevel level)
+{
+    const SimdLevel best = simdLevel();
+    switch (level) {
+    case SimdScalar: return true;
+    case SimdSSE2:   return best == SimdSSE2 || best == SimdAVX2;
+    case SimdAVX2:   return best == SimdAVX2;
+    case SimdNEON:   return best == SimdNEON;
+    default:         return false;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    opt.nPairs = 100000;
+    opt.nSides = 8;
+    opt.overlap = 0.5;
+    opt.repeat = 5;
+    opt.nThreads = 0;
+    opt.seed = 2018;
+    if (!parseOptions(argc, argv, opt)) {
+        std::fprintf(stderr, "Usage: %s [-n pairs] [-s sides] [-o overlap]"
+                     " [-r repeat] [-t threads] [-seed seed]\n", argv[0]);
+        return 1;
+    }
+
+    const DataSet D(opt.nPairs, opt.nSides, opt.seed, opt.overlap);
+    const int N = opt.nPairs;
+    std::printf("pairs %d, sides %d, overlap %.2f, seed %u, simd %s\n\n",
+                N, opt.nSides, opt.overlap, opt.seed, simdLevelName(simdLevel()));
+    printHeader();
+
+    // Pairwise kernels.
+    printResult(measure("iou(Rect)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iou(D.rect1[i], D.rect2[i]);
+        sink = s;
+    }));
+    printResult(measure("iou(RotatedRect)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iou(D.rot1[i], D.rot2[i]);
+        sink = s;
+    }));
+    printResult(measure("iou(Quad)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iou(D.quad1[i], D.quad2[i]);
+        sink = s;
+    }));
+    printResult(measure("iou(Quad, ConvexClip)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iou(D.quad1[i], D.quad2[i], ConvexClip);
+        sink = s;
+    }));
+    printResult(measure("iou(Quad, RobustSoup)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iou(D.quad1[i], D.quad2[i], RobustSoup);
+        sink = s;
+    }));
+    printResult(measure("iou(Quadf)", N, opt.repeat, [&]() {
+        float s = 0.0f;
+        for (int i = 0; i < N; ++i)
+            s += iou(D.quadf1[i], D.quadf2[i]);
+        sink = s;
+    }));
+    {
+        std::vector<std::array<Point, 4> > A1(N), A2(N);
+        for (int i = 0; i < N; ++i) {
+            std::copy(D.quad1[i].data(), D.quad1[i].data() + 4, A1[i].begin());
+            std::copy(D.quad2[i].data(), D.quad2[i].data() + 4, A2[i].begin());
+        }
+        printResult(measure("iou<4,4>(std::array)", N, opt.repeat, [&]() {
+            double s = 0.0;
+            for (int i = 0; i < N; ++i)
+                s += iou(A1[i], A2[i]);
+            sink = s;
+        }));
+    }
+    printResult(measure("iouEx", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iouEx(D.poly1[i], D.poly2[i]);
+        sink = s;
+    }));
+    printResult(measure("iouEx(ConvexClip)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iouEx(D.poly1[i], D.poly2[i], ConvexClip);
+        sink = s;
+    }));
+    printResult(measure("iouEx(RobustSoup)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iouEx(D.poly1[i], D.poly2[i], RobustSoup);
+        sink = s;
+    }));
+    printResult(measure("iouEx(PolygonView)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iouEx(PolygonView(D.poly1[i]), PolygonView(D.poly2[i]));
+        sink = s;
+    }));
+    printResult(measure("iouEx(StridedPolygonView)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iouEx(StridedPolygonView(&D.poly1[i][0].x, D.poly1[i].size()),
+                       StridedPolygonView(&D.poly2[i][0].x, D.poly2[i].size()));
+        sink = s;
+    }));
+    {
+        Vertexes inter;
+        printResult(measure("intersectionPolygonEx", N, opt.repeat, [&]() {
+            int s = 0;
+            for (int i = 0; i < N; ++i)
+                s += intersectionPolygonEx(D.poly1[i], D.poly2[i], inter);
+            sink = s;
+        }));
+    }
+    {
+        // The polygons as unordered point sets, normalized again.
+        std::vector<Vertexes> soups(D.poly1);
+        for (int i = 0; i < N; ++i)
+            std::reverse(soups[i].begin() + soups[i].size() / 2, soups[i].end());
+        Vertexes work;
+        printResult(measure("convexHullEx", N, opt.repeat, [&]() {
+            int s = 0;
+            for (int i = 0; i < N; ++i) {
+                work = soups[i];
+                s += convexHullEx(work);
+            }
+            sink = s;
+        }));
+        printResult(measure("simplifyEx(0.1)", N, opt.repeat, [&]() {
+            int s = 0;
+            for (int i = 0; i < N; ++i) {
+                work = D.poly1[i];
+                s += simplifyEx(work, 0.1);
+            }
+            sink = s;
+        }));
+    }
+    printResult(measure("iouMetricsEx(MetricAll)", N, opt.repeat, [&]() {
+        double s = 0.0;
+        for (int i = 0; i < N; ++i)
+            s += iouMetricsEx(D.poly1[i], D.poly2[i]).giou;
+        sink = s;
+    }));
+    printResult(measure("iouAboveEx(0.5)", N, opt.repeat, [&]() {
+        int s = 0;
+        for (int i = 0; i < N; ++i)
+            s += iouAboveEx(D.poly1[i], D.poly2[i], 0.5);
+        sink = s;
+    }));
+    printResult(measure("iouEx(float)", N, opt.repeat, [&]() {
+        float s = 0.0f;
+        for (int i = 0; i < N; ++i)
+            s += iouEx(D.polyf1[i], D.polyf2[i]);
+        sink = s;
+    }));
+    {
+        std::vector<PreparedPolygon> P1, P2;
+        for (int i = 0; i < N; ++i) {
+            P1.push_back(PreparedPolygon(D.poly1[i]));
+            P2.push_back(PreparedPolygon(D.poly2[i]));
+        }
+        printResult(measure("iou(PreparedPolygon)", N, opt.repeat, [&]() {
+            double s = 0.0;
+            for (int i = 0; i < N; ++i)
+                s += iou(P1[i], P2[i]);
+            sink = s;
+        }));
+        printResult(measure("iou(PreparedPolygon, ConvexClip)", N, opt.repeat, [&]() {
+            double s = 0.0;
+            for (int i = 0; i < N; ++i)
+                s += iou(P1[i], P2[i], ConvexClip);
+            sink = s;
+        }));
+        printResult(measure("iouAbove(PreparedPolygon, 0.5)", N, opt.repeat, [&]() {
+            int s = 0;
+            for (int i = 0; i < N; ++i)
+                s += iouAbove(P1[i], P2[i], 0.5);
+            sink = s;
+        }));
+    }
+
+    // One-vs-many, each query against a batch of the next shapes.
+    const int batchSize = 64;
+    const int nBatches = N / batchSize;
+    if (nBatches > 0) {
+        std::vector<RectBatch> rects(nBatches);
+        std::vector<RotatedRectBatch> rots(nBatches);
+        for (int i = 0; i < nBatches * batchSize; ++i) {
+            rects[i / batchSize].push_back(D.rect2[i]);
+            rots[i / batchSize].push_back(D.rot2[i]);
+        }
+        std::vector<float> out(nBatches * batchSize);
+        const long long nPairs = (long long)nBatches * batchSize;
+        const SimdLevel levels[] = { SimdScalar, SimdSSE2, SimdAVX2, SimdNEON };
+        for (int l = 0; l < 4; ++l) {
+            const SimdLevel level = levels[l];
+            if (!available(level))
+                continue;
+            printResult(measure(std::string("iouOneToMany(Rect, ") + simdLevelName(level) + ")",
+                                nPairs, opt.repeat, [&]() {
+                for (int k = 0; k < nBatches; ++k)
+                    iouOneToMany(D.rect1[k], rects[k], &out[k*batchSize], level);
+                sink = out[0];
+            }));
+            printResult(measure(std::string("iouOneToMany(RotatedRect, ") + simdLevelName(level) + ")",
+                                nPairs, opt.repeat, [&]() {
+                for (int k = 0; k < nBatches; ++k)
+                    iouOneToMany(D.rot1[k], rots[k], &out[k*batchSize], level);
+                sink = out[0];
+            }));
+        }
+    }
+
+    // Matrices of m x m over the first shapes.
+    int m = 1;
+    while ((long long)(m + 1) * (m + 1) <= N && m < 1024)
+        ++m;
+    {
+        const std::vector<Quad> A(D.quad1.begin(), D.quad1.begin() + m);
+        const std::vector<Quad> B(D.quad2.begin(), D.quad2.begin() + m);
+        std::vector<double> out((size_t)m * m);
+        printResult(measure("iouMatrix", (long long)m * m, opt.repeat, [&]() {
+            iouMatrix(A, B, out.data());
+            sink = out[0];
+        }));
+        ThreadPool pool(opt.nThreads);
+        char name[64];
+        std::sprintf(name, "iouMatrixParallel(%d threads)", pool.size());
+        printResult(measure(name, (long long)m * m, opt.repeat, [&]() {
+            iouMatrixParallel(A, B, out.data(), pool);
+            sink = out[0];
+        }));
+    }
+#ifdef IOU_ENABLE_CUDA
+    // Same pairs as rotated rectangles resident on the device.
+    if (gpuAvailable()) {
+        RotatedRectBatch rA, rB;
+        for (int i = 0; i < m; ++i) {
+            rA.push_back(D.rot1[i]);
+            rB.push_back(D.rot2[i]);
+        }
+        const GpuRotatedRectBatch A(rA), B(rB);
+        std::vector<float> out((size_t)m * m);
+        printResult(measure("iouMatrixGpu", (long long)m * m, opt.repeat, [&]() {
+            iouMatrixGpu(A, B, out.data());
+            sink = out[0];
+        }));
+        std::vector<float> scores(m);
+        for (int i = 0; i < m; ++i)
+            scores[i] = float((i * 37) % m) / m;
+        std::vector<int> keep;
+        printResult(measure("nmsRotatedGpu(0.5)", m, opt.repeat, [&]() {
+            nmsRotatedGpu(A, scores, 0.5, keep);
+            sink = keep.size();
+        }));
+    }
+#endif
+
+    // Sparse join of the first shapes with the second ones.
+    printResult(measure("iouJoin(0.5)", N, opt.repeat, [&]() {
+        size_t s = 0;
+        iouJoin(D.quad1, D.quad2, 0.5, [&](const IouPair *, const int n) { s += n; });
+        sink = s;
+    }));
+
+    // Same join of the first shapes with themselves, in 16 tiles read from
+    // a plan file, followed by the merge.
+    {
+        const std::string polyPath = "bench_shard.poly";
+        const std::string planPath = "bench_shard.plan";
+        PolygonFile F;
+        ShardPlan plan;
+        if (writePolygonFile(polyPath, D.poly1) && F.open(polyPath)) {
+            plan.build(F, 16);
+            if (plan.write(planPath)) {
+                const int T = shardTileCount(planPath);
+                printResult(measure("shardJoin(16 tiles, 0.5)", N, opt.repeat, [&]() {
+                    std::vector<std::vector<IouPair> > parts(T);
+                    ShardTile tile;
+                    for (int t = 0; t < T; ++t) {
+                        if (readShardTile(planPath, t, tile))
+                            shardJoin(F, F, tile, 0.5, parts[t]);
+                    }
+                    sink = mergeShardPairs(parts).size();
+                }));
+            }
+            F.close();
+        }
+        std::remove(planPath.c_str());
+        std::remove(polyPath.c_str());
+    }
+
+    // Objects made of 8 consecutive shapes each, compared part by part.
+    {
+        const int parts = 8;
+        std::vector<ConvexSet> S1(N / parts), S2(N / parts);
+        for (int i = 0; i < (N / parts) * parts; ++i) {
+            S1[i / parts].add(D.quad1[i]);
+            S2[i / parts].add(D.quad2[i]);
+        }
+        printResult(measure("iouSet(8 parts)", (long long)S1.size() * parts * parts,
+                            opt.repeat, [&]() {
+            double s = 0.0;
+            for (size_t i = 0; i < S1.size(); ++i)
+                s += iouSet(S1[i], S2[i]);
+            sink = s;
+        }));
+    }
+
+    // Pairs tracked over frames, the second shape moving a little each
+    // time.
+    {
+        std::vector<IncrementalIou> tracked(N);
+        for (int i = 0; i < N; ++i)
+            tracked[i].reset(D.poly1[i], D.poly2[i]);
+        printResult(measure("IncrementalIou::moveSecond", N, opt.repeat, [&]() {
+            double s = 0.0;
+            for (int i = 0; i < N; ++i)
+                s += tracked[i].moveSecond(0.001, Point(0.01, 0.0));
+            sink = s;
+        }));
+    }
+
+    // Images of 64 detections, the first shapes, and 64 ground truths,
+    // the second ones.
+    {
+        const int perImage = 64;
+        const int nImages = N / perImage;
+        ThreadPool pool(opt.nThreads);
+        printResult(measure("StreamingEvaluator::run(64/image)",
+                            (long long)nImages * perImage * perImage, opt.repeat, [&]() {
+            StreamingEvaluator ev(std::vector<double>(1, 0.5), pool);
+            int k = 0;
+            ev.run([&](EvalImage &image) {
+                if (k == nImages)
+                    return false;
+                const int i0 = k++ * perImage;
+                image.detections.assign(D.poly1.begin() + i0, D.poly1.begin() + i0 + perImage);
+                image.groundTruths.assign(D.poly2.begin() + i0, D.poly2.begin() + i0 + perImage);
+                image.scores.resize(perImage);
+                for (int i = 0; i < perImage; ++i)
+                    image.scores[i] = double((i0 + i) % 97) / 97.0;
+                return true;
+            });
+            sink = ev.averagePrecision();
+        }));
+    }
+
+    // Index over all the second shapes, queried with the first ones.
+    {
+        PolygonRTree tree;
+        printResult(measure("PolygonRTree::build", N, opt.repeat, [&]() {
+            tree.build(D.quad2);
+            sink = tree.size();
+        }));
+        printResult(measure("PolygonRTree::queryAbove(0.5)", N, opt.repeat, [&]() {
+            size_t s = 0;
+            for (int i = 0; i < N; ++i)
+                s += tree.queryAbove(D.quad1[i], 0.5).size();
+            sink = s;
+        }));
+        printResult(measure("PolygonRTree::topK(5)", N, opt.repeat, [&]() {
+            size_t s = 0;
+            for (int i = 0; i < N; ++i)
+                s += tree.topK(D.quad1[i], 5).size();
+            sink = s;
+        }));
+    }
+
+    if (statsEnabled()) {
+        std::printf("\nStats of all the runs:\n");
+        dumpStats(collectStats());
+    }
+    return 0;
+}
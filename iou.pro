@@ -25,12 +25,44 @@ else:win32:CONFIG(debug, debug|release): \
 
 
 SOURCES += \
+    src/convexset.cpp \
+    src/evaluator.cpp \
+    src/incremental.cpp \
     src/iou.cpp \
+    src/join.cpp \
+    src/nms.cpp \
+    src/polyfile.cpp \
+    src/predicates.cpp \
+    src/rect.cpp \
+    src/rtree.cpp \
+    src/shard.cpp \
+    src/simd.cpp \
+    src/simd_avx2.cpp \
+    src/stats.cpp \
+    src/threadpool.cpp \
     test/main.cpp \
     test/test.cpp \
 
 HEADERS += \
+    src/convexset.h \
+    src/evaluator.h \
+    src/fileio.h \
+    src/fixed.h \
+    src/gpu.h \
+    src/incremental.h \
     src/iou.h \
+    src/join.h \
+    src/nms.h \
+    src/polyfile.h \
+    src/predicates.h \
+    src/rect.h \
+    src/rtree.h \
+    src/shard.h \
+    src/simd.h \
+    src/simd_kernel.h \
+    src/stats.h \
+    src/sweep.h \
+    src/threadpool.h \
     test/test.h
 
 DISTFILES += \
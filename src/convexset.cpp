@@ -0,0 +1,152 @@
+/***********************************
+ * convexset.cpp
+ *
+ * Objects made of several convex parts,
+ * e.g. convex decompositions of masks.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "convexset.h"
+#include "sweep.h"
+#include <algorithm>
+
+namespace IOU
+{
+
+namespace
+{
+
+struct XMinLess
+{
+    explicit XMinLess(const std::vector<PreparedPolygon> &_parts) : parts(_parts) {}
+    bool operator()(const int a, const int b) const {
+        return parts[a].boundingBox().xMin < parts[b].boundingBox().xMin;
+    }
+    const std::vector<PreparedPolygon> &parts;
+};
+
+} // namespace
+
+ConvexSet::ConvexSet()
+    : areaV(0.0)
+{
+}
+ConvexSet::ConvexSet(const std::vector<Vertexes> &_parts)
+    : areaV(0.0)
+{
+    parts.reserve(_parts.size());
+    for (size_t i = 0; i < _parts.size(); ++i) {
+        PreparedPolygon P(_parts[i]);
+        if (P.isValid())
+            append(P);
+    }
+    sortParts();
+}
+ConvexSet::ConvexSet(const std::vector<Quad> &_parts)
+    : areaV(0.0)
+{
+    parts.reserve(_parts.size());
+    for (size_t i = 0; i < _parts.size(); ++i) {
+        PreparedPolygon P(_parts[i]);
+        if (P.isValid())
+            append(P);
+    }
+    sortParts();
+}
+
+bool ConvexSet::add(const Vertexes &part)
+{
+    PreparedPolygon P(part);
+    if (!P.isValid())
+        return false;
+    insert(P);
+    return true;
+}
+bool ConvexSet::add(const Quad &part)
+{
+    PreparedPolygon P(part);
+    if (!P.isValid())
+        return false;
+    insert(P);
+    return true;
+}
+void ConvexSet::clear()
+{
+    parts.clear();
+    order.clear();
+    areaV = 0.0;
+    box = AABB();
+}
+
+void ConvexSet::append(const PreparedPolygon &P)
+{
+    const AABB &b = P.boundingBox();
+    if (parts.empty())
+        box = b;
+    else {
+        box.xMin = std::min(box.xMin, b.xMin);
+        box.yMin = std::min(box.yMin, b.yMin);
+        box.xMax = std::max(box.xMax, b.xMax);
+        box.yMax = std::max(box.yMax, b.yMax);
+    }
+    areaV += P.area();
+    parts.push_back(P);
+}
+void ConvexSet::insert(const PreparedPolygon &P)
+{
+    // Keep the sweep order, after the parts of equal xMin.
+    const int n = parts.size();
+    append(P);
+    order.insert(std::upper_bound(order.begin(), order.end(), n, XMinLess(parts)), n);
+}
+void ConvexSet::sortParts()
+{
+    order.resize(parts.size());
+    for (int i = 0; i < (int)parts.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), XMinLess(parts));
+}
+
+double areaIntersection(const ConvexSet &S1, const ConvexSet &S2,
+                        const InterMethod method)
+{
+    if (S1.empty() || S2.empty() ||
+        !S1.boundingBox().overlaps(S2.boundingBox()))
+        return 0.0;
+
+    // Sweep the parts of both sets along x, pruned by their bounding boxes.
+    double inter = 0.0;
+    const bool valid = sweep::sweepPairs(
+        S1.sweepOrder(), [&](const int i) -> const AABB& { return S1.part(i).boundingBox(); },
+        S2.sweepOrder(), [&](const int j) -> const AABB& { return S2.part(j).boundingBox(); },
+        [&](const bool from1, const int n, const int m) {
+            const PreparedPolygon &P = S1.part(from1 ? n : m);
+            const PreparedPolygon &Q = S2.part(from1 ? m : n);
+            if (!P.mayOverlap(Q))
+                return true;
+            const double a = areaIntersection(P, Q, method);
+            inter += a;
+            return a >= 0.0;
+        });
+    if (!valid)
+        return -1.0;
+    return inter;
+}
+double areaUnion(const ConvexSet &S1, const ConvexSet &S2, const InterMethod method)
+{
+    const double inter = areaIntersection(S1, S2, method);
+    if (inter < 0.0)
+        return -1.0;
+    return S1.area() + S2.area() - inter;
+}
+double iouSet(const ConvexSet &S1, const ConvexSet &S2, const InterMethod method)
+{
+    const double inter = areaIntersection(S1, S2, method);
+    if (inter < 0.0)
+        return -1.0;
+    const double uni = S1.area() + S2.area() - inter;
+    return uni > 0.0 ? inter/uni : 0.0;
+}
+
+}
@@ -0,0 +1,65 @@
+/***********************************
+ * convexset.h
+ *
+ * Objects made of several convex parts,
+ * e.g. convex decompositions of masks.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_CONVEXSET_H_FILE_
+#define _IOU_CONVEXSET_H_FILE_
+
+#include "iou.h"
+
+namespace IOU
+{
+    // Union of convex parts with disjoint interiors, each prepared once.
+    // Its area is the sum of those of its parts, and its intersection with
+    // another set the sum of those of every pair of parts.
+    class ConvexSet {
+    public:
+        // Constructors.
+        ConvexSet();
+        explicit ConvexSet(const std::vector<Vertexes> &parts);
+        explicit ConvexSet(const std::vector<Quad> &parts);
+
+        // Add a part. Returns false, leaving the set unchanged, if it is
+        // NoneWise.
+        bool add(const Vertexes &part);
+        bool add(const Quad &part);
+        void clear();
+
+        // Methods.
+        int size() const { return parts.size(); }
+        bool empty() const { return parts.empty(); }
+        const PreparedPolygon& part(const int i) const { return parts[i]; }
+        double area() const { return areaV; }
+        // Bounding box of all the parts, meaningless if empty.
+        const AABB& boundingBox() const { return box; }
+        // Indexes of the parts by increasing xMin of their bounding box.
+        const std::vector<int>& sweepOrder() const { return order; }
+
+    private:
+        void append(const PreparedPolygon &P);
+        void insert(const PreparedPolygon &P);
+        void sortParts();
+
+        std::vector<PreparedPolygon> parts;
+        std::vector<int> order;
+        double areaV;
+        AABB box;
+    };
+
+    // Pairs of parts are pruned by their bounding boxes along a sweep of
+    // both sets, then by their bounding circles, before the intersection.
+    // All three return -1 if PointSoup cannot order the intersection of
+    // a pair of parts. iouSet is 0 for two empty sets.
+    double areaIntersection(const ConvexSet &S1, const ConvexSet &S2,
+                            const InterMethod method = PointSoup);
+    double areaUnion(const ConvexSet &S1, const ConvexSet &S2,
+                     const InterMethod method = PointSoup);
+    double iouSet(const ConvexSet &S1, const ConvexSet &S2,
+                  const InterMethod method = PointSoup);
+}
+#endif // !_IOU_CONVEXSET_H_FILE_
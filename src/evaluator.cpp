@@ -0,0 +1,248 @@
+/***********************************
+ * evaluator.cpp
+ *
+ * Streaming average precision of detections
+ * against ground truths, image by image.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "evaluator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace IOU
+{
+
+namespace
+{
+
+struct ScoreGreater
+{
+    explicit ScoreGreater(const std::vector<double> &_scores) : scores(_scores) {}
+    bool operator()(const int a, const int b) const {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    }
+    const std::vector<double> &scores;
+};
+
+inline int scoreBin(const double score, const int nBins)
+{
+    if (!(score > 0.0))
+        return 0;
+    return std::min(int(score * nBins), nBins - 1);
+}
+
+} // namespace
+
+StreamingEvaluator::StreamingEvaluator(const std::vector<double> &_thresholds,
+                                       const int nThreads, const int _nBins,
+                                       const InterMethod _method)
+    : thresholds(_thresholds), nBins(std::max(_nBins, 1)), method(_method),
+      pool(new ThreadPool(nThreads)), ownPool(true)
+{
+    init();
+}
+StreamingEvaluator::StreamingEvaluator(const std::vector<double> &_thresholds,
+                                       ThreadPool &_pool, const int _nBins,
+                                       const InterMethod _method)
+    : thresholds(_thresholds), nBins(std::max(_nBins, 1)), method(_method),
+      pool(&_pool), ownPool(false)
+{
+    init();
+}
+StreamingEvaluator::~StreamingEvaluator()
+{
+    if (ownPool)
+        delete pool;
+}
+
+void StreamingEvaluator::init()
+{
+    truePositives.assign(thresholds.size() * nBins, 0);
+    falsePositives.assign(thresholds.size() * nBins, 0);
+    nImages = 0;
+    nGroundTruths = 0;
+    nDetections = 0;
+}
+void StreamingEvaluator::reset()
+{
+    init();
+}
+
+bool StreamingEvaluator::add(const EvalImage &image)
+{
+    const std::vector<Vertexes> &D = image.detections;
+    const std::vector<Vertexes> &G = image.groundTruths;
+    if (image.scores.size() != D.size())
+        return false;
+    const int ND = D.size();
+    const int NG = G.size();
+    ++nImages;
+    nGroundTruths += NG;
+    nDetections += ND;
+    if (ND == 0)
+        return true;
+
+    order.resize(ND);
+    for (int i = 0; i < ND; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), ScoreGreater(image.scores));
+    if (NG > 0) {
+        ious.resize((size_t)ND * NG);
+        iouMatrixParallelEx(D, G, ious.data(), *pool, method);
+    }
+    matched.resize(NG);
+
+    // Pairs with a NoneWise polygon have an iou of -1, and are never
+    // matched.
+    for (int t = 0; t < (int)thresholds.size(); ++t) {
+        uint64_t *tp = &truePositives[t * nBins];
+        uint64_t *fp = &falsePositives[t * nBins];
+        std::fill(matched.begin(), matched.end(), 0);
+        for (int k = 0; k < ND; ++k) {
+            const int d = order[k];
+            const double *row = NG > 0 ? &ious[(size_t)d * NG] : 0;
+            int best = -1;
+            double bestIou = thresholds[t];
+            for (int g = 0; g < NG; ++g) {
+                if (!matched[g] && row[g] >= 0.0 && row[g] >= bestIou) {
+                    best = g;
+                    bestIou = row[g];
+                }
+            }
+            const int bin = scoreBin(image.scores[d], nBins);
+            if (best >= 0) {
+                matched[best] = 1;
+                ++tp[bin];
+            }
+            else
+                ++fp[bin];
+        }
+    }
+    return true;
+}
+
+bool StreamingEvaluator::run(const EvalImageSource &source)
+{
+    // A single loader thread reads image k into buffers[k % 2] once image
+    // k-2 is matched, so it runs one image ahead of add.
+    EvalImage buffers[2];
+    std::mutex mutex;
+    std::condition_variable changed;
+    int loaded = 0;
+    int matchedImages = 0;
+    bool finished = false;
+    bool stop = false;
+    std::exception_ptr error;
+
+    std::thread loader([&]() {
+        for (int k = 0; ; ++k) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return stop || k - matchedImages < 2; });
+                if (stop)
+                    return;
+            }
+            bool more = false;
+            std::exception_ptr thrown;
+            try {
+                more = source(buffers[k % 2]);
+            }
+            catch (...) {
+                thrown = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = thrown;
+                if (more)
+                    ++loaded;
+                else
+                    finished = true;
+            }
+            changed.notify_all();
+            if (!more)
+                return;
+        }
+    });
+
+    bool ok = true;
+    try {
+        for (int k = 0; ; ++k) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return loaded > k || finished; });
+                if (loaded <= k)
+                    break;
+            }
+            ok = add(buffers[k % 2]) && ok;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++matchedImages;
+            }
+            changed.notify_all();
+        }
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        changed.notify_all();
+        loader.join();
+        throw;
+    }
+    loader.join();
+    if (error)
+        std::rethrow_exception(error);
+    return ok;
+}
+
+void StreamingEvaluator::precisionRecall(const int t, std::vector<double> &precision,
+                                         std::vector<double> &recall) const
+{
+    precision.clear();
+    recall.clear();
+    const uint64_t *tp = &truePositives[t * nBins];
+    const uint64_t *fp = &falsePositives[t * nBins];
+    uint64_t sumTp = 0, sumFp = 0;
+    for (int b = nBins - 1; b >= 0; --b) {
+        if (tp[b] == 0 && fp[b] == 0)
+            continue;
+        sumTp += tp[b];
+        sumFp += fp[b];
+        precision.push_back(double(sumTp) / double(sumTp + sumFp));
+        recall.push_back(nGroundTruths > 0 ? double(sumTp) / double(nGroundTruths) : 0.0);
+    }
+}
+double StreamingEvaluator::averagePrecision(const int t) const
+{
+    if (nGroundTruths == 0)
+        return -1.0;
+    std::vector<double> precision, recall;
+    precisionRecall(t, precision, recall);
+    const int N = precision.size();
+    for (int i = N - 2; i >= 0; --i)
+        precision[i] = std::max(precision[i], precision[i+1]);
+    double ap = 0.0;
+    double r0 = 0.0;
+    for (int i = 0; i < N; ++i) {
+        ap += (recall[i] - r0) * precision[i];
+        r0 = recall[i];
+    }
+    return ap;
+}
+double StreamingEvaluator::meanAveragePrecision() const
+{
+    if (nGroundTruths == 0 || thresholds.empty())
+        return -1.0;
+    double s = 0.0;
+    for (int t = 0; t < (int)thresholds.size(); ++t)
+        s += averagePrecision(t);
+    return s / thresholds.size();
+}
+
+}
@@ -0,0 +1,108 @@
+/***********************************
+ * evaluator.h
+ *
+ * Streaming average precision of detections
+ * against ground truths, image by image.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_EVALUATOR_H_FILE_
+#define _IOU_EVALUATOR_H_FILE_
+
+#include "iou.h"
+#include "threadpool.h"
+#include <functional>
+#include <stdint.h>
+
+namespace IOU
+{
+    // Detections, with their scores in [0,1], and ground truths of one
+    // image.
+    struct EvalImage {
+        std::vector<Vertexes> detections;
+        std::vector<double> scores;
+        std::vector<Vertexes> groundTruths;
+    };
+    // Fill image with the next image, reusing its buffers, e.g. from the
+    // polygons of a PolygonFile. Returns false once there is none left.
+    typedef std::function<bool(EvalImage &image)> EvalImageSource;
+
+    // Average precision of one class accumulated image by image, at
+    // several iou thresholds, in memory independent of the number of
+    // images: only the true and false positive counts per score bin are
+    // kept.
+    // In each image, the detections are matched by decreasing score, each
+    // to the unmatched ground truth of highest iou at or above the
+    // threshold; those left unmatched are false positives. Scores are
+    // clamped to [0,1] and binned in nBins bins, detections of one bin
+    // counting as tied. NoneWise detections are false positives and
+    // NoneWise ground truths are counted but never matched.
+    class StreamingEvaluator {
+    public:
+        // Constructors. The ious of each image are computed by pool, or
+        // by a pool of nThreads workers (nThreads <= 0: one per hardware
+        // thread) owned by the evaluator.
+        explicit StreamingEvaluator(const std::vector<double> &thresholds,
+                                    const int nThreads = 0, const int nBins = 1000,
+                                    const InterMethod method = PointSoup);
+        StreamingEvaluator(const std::vector<double> &thresholds, ThreadPool &pool,
+                           const int nBins = 1000,
+                           const InterMethod method = PointSoup);
+        ~StreamingEvaluator();
+
+        // Match one image. Returns false, adding nothing, if it has not
+        // one score per detection.
+        bool add(const EvalImage &image);
+        // Add every image of source, the next image being read by a loader
+        // thread, started once per run, while the current one is matched.
+        // source is never called concurrently. Returns false if an image
+        // was rejected by add.
+        // An exception thrown by source ends the run: the images read
+        // before it are added, then run rethrows it on the calling thread.
+        bool run(const EvalImageSource &source);
+        void reset();
+
+        // Methods.
+        int thresholdCount() const { return thresholds.size(); }
+        double threshold(const int t) const { return thresholds[t]; }
+        uint64_t imageCount() const { return nImages; }
+        uint64_t groundTruthCount() const { return nGroundTruths; }
+        uint64_t detectionCount() const { return nDetections; }
+        // Precision and recall after each non-empty score bin, by
+        // decreasing score, at threshold t. Recall is 0 without ground
+        // truths.
+        void precisionRecall(const int t, std::vector<double> &precision,
+                             std::vector<double> &recall) const;
+        // Area under the precision-recall curve at threshold t, precision
+        // made non-increasing beforehand. -1 without ground truths.
+        double averagePrecision(const int t = 0) const;
+        // Mean of averagePrecision over all the thresholds.
+        double meanAveragePrecision() const;
+
+    private:
+        StreamingEvaluator(const StreamingEvaluator &);
+        StreamingEvaluator& operator=(const StreamingEvaluator &);
+
+        void init();
+
+        std::vector<double> thresholds;
+        int nBins;
+        InterMethod method;
+        ThreadPool *pool;
+        bool ownPool;
+
+        // truePositives[t*nBins + b], bin nBins-1 holding the top scores.
+        std::vector<uint64_t> truePositives;
+        std::vector<uint64_t> falsePositives;
+        uint64_t nImages;
+        uint64_t nGroundTruths;
+        uint64_t nDetections;
+
+        // Per image, reused from one image to the next.
+        std::vector<double> ious;
+        std::vector<int> order;
+        std::vector<char> matched;
+    };
+}
+#endif // !_IOU_EVALUATOR_H_FILE_
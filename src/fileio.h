@@ -0,0 +1,45 @@
+/***********************************
+ * fileio.h
+ *
+ * Section layout helpers of the binary
+ * polygon and plan files.
+ * Internal to polyfile.cpp and shard.cpp.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_FILEIO_H_FILE_
+#define _IOU_FILEIO_H_FILE_
+
+#include <cstdio>
+#include <stdint.h>
+
+namespace IOU
+{
+namespace fileio
+{
+    // Every section of a file starts on a multiple of 8 bytes.
+    inline uint64_t align8(const uint64_t pos)
+    {
+        return (pos + 7) & ~uint64_t(7);
+    }
+
+    // Write n bytes of data, then pad with zeros up to a multiple of 8 bytes.
+    inline bool writeAligned(std::FILE *f, const void *data, const size_t n)
+    {
+        static const char zeros[8] = { 0 };
+        if (n > 0 && std::fwrite(data, 1, n, f) != n)
+            return false;
+        const size_t pad = align8(n) - n;
+        return pad == 0 || std::fwrite(zeros, 1, pad, f) == pad;
+    }
+
+    // Whether a section of n bytes at pos is 8-byte aligned and inside a
+    // file of size bytes.
+    inline bool sectionFits(const uint64_t pos, const uint64_t n, const uint64_t size)
+    {
+        return pos % 8 == 0 && pos <= size && n <= size - pos;
+    }
+}
+}
+#endif // !_IOU_FILEIO_H_FILE_
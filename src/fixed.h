@@ -0,0 +1,183 @@
+/***********************************
+ * fixed.h
+ *
+ * Header-only iou of convex polygons whose
+ * sizes are known at compile time, to be
+ * inlined into the caller's loops.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_FIXED_H_FILE_
+#define _IOU_FIXED_H_FILE_
+
+#include "iou.h"
+#include <array>
+#include <cstddef>
+
+namespace IOU
+{
+    // Same as whichWiseEx, areaEx, areaIntersectionEx(ConvexClip) and
+    // iouEx(ConvexClip), for polygons of N and M vertexes held in
+    // std::array. Nothing leaves this header, so the compiler can inline
+    // the whole computation: the loops over the vertexes of either polygon
+    // have constant trip counts and unroll, only the clipping of the
+    // current intersection, of at most N+M vertexes, is bounded at run time.
+    // Unlike iouEx, iou is -1 whenever either polygon is NoneWise.
+    template <std::size_t N, typename T>
+    inline WiseType whichWise(const std::array<Vec2<T>, N> &C);
+    template <std::size_t N, typename T>
+    inline T area(const std::array<Vec2<T>, N> &C);
+    template <std::size_t N, std::size_t M, typename T>
+    inline T areaIntersection(const std::array<Vec2<T>, N> &C1,
+                              const std::array<Vec2<T>, M> &C2);
+    template <std::size_t N, std::size_t M, typename T>
+    inline T iou(const std::array<Vec2<T>, N> &C1, const std::array<Vec2<T>, M> &C2);
+
+namespace fixed
+{
+    // Kernels of the functions above, over the N vertexes from C.
+    template <std::size_t N>
+    inline std::size_t next(const std::size_t i) { return i + 1 < N ? i + 1 : 0; }
+
+    template <typename T>
+    inline T sumTriangles(const Vec2<T> *C, const int N)
+    {
+        T sArea = 0;
+        for (int i = 1; i < N - 1; ++i)
+            sArea += abs((C[i] - C[0])^(C[i + 1] - C[0]))*T(0.5);
+        return sArea;
+    }
+    template <std::size_t N, typename T>
+    inline WiseType whichWise(const Vec2<T> *C)
+    {
+        const T zero = Tolerance<T>::zero();
+        if (N < 3)
+            return NoneWise;
+
+        T cross[N < 3 ? 1 : N];
+        bool folded = false;
+        for (std::size_t i = 0; i < N; ++i) {
+            const Vec2<T> p01 = C[i] - C[i == 0 ? N - 1 : i - 1];
+            const Vec2<T> p12 = C[next<N>(i)] - C[i];
+            cross[i] = p01^p12;
+            folded = folded || (abs(cross[i]) <= zero && p01*p12 < T(0));
+        }
+        if (folded)
+            return NoneWise;
+        const WiseType wiseType = cross[0] > T(0) ? AntiClockWise : ClockWise;
+        const T flip = (wiseType == ClockWise) ? T(1) : T(-1);
+        for (std::size_t i = 1; i < N; ++i) {
+            if (cross[i]*flip > T(0))
+                return NoneWise;
+        }
+        return wiseType;
+    }
+    template <std::size_t N, typename T>
+    inline AABBT<T> bounds(const Vec2<T> *C)
+    {
+        AABBT<T> box(C[0].x, C[0].y, C[0].x, C[0].y);
+        for (std::size_t i = 1; i < N; ++i) {
+            box.xMin = std::min(box.xMin, C[i].x);
+            box.xMax = std::max(box.xMax, C[i].x);
+            box.yMin = std::min(box.yMin, C[i].y);
+            box.yMax = std::max(box.yMax, C[i].y);
+        }
+        return box;
+    }
+    template <typename T>
+    inline bool overflowed(const std::vector<Vec2<T> > &) { return false; }
+    template <int N, typename T>
+    inline bool overflowed(const SmallPolygon<N, T> &P) { return P.overflowed(); }
+    // Area of the Sutherland-Hodgman clipping of the N vertexes C1 by every
+    // edge of C2, as clipConvexP in iou.cpp, in the buffers buf1 and buf2.
+    // Returns -1 if they overflow.
+    template <std::size_t M, typename T, class Buffer>
+    inline T clipAreaIn(const Vec2<T> *C1, const int N, const Vec2<T> *C2,
+                        const WiseType wise2, Buffer &buf1, Buffer &buf2)
+    {
+        Buffer *in = &buf1;
+        Buffer *out = &buf2;
+        for (int i = 0; i < N; ++i)
+            out->push_back(C1[i]);
+
+        const T side = (wise2 == ClockWise) ? T(-1) : T(1);
+        for (std::size_t j = 0; j < M; ++j) {
+            if (out->empty())
+                return T(0);
+            const Vec2<T> &a = C2[j];
+            const Vec2<T> ab = C2[next<M>(j)] - a;
+            std::swap(in, out);
+            out->clear();
+
+            const int n = in->size();
+            Vec2<T> prev = (*in)[n - 1];
+            T dPrev = side*(ab^(prev - a));
+            for (int i = 0; i < n; ++i) {
+                const Vec2<T> &cur = (*in)[i];
+                const T dCur = side*(ab^(cur - a));
+                if ((dPrev < T(0) && dCur > T(0)) || (dPrev > T(0) && dCur < T(0)))
+                    out->push_back(prev + (cur - prev)*(dPrev/(dPrev - dCur)));
+                if (dCur >= T(0))
+                    out->push_back(cur);
+                prev = cur;
+                dPrev = dCur;
+            }
+            if (overflowed(*out))
+                return T(-1);
+        }
+        return sumTriangles(out->data(), out->size());
+    }
+    // Same on stack buffers, redone on the heap when they overflow.
+    template <std::size_t N, std::size_t M, typename T>
+    inline T clipArea(const Vec2<T> *C1, const Vec2<T> *C2, const WiseType wise2)
+    {
+        // Twice N+M leaves room for rounding near collinear edges.
+        SmallPolygon<2 * int(N + M), T> buf1, buf2;
+        const T inter = clipAreaIn<M>(C1, int(N), C2, wise2, buf1, buf2);
+        if (inter >= T(0))
+            return inter;
+        std::vector<Vec2<T> > heap1, heap2;
+        return clipAreaIn<M>(C1, int(N), C2, wise2, heap1, heap2);
+    }
+} // namespace fixed
+
+    template <std::size_t N, typename T>
+    inline WiseType whichWise(const std::array<Vec2<T>, N> &C)
+    {
+        return fixed::whichWise<N>(C.data());
+    }
+    template <std::size_t N, typename T>
+    inline T area(const std::array<Vec2<T>, N> &C)
+    {
+        if (fixed::whichWise<N>(C.data()) == NoneWise)
+            return T(-1);
+        return fixed::sumTriangles(C.data(), int(N));
+    }
+    template <std::size_t N, std::size_t M, typename T>
+    inline T areaIntersection(const std::array<Vec2<T>, N> &C1,
+                              const std::array<Vec2<T>, M> &C2)
+    {
+        const WiseType wise2 = fixed::whichWise<M>(C2.data());
+        if (fixed::whichWise<N>(C1.data()) == NoneWise || wise2 == NoneWise)
+            return T(-1);
+        if (!fixed::bounds<N>(C1.data()).overlaps(fixed::bounds<M>(C2.data())))
+            return T(0);
+        return fixed::clipArea<N, M>(C1.data(), C2.data(), wise2);
+    }
+    template <std::size_t N, std::size_t M, typename T>
+    inline T iou(const std::array<Vec2<T>, N> &C1, const std::array<Vec2<T>, M> &C2)
+    {
+        const WiseType wise1 = fixed::whichWise<N>(C1.data());
+        const WiseType wise2 = fixed::whichWise<M>(C2.data());
+        if (wise1 == NoneWise || wise2 == NoneWise)
+            return T(-1);
+        const T area1 = fixed::sumTriangles(C1.data(), int(N));
+        const T area2 = fixed::sumTriangles(C2.data(), int(M));
+        if (!fixed::bounds<N>(C1.data()).overlaps(fixed::bounds<M>(C2.data())))
+            return T(0);
+        const T inter = fixed::clipArea<N, M>(C1.data(), C2.data(), wise2);
+        return inter/(area1 + area2 - inter);
+    }
+}
+#endif // !_IOU_FIXED_H_FILE_
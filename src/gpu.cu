@@ -0,0 +1,284 @@
+/***********************************
+ * gpu.cu
+ *
+ * Optional CUDA backend: iou matrices and NMS
+ * masks of rotated rectangles kept resident
+ * on the device.
+ * Built only with IOU_ENABLE_CUDA.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "gpu.h"
+#include "simd_kernel.h"
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+namespace IOU
+{
+
+namespace
+{
+
+// Threads per side of the square tiles of the matrix.
+const int MatrixTile = 16;
+// Most floats of the matrix held on the device at a time.
+const long long MatrixChunk = 1LL << 24;
+// Boxes per tile of the NMS masks, one bit each in a word.
+const int NmsTile = 64;
+
+// Rotated rectangles as stored by GpuRotatedRectBatch.
+struct GpuBoxes {
+    const float *cx, *cy, *w, *h, *cosT, *sinT;
+    int n;
+};
+struct GpuBox {
+    float cx, cy, w, h, cosT, sinT;
+};
+
+GpuBoxes gpuBoxes(const GpuRotatedRectBatch &batch)
+{
+    const float *p = batch.deviceData();
+    const int n = batch.size();
+    GpuBoxes B = { p, p + n, p + 2*n, p + 3*n, p + 4*n, p + 5*n, n };
+    return B;
+}
+
+__host__ __device__ inline GpuBox loadBox(const GpuBoxes &B, const int i)
+{
+    GpuBox b = { B.cx[i], B.cy[i], B.w[i], B.h[i], B.cosT[i], B.sinT[i] };
+    return b;
+}
+
+// Query of simd's kernels for the box q, as iouOneToMany builds it.
+__host__ __device__ inline simd::RotatedQuery rotatedQuery(const GpuBox &q)
+{
+    simd::RotatedQuery r = { q.cx, q.cy, q.w * 0.5f, q.h * 0.5f, q.cosT, q.sinT, q.w * q.h };
+    return r;
+}
+// iou of q and r by the scalar kernel of simd, for the same results as
+// SimdScalar.
+__host__ __device__ inline float iouRotated(const simd::RotatedQuery &q, const GpuBox &r)
+{
+    typedef simd::VScalar V;
+    return simd::iouRotatedV<V>(q, V::set1(r.cx), V::set1(r.cy), V::set1(r.w), V::set1(r.h),
+                                V::set1(r.cosT), V::set1(r.sinT)).v;
+}
+
+// out[(i-rowBegin)*B.n+j] for the rows [rowBegin, rowEnd) of A, one
+// thread per pair, on tiles of MatrixTile x MatrixTile.
+__global__ void iouMatrixKernel(const GpuBoxes A, const int rowBegin, const int rowEnd,
+                                const GpuBoxes B, float *out)
+{
+    __shared__ GpuBox rows[MatrixTile];
+    __shared__ GpuBox cols[MatrixTile];
+    const int i = rowBegin + blockIdx.y * MatrixTile + threadIdx.y;
+    const int j = blockIdx.x * MatrixTile + threadIdx.x;
+    if (threadIdx.x == 0 && i < rowEnd)
+        rows[threadIdx.y] = loadBox(A, i);
+    if (threadIdx.y == 0 && j < B.n)
+        cols[threadIdx.x] = loadBox(B, j);
+    __syncthreads();
+    if (i < rowEnd && j < B.n)
+        out[(long long)(i - rowBegin) * B.n + j] = iouRotated(rotatedQuery(rows[threadIdx.y]),
+                                                                  cols[threadIdx.x]);
+}
+
+// Whether every parameter of b is finite: nmsRotated compares the other
+// boxes with none.
+__device__ inline bool isFinite(const GpuBox &b)
+{
+    return isfinite(b.cx) && isfinite(b.cy) && isfinite(b.w) && isfinite(b.h) &&
+           isfinite(b.cosT) && isfinite(b.sinT);
+}
+
+// Bit l%64 of mask[k*nWords + l/64] is set if l > k and the box of rank k
+// suppresses that of rank l, ranks being positions in order, of nRanks
+// boxes. One block per tile of NmsTile x NmsTile ranks on or above the
+// diagonal, one thread per row.
+__global__ void nmsMaskKernel(const GpuBoxes B, const int *order, const int nRanks,
+                              const double thresh, const int nWords,
+                              unsigned long long *mask)
+{
+    const int rowTile = blockIdx.y;
+    const int colTile = blockIdx.x;
+    if (colTile < rowTile)
+        return;
+
+    __shared__ GpuBox cols[NmsTile];
+    const int l0 = colTile * NmsTile;
+    const int nCols = min(NmsTile, nRanks - l0);
+    if ((int)threadIdx.x < nCols)
+        cols[threadIdx.x] = loadBox(B, order[l0 + threadIdx.x]);
+    __syncthreads();
+
+    const int k = rowTile * NmsTile + threadIdx.x;
+    if (k >= nRanks)
+        return;
+    const GpuBox box = loadBox(B, order[k]);
+    const simd::RotatedQuery q = rotatedQuery(box);
+    unsigned long long bits = 0;
+    for (int j = 0; j < nCols && isFinite(box); ++j) {
+        if (l0 + j > k && isFinite(cols[j]) && iouRotated(q, cols[j]) > thresh)
+            bits |= 1ULL << j;
+    }
+    mask[(long long)k * nWords + colTile] = bits;
+}
+
+// Device buffer freed on scope exit.
+template <typename T>
+class DeviceBuffer {
+public:
+    DeviceBuffer() : p(0) {}
+    ~DeviceBuffer() { if (p != 0) cudaFree(p); }
+    bool allocate(const size_t n) { return cudaMalloc((void **)&p, n * sizeof(T)) == cudaSuccess; }
+    T* get() const { return p; }
+
+private:
+    DeviceBuffer(const DeviceBuffer &);
+    DeviceBuffer& operator=(const DeviceBuffer &);
+
+    T *p;
+};
+
+struct ScoreGreater
+{
+    explicit ScoreGreater(const std::vector<float> &_scores) : scores(_scores) {}
+    bool operator()(const int i, const int j) const { return scores[i] > scores[j]; }
+    const std::vector<float> &scores;
+};
+
+} // namespace
+
+bool gpuAvailable()
+{
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+}
+
+GpuRotatedRectBatch::GpuRotatedRectBatch()
+    : data(0), n(0)
+{
+}
+GpuRotatedRectBatch::GpuRotatedRectBatch(const RotatedRectBatch &batch)
+    : data(0), n(0)
+{
+    upload(batch);
+}
+GpuRotatedRectBatch::~GpuRotatedRectBatch()
+{
+    release();
+}
+
+bool GpuRotatedRectBatch::upload(const RotatedRectBatch &batch)
+{
+    release();
+    const int N = batch.size();
+    if (N == 0)
+        return true;
+    if (cudaMalloc((void **)&data, 6 * (size_t)N * sizeof(float)) != cudaSuccess) {
+        data = 0;
+        return false;
+    }
+    const std::vector<float> *arrays[6] = {
+        &batch.cx, &batch.cy, &batch.w, &batch.h, &batch.cosT, &batch.sinT };
+    for (int k = 0; k < 6; ++k) {
+        if (cudaMemcpy(data + (size_t)k * N, arrays[k]->data(), N * sizeof(float),
+                       cudaMemcpyHostToDevice) != cudaSuccess) {
+            release();
+            return false;
+        }
+    }
+    n = N;
+    return true;
+}
+void GpuRotatedRectBatch::release()
+{
+    if (data != 0)
+        cudaFree(data);
+    data = 0;
+    n = 0;
+}
+
+bool iouMatrixGpu(const GpuRotatedRectBatch &A, const GpuRotatedRectBatch &B, float *out)
+{
+    const int nA = A.size();
+    const int nB = B.size();
+    if (nA == 0 || nB == 0)
+        return true;
+
+    // Rows per launch: within the chunk, and within the grid height.
+    const long long maxRows = 65535LL * MatrixTile;
+    const int chunkRows = (int)std::min(std::min((long long)nA, maxRows),
+                                        std::max(1LL, MatrixChunk / nB));
+    DeviceBuffer<float> buf;
+    if (!buf.allocate((size_t)chunkRows * nB))
+        return false;
+
+    const GpuBoxes GA = gpuBoxes(A);
+    const GpuBoxes GB = gpuBoxes(B);
+    const dim3 block(MatrixTile, MatrixTile);
+    for (int r0 = 0; r0 < nA; r0 += chunkRows) {
+        const int r1 = std::min(nA, r0 + chunkRows);
+        const dim3 grid((nB + MatrixTile - 1) / MatrixTile,
+                        (r1 - r0 + MatrixTile - 1) / MatrixTile);
+        iouMatrixKernel<<<grid, block>>>(GA, r0, r1, GB, buf.get());
+        if (cudaGetLastError() != cudaSuccess ||
+            cudaMemcpy(out + (size_t)r0 * nB, buf.get(), (size_t)(r1 - r0) * nB * sizeof(float),
+                       cudaMemcpyDeviceToHost) != cudaSuccess)
+            return false;
+    }
+    return true;
+}
+
+bool nmsRotatedGpu(const GpuRotatedRectBatch &boxes, const std::vector<float> &scores,
+                   const double thresh, std::vector<int> &keep)
+{
+    keep.clear();
+    const int N = boxes.size();
+    if ((int)scores.size() != N)
+        return true;
+
+    // NaN scores are dropped: the sort needs a strict weak ordering.
+    std::vector<int> order;
+    order.reserve(N);
+    for (int i = 0; i < N; ++i)
+        if (!std::isnan(scores[i]))
+            order.push_back(i);
+    const int M = order.size();
+    if (M == 0)
+        return true;
+    std::stable_sort(order.begin(), order.end(), ScoreGreater(scores));
+
+    const int nWords = (M + NmsTile - 1) / NmsTile;
+    DeviceBuffer<int> dOrder;
+    DeviceBuffer<unsigned long long> dMask;
+    if (!dOrder.allocate(M) || !dMask.allocate((size_t)M * nWords) ||
+        cudaMemcpy(dOrder.get(), order.data(), M * sizeof(int),
+                   cudaMemcpyHostToDevice) != cudaSuccess)
+        return false;
+
+    nmsMaskKernel<<<dim3(nWords, nWords), NmsTile>>>(gpuBoxes(boxes), dOrder.get(), M,
+                                                     thresh, nWords, dMask.get());
+    std::vector<unsigned long long> mask((size_t)M * nWords);
+    if (cudaGetLastError() != cudaSuccess ||
+        cudaMemcpy(mask.data(), dMask.get(), mask.size() * sizeof(unsigned long long),
+                   cudaMemcpyDeviceToHost) != cudaSuccess)
+        return false;
+
+    // Greedy pass by rank: only the words from the tile of k on are set.
+    std::vector<unsigned long long> removed(nWords, 0);
+    for (int k = 0; k < M; ++k) {
+        if (removed[k / NmsTile] & (1ULL << (k % NmsTile)))
+            continue;
+        keep.push_back(order[k]);
+        const unsigned long long *row = &mask[(size_t)k * nWords];
+        for (int w = k / NmsTile; w < nWords; ++w)
+            removed[w] |= row[w];
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,72 @@
+/***********************************
+ * gpu.h
+ *
+ * Optional CUDA backend: iou matrices and NMS
+ * masks of rotated rectangles kept resident
+ * on the device.
+ * Built only with IOU_ENABLE_CUDA.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_GPU_H_FILE_
+#define _IOU_GPU_H_FILE_
+
+#include "simd.h"
+
+namespace IOU
+{
+    // Whether a CUDA device can be used.
+    bool gpuAvailable();
+
+    // Rotated rectangles copied once to the device, in the layout of
+    // RotatedRectBatch, and kept there until released or replaced: every
+    // query on them reuses the same device arrays.
+    class GpuRotatedRectBatch {
+    public:
+        // Constructors.
+        GpuRotatedRectBatch();
+        explicit GpuRotatedRectBatch(const RotatedRectBatch &batch);
+        ~GpuRotatedRectBatch();
+
+        // Copy batch to the device, replacing the rectangles held.
+        // Returns false, with the batch left empty, if the device memory
+        // cannot be allocated or written.
+        bool upload(const RotatedRectBatch &batch);
+        void release();
+
+        // Methods.
+        int size() const { return n; }
+        bool empty() const { return n == 0; }
+        // Device arrays cx, cy, w, h, cosT and sinT, of size() floats each,
+        // one after the other.
+        const float* deviceData() const { return data; }
+
+    private:
+        GpuRotatedRectBatch(const GpuRotatedRectBatch &);
+        GpuRotatedRectBatch& operator=(const GpuRotatedRectBatch &);
+
+        float *data;
+        int n;
+    };
+
+    // out[i*B.size()+j] = iou(A[i], B[j]), as iouOneToMany(A[i], B) row by
+    // row: the same single precision formula, compiled without fused
+    // multiply-adds so that it matches SimdScalar. Computed by tiles of
+    // rows, so the device holds at most 64 MB of the matrix at a time.
+    // Returns false if a CUDA call fails.
+    bool iouMatrixGpu(const GpuRotatedRectBatch &A, const GpuRotatedRectBatch &B, float *out);
+
+    // Greedy NMS of the boxes, as nmsRotated on their quads, with the iou
+    // of iouMatrixGpu: the device computes, for every box, the bitmask of
+    // the boxes of lower score it suppresses, and the greedy pass over the
+    // masks runs on the host.
+    // As in nmsRotated, boxes with a NaN score are dropped, boxes with a
+    // non-finite parameter are compared with no box, and keep is empty if
+    // scores and boxes differ in size.
+    // The masks take boxes.size()^2 / 8 bytes of device memory.
+    // Returns false, with keep empty, if a CUDA call fails.
+    bool nmsRotatedGpu(const GpuRotatedRectBatch &boxes, const std::vector<float> &scores,
+                       const double thresh, std::vector<int> &keep);
+}
+#endif // !_IOU_GPU_H_FILE_
@@ -0,0 +1,342 @@
+/***********************************
+ * incremental.cpp
+ *
+ * Iou of a pair of convex polygons kept up
+ * to date as they move, for tracking.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "incremental.h"
+#include <cmath>
+
+namespace IOU
+{
+
+namespace
+{
+
+// Area of the polygon C, whatever its wise.
+double polygonArea(const Vertexes &C)
+{
+    const int N = C.size();
+    double s = 0.0;
+    for (int i = 0; i < N; ++i)
+        s += C[i] ^ C[(i+1)%N];
+    return std::abs(s) * 0.5;
+}
+
+void rigidMove(const Vertexes &C, const double angle, const Point &t, Vertexes &out)
+{
+    const int N = C.size();
+    Point c(0,0);
+    for (int i = 0; i < N; ++i)
+        c += C[i];
+    if (N > 0)
+        c /= double(N);
+    const double cs = std::cos(angle);
+    const double sn = std::sin(angle);
+    out.resize(N);
+    for (int i = 0; i < N; ++i) {
+        const Point d = C[i] - c;
+        out[i] = Point(c.x + cs*d.x - sn*d.y + t.x, c.y + sn*d.x + cs*d.y + t.y);
+    }
+}
+
+} // namespace
+
+IncrementalIou::IncrementalIou()
+    : wise1(NoneWise), wise2(NoneWise), area1(0), area2(0),
+      interV(-1), iouV(-1), cached(false), separating(-1),
+      nIncremental(0), nFull(0)
+{
+}
+IncrementalIou::IncrementalIou(const Vertexes &_C1, const Vertexes &_C2)
+    : wise1(NoneWise), wise2(NoneWise), area1(0), area2(0),
+      interV(-1), iouV(-1), cached(false), separating(-1),
+      nIncremental(0), nFull(0)
+{
+    reset(_C1, _C2);
+}
+
+double IncrementalIou::reset(const Vertexes &_C1, const Vertexes &_C2)
+{
+    C1 = _C1;
+    C2 = _C2;
+    wise1 = whichWiseEx(C1);
+    wise2 = whichWiseEx(C2);
+    area1 = polygonArea(C1);
+    area2 = polygonArea(C2);
+    return compute();
+}
+
+double IncrementalIou::update(const Vertexes &_C1, const Vertexes &_C2)
+{
+    if (!cached || _C1.size() != C1.size() || _C2.size() != C2.size() ||
+        whichWiseEx(_C1) != wise1 || whichWiseEx(_C2) != wise2)
+        return reset(_C1, _C2);
+    C1 = _C1;
+    C2 = _C2;
+    area1 = polygonArea(C1);
+    area2 = polygonArea(C2);
+
+    if (events.empty() ? stillSeparated() : solveEvents()) {
+        ++nIncremental;
+        setIou(events.empty() ? 0.0 : polygonArea(eventPts));
+        return iouV;
+    }
+    return compute();
+}
+double IncrementalIou::moveFirst(const double angle, const Point &t)
+{
+    rigidMove(C1, angle, t, moved);
+    return update(moved, C2);
+}
+double IncrementalIou::moveSecond(const double angle, const Point &t)
+{
+    rigidMove(C2, angle, t, moved);
+    return update(C1, moved);
+}
+
+// Full computation, caching the structure when it is not degenerate.
+double IncrementalIou::compute()
+{
+    ++nFull;
+    cached = false;
+    events.clear();
+    separating = -1;
+    if (wise1 == NoneWise || wise2 == NoneWise) {
+        interV = -1;
+        iouV = -1;
+        return iouV;
+    }
+    if (buildEvents() || findSeparation()) {
+        cached = true;
+        setIou(events.empty() ? 0.0 : polygonArea(eventPts));
+    }
+    else
+        setIou(areaIntersectionEx(C1, C2, RobustSoup));
+    return iouV;
+}
+
+void IncrementalIou::setIou(const double inter)
+{
+    interV = inter;
+    const double uni = area1 + area2 - inter;
+    iouV = uni > 0.0 ? inter / uni : 0.0;
+}
+
+// Vertex j of C2 walked in the wise of C1.
+const Point& IncrementalIou::vertex2(const int j) const
+{
+    const int N2 = C2.size();
+    return wise2 == wise1 ? C2[j] : C2[N2 - 1 - j];
+}
+
+bool IncrementalIou::insideFirst(const Point &p) const
+{
+    const int N1 = C1.size();
+    const double s = side();
+    for (int i = 0; i < N1; ++i) {
+        const Point &a = C1[i];
+        if (s * ((C1[(i+1)%N1] - a) ^ (p - a)) <= 0.0)
+            return false;
+    }
+    return true;
+}
+bool IncrementalIou::insideSecond(const Point &p) const
+{
+    const int N2 = C2.size();
+    const double s = side();
+    for (int j = 0; j < N2; ++j) {
+        const Point &a = vertex2(j);
+        if (s * ((vertex2((j+1)%N2) - a) ^ (p - a)) <= 0.0)
+            return false;
+    }
+    return true;
+}
+
+// Solve e on the current vertexes. Returns false if it no longer holds:
+// its edges do not cross strictly inside both, or cross the other way,
+// or its vertex is not strictly inside the other polygon.
+bool IncrementalIou::solveEvent(const Event &e, EventEnds &end) const
+{
+    const int N1 = C1.size();
+    const int N2 = C2.size();
+    if (e.kind == Vertex1) {
+        end.p = C1[e.i];
+        end.inEdge = (e.i + N1 - 1) % N1;
+        end.outEdge = e.i;
+        end.inParam = 1.0;
+        end.outParam = 0.0;
+        return insideSecond(end.p);
+    }
+    if (e.kind == Vertex2) {
+        end.p = vertex2(e.j);
+        end.inEdge = N1 + (e.j + N2 - 1) % N2;
+        end.outEdge = N1 + e.j;
+        end.inParam = 1.0;
+        end.outParam = 0.0;
+        return insideFirst(end.p);
+    }
+
+    const Point &a = C1[e.i];
+    const Point d1 = C1[(e.i+1)%N1] - a;
+    const Point &b = vertex2(e.j);
+    const Point d2 = vertex2((e.j+1)%N2) - b;
+    const double den = d1 ^ d2;
+    if (den == 0.0)
+        return false;
+    const double m = ((b - a) ^ d2) / den;
+    const double n = ((b - a) ^ d1) / den;
+    if (!(m > 0.0 && m < 1.0 && n > 0.0 && n < 1.0))
+        return false;
+    // Edge i of C1 goes into C2 when side*den < 0.
+    if ((side() * den < 0.0) != (e.kind == Cross1))
+        return false;
+    end.p = a + d1 * m;
+    if (e.kind == Cross1) {
+        end.inEdge = N1 + e.j;
+        end.inParam = n;
+        end.outEdge = e.i;
+        end.outParam = m;
+    }
+    else {
+        end.inEdge = e.i;
+        end.inParam = m;
+        end.outEdge = N1 + e.j;
+        end.outParam = n;
+    }
+    return true;
+}
+
+// Solve every event, and check that each one reaches the next along its
+// out edge. The events are then inside both polygons, and joined by
+// pieces of their boundaries, so they are the vertexes of their
+// intersection.
+bool IncrementalIou::solveEvents()
+{
+    const int E = events.size();
+    ends.resize(E);
+    eventPts.resize(E);
+    for (int k = 0; k < E; ++k) {
+        if (!solveEvent(events[k], ends[k]))
+            return false;
+        eventPts[k] = ends[k].p;
+    }
+    for (int k = 0; k < E; ++k) {
+        const EventEnds &a = ends[k];
+        const EventEnds &b = ends[(k+1)%E];
+        if (a.outEdge != b.inEdge || !(a.outParam < b.inParam))
+            return false;
+    }
+    return true;
+}
+
+// Events of the intersection, gathered then chained along the boundary,
+// each one followed by the first one after it on its out edge.
+// Returns false, with no events, if there are none or they are degenerate.
+bool IncrementalIou::buildEvents()
+{
+    const int N1 = C1.size();
+    const int N2 = C2.size();
+    std::vector<Event> found;
+    for (int i = 0; i < N1; ++i) {
+        for (int j = 0; j < N2; ++j) {
+            for (int kind = Cross1; kind <= Cross2; ++kind) {
+                Event e = { EventKind(kind), i, j };
+                EventEnds end;
+                if (solveEvent(e, end))
+                    found.push_back(e);
+            }
+        }
+    }
+    for (int i = 0; i < N1; ++i) {
+        if (insideSecond(C1[i])) {
+            Event e = { Vertex1, i, -1 };
+            found.push_back(e);
+        }
+    }
+    for (int j = 0; j < N2; ++j) {
+        if (insideFirst(vertex2(j))) {
+            Event e = { Vertex2, -1, j };
+            found.push_back(e);
+        }
+    }
+    const int E = found.size();
+    if (E < 3)
+        return false;
+
+    std::vector<EventEnds> foundEnds(E);
+    for (int k = 0; k < E; ++k)
+        solveEvent(found[k], foundEnds[k]);
+    std::vector<char> used(E, 0);
+    events.clear();
+    int cur = 0;
+    while (!used[cur]) {
+        used[cur] = 1;
+        events.push_back(found[cur]);
+        const EventEnds &a = foundEnds[cur];
+        int best = -1;
+        for (int k = 0; k < E; ++k) {
+            const EventEnds &b = foundEnds[k];
+            if (b.inEdge == a.outEdge && b.inParam > a.outParam &&
+                (best < 0 || b.inParam < foundEnds[best].inParam))
+                best = k;
+        }
+        if (best < 0)
+            break;
+        cur = best;
+    }
+    if ((int)events.size() != E || cur != 0 || !solveEvents()) {
+        events.clear();
+        return false;
+    }
+    return true;
+}
+
+// Whether the line of edge leaves all the vertexes of the other polygon
+// strictly on its outer side.
+bool IncrementalIou::separates(const int edge) const
+{
+    const int N1 = C1.size();
+    const int N2 = C2.size();
+    const double s = side();
+    if (edge < N1) {
+        const Point &a = C1[edge];
+        const Point d = C1[(edge+1)%N1] - a;
+        for (int j = 0; j < N2; ++j) {
+            if (s * (d ^ (C2[j] - a)) >= 0.0)
+                return false;
+        }
+    }
+    else {
+        const int j = edge - N1;
+        const Point &a = vertex2(j);
+        const Point d = vertex2((j+1)%N2) - a;
+        for (int i = 0; i < N1; ++i) {
+            if (s * (d ^ (C1[i] - a)) >= 0.0)
+                return false;
+        }
+    }
+    return true;
+}
+// Disjoint convex polygons are separated by the line of an edge of one
+// of them.
+bool IncrementalIou::findSeparation()
+{
+    const int N = C1.size() + C2.size();
+    for (int e = 0; e < N; ++e) {
+        if (separates(e)) {
+            separating = e;
+            return true;
+        }
+    }
+    return false;
+}
+bool IncrementalIou::stillSeparated() const
+{
+    return separating >= 0 && separates(separating);
+}
+
+}
@@ -0,0 +1,117 @@
+/***********************************
+ * incremental.h
+ *
+ * Iou of a pair of convex polygons kept up
+ * to date as they move, for tracking.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_INCREMENTAL_H_FILE_
+#define _IOU_INCREMENTAL_H_FILE_
+
+#include "iou.h"
+
+namespace IOU
+{
+    // Iou of two convex polygons updated as they move a little at a time.
+    // The intersection is cached as a cycle of events: vertexes of one
+    // polygon inside the other, and crossings of an edge of each. After a
+    // move, only these are re-solved from the new vertexes, and the cycle
+    // is kept if every crossing still crosses, every vertex is still
+    // strictly inside the other polygon and consecutive events still meet
+    // in order along a common edge: the cycle is then exactly the new
+    // intersection. Disjoint polygons cache an edge whose line separates
+    // them. Otherwise, or when the structure is degenerate, the iou is
+    // recomputed in full, with RobustSoup for degenerate contacts.
+    class IncrementalIou {
+    public:
+        // Constructors.
+        IncrementalIou();
+        IncrementalIou(const Vertexes &C1, const Vertexes &C2);
+
+        // Compute the iou of C1 and C2 in full and cache its structure.
+        double reset(const Vertexes &C1, const Vertexes &C2);
+        // Same, after C1 and C2 have moved: their vertexes come in the
+        // same order as before, e.g. after a rigid motion. Other polygons
+        // are recomputed in full.
+        double update(const Vertexes &C1, const Vertexes &C2);
+        // Rotate the first or the second polygon by angle (radians)
+        // around the mean of its vertexes, then translate it by t, and
+        // update.
+        double moveFirst(const double angle, const Point &t);
+        double moveSecond(const double angle, const Point &t);
+
+        // Methods.
+        // -1 if either polygon is NoneWise.
+        double iou() const { return iouV; }
+        double intersection() const { return interV; }
+        const Vertexes& first() const { return C1; }
+        const Vertexes& second() const { return C2; }
+        // Updates served from the cached structure, and in full.
+        int incrementalCount() const { return nIncremental; }
+        int fullCount() const { return nFull; }
+
+    private:
+        enum EventKind
+        {
+            Vertex1,    // Vertex i of C1, inside C2.
+            Vertex2,    // Vertex j of C2, inside C1.
+            Cross1,     // Edges i of C1 and j of C2 crossing, the
+                        // intersection going on along edge i of C1.
+            Cross2      // Same, going on along edge j of C2.
+        };
+        struct Event {
+            EventKind kind;
+            int i;
+            int j;
+        };
+        // Position of an event, and the edges it comes in by and goes on
+        // along with its parameter on each, edges of C2 being numbered
+        // after those of C1.
+        struct EventEnds {
+            Point p;
+            int inEdge;
+            double inParam;
+            int outEdge;
+            double outParam;
+        };
+
+        double compute();
+        bool buildEvents();
+        bool solveEvents();
+        bool solveEvent(const Event &e, EventEnds &ends) const;
+        bool findSeparation();
+        bool stillSeparated() const;
+        bool separates(const int edge) const;
+        bool insideFirst(const Point &p) const;
+        bool insideSecond(const Point &p) const;
+        void setIou(const double inter);
+        const Point& vertex2(const int j) const;
+        double side() const { return wise1 == AntiClockWise ? 1.0 : -1.0; }
+
+        Vertexes C1;
+        Vertexes C2;
+        WiseType wise1;
+        WiseType wise2;
+        double area1;
+        double area2;
+        double interV;
+        double iouV;
+
+        // Cycle of the intersection in the wise of C1, C2 being walked in
+        // that wise too. Empty with separating >= 0 for disjoint polygons.
+        std::vector<Event> events;
+        Vertexes eventPts;
+        std::vector<EventEnds> ends;
+        Vertexes moved;
+        bool cached;
+        // Edge of C1 (< size of C1) or of C2 (offset by the size of C1)
+        // separating the polygons, -1 if none.
+        int separating;
+
+        int nIncremental;
+        int nFull;
+    };
+}
+#endif // !_IOU_INCREMENTAL_H_FILE_
@@ -10,56 +10,64 @@
  * 2018
  ***********************************/
 
-#include "IOU.h"
+#include "iou.h"
+#include "predicates.h"
+#include "stats.h"
+#include "threadpool.h"
 #include <algorithm>
+#include <limits>
 
 namespace IOU
 {
 
-bool Line::isOnLine(const Point &p) const
+template <typename T>
+bool LineT<T>::isOnLine(const Point &p) const
 {
-    if (p1 == p2)
-        return (p == (p1 + p2) / 2.0);
+    const T zero = Tolerance<T>::zero();
+    if (p1() == p2())
+        return (p == (p1() + p2()) / T(2));
 
-    Point pp1 = p - p1;
-    Point pp2 = p - p2;
+    Point pp1 = p - p1();
+    Point pp2 = p - p2();
 
-    if (abs(pp1^pp2) < _ZERO_ &&
-        pp1*pp2 < _ZERO_)
+    if (abs(pp1^pp2) < zero &&
+        pp1*pp2 < zero)
         return true;
     else
         return false;
 }
-Point Line::intersection(const Line &line, bool *bOnLine) const
+template <typename T>
+Vec2<T> LineT<T>::intersection(const LineT &line, bool *bOnLine) const
 {
+    const T zero = Tolerance<T>::zero();
     Point pInter(0,0);
     bool bOn = false;
 
-    if (p1 == p2 && line.p1 == line.p2){
+    if (p1() == p2() && line.p1() == line.p2()){
         // Both lines are actually points.
-        bOn =((p1 + p2) / 2.0 == (line.p1 + line.p2) / 2.0);
+        bOn =((p1() + p2()) / T(2) == (line.p1() + line.p2()) / T(2));
         if (bOn)
-            pInter = (p1 + p2 + line.p1 + line.p2) / 4.0;
+            pInter = (p1() + p2() + line.p1() + line.p2()) / T(4);
     }
-    else if (p1 == p2) {
+    else if (p1() == p2()) {
         // This line is actually a point.
-        bool bOn = line.isOnLine((p1 + p2) / 2.0);
+        bool bOn = line.isOnLine((p1() + p2()) / T(2));
         if (bOn)
-            pInter = (p1 + p2) / 2.0;
+            pInter = (p1() + p2()) / T(2);
     }
-    else if (line.p1 == line.p2) {
+    else if (line.p1() == line.p2()) {
         // The input line is actually a point.
-        bool bOn = isOnLine((line.p1 + line.p2) / 2.0);
+        bool bOn = isOnLine((line.p1() + line.p2()) / T(2));
         if (bOn)
-            pInter = (line.p1 + line.p2) / 2.0;
+            pInter = (line.p1() + line.p2()) / T(2);
     }
     else {
         // Normal cases.
 
-        Point a12 = p2 - p1;
-        Point b12 = line.p2 - line.p1;
+        Point a12 = p2() - p1();
+        Point b12 = line.p2() - line.p1();
         double ang = angle(a12, b12);
-        if (ang < _ZERO_ || abs(3.141592653 - ang) < _ZERO_)
+        if (ang < zero || abs(3.141592653 - ang) < zero)
             bOn = false; // Collinear!!
         else {
             // a1_x + m*a12_x = b1_x + n*b12_x
@@ -68,18 +76,18 @@ Point Line::intersection(const Line &line, bool *bOnLine) const
             // m = ( (a1_y-b1_y)*b12_x - (a1_x-b1_x)*b12_y ) / (a12_x*b12_y - b12_x*a12_y)
             // 0 < m < 1
             // 0 < n < 1
-            double abx = p1.x - line.p1.x;
-            double aby = p1.y - line.p1.y;
-            double ab = a12.x*b12.y - b12.x*a12.y;
-            assert(abs(ab)>_ZERO_);
-            double n = (aby*a12.x - abx*a12.y) / ab;
-            double m = (aby*b12.x - abx*b12.y) / ab;
-
-            if (n >= -_ZERO_ && n-1.0 <= _ZERO_ &&
-                m >= -_ZERO_ && m-1.0 <= _ZERO_) {
-                Point ip1 = p1 + m*a12;
-                Point ip2 = line.p1 + n*b12;
-                pInter = (ip1 + ip2) / 2.0;
+            T abx = p1().x - line.p1().x;
+            T aby = p1().y - line.p1().y;
+            T ab = a12.x*b12.y - b12.x*a12.y;
+            assert(abs(ab)>zero);
+            T n = (aby*a12.x - abx*a12.y) / ab;
+            T m = (aby*b12.x - abx*b12.y) / ab;
+
+            if (n >= -zero && n-T(1) <= zero &&
+                m >= -zero && m-T(1) <= zero) {
+                Point ip1 = p1() + m*a12;
+                Point ip2 = line.p1() + n*b12;
+                pInter = (ip1 + ip2) / T(2);
                 bOn = true;
             }
             else
@@ -90,157 +98,296 @@ Point Line::intersection(const Line &line, bool *bOnLine) const
         *bOnLine = bOn;
     return pInter;
 }
-
-void Quad::getVertList(Vertexes &_vert) const
-{
-    Vertexes vertTemp;
-    vertTemp.reserve(4);
-    vertTemp.push_back(p1);
-    vertTemp.push_back(p2);
-    vertTemp.push_back(p3);
-    vertTemp.push_back(p4);
-    _vert.swap(vertTemp);
-}
-bool Quad::haveRepeatVert() const
+template <typename T>
+bool LineT<T>::crossing(const LineT &line, Point *p) const
 {
-    bool bRep = (
-        p1 == p2 || p1 == p3 || p1 == p4 ||
-        p2 == p3 || p2 == p4 ||
-        p3 == p4
-        );
-    return bRep;
-}
-
-double Quad::area() const
-{
-    Vertexes vertTemp;
-    getVertList(vertTemp);
+    const T zero = Tolerance<T>::zero();
+    const Point a12 = p2() - p1();
+    const Point b12 = line.p2() - line.p1();
+    // |ab| is |a12||b12| times the sine of their angle.
+    T ab = a12^b12;
+    if (ab*ab <= zero*zero*(a12*a12)*(b12*b12))
+        return false;
 
-    return areaEx(vertTemp);
+    // p1 + m*a12 = line.p1 + n*b12, m and n in [0,1] within zero, both
+    // scaled by |ab| to compare without dividing.
+    const Point r = line.p1() - p1();
+    T m = r^b12;
+    T n = r^a12;
+    if (ab < T(0)) {
+        ab = -ab;
+        m = -m;
+        n = -n;
+    }
+    const T tol = zero*ab;
+    if (m < -tol || m > ab + tol ||
+        n < -tol || n > ab + tol)
+        return false;
+    // Segments sharing an endpoint give it exactly.
+    if (p == 0)
+        return true;
+    if (n == T(0) || n == ab)
+        *p = (n == T(0)) ? line.p1() : line.p2();
+    else if (m == ab)
+        *p = p2();
+    else
+        *p = p1() + a12*(m/ab);
+    return true;
 }
 
-WiseType Quad::whichWise() const
+// Kernels on contiguous vertex arrays, shared by the Vertexes path and
+// the allocation-free Quad path.
+namespace
 {
-    Vertexes vertTemp;
-    getVertList(vertTemp);
-    return whichWiseEx(vertTemp);
-}
-void Quad::beInSomeWise(const WiseType wiseType)
+
+// Vertexes of the intersection of two convex polygons of at most N
+// vertexes, before ordering. Each of the NxN edge pairs may report a
+// crossing (a crossing at a vertex is reported by both adjacent edges),
+// plus up to N inner vertexes from each polygon.
+template <int N>
+struct InterCapacity
 {
-    if (wiseType != NoneWise) {
-        Vertexes vertTemp;
-        getVertList(vertTemp);
-        beInSomeWiseEx(vertTemp,wiseType);
-        p1 = vertTemp[0];
-        p2 = vertTemp[1];
-        p3 = vertTemp[2];
-        p4 = vertTemp[3];
-    }
-}
+    enum { value = N * N + N + N };
+};
 
-LocPosition Quad::location(const Point &p) const
+template <typename T>
+struct AngPoint
 {
-    Vertexes vertTemp;
-    getVertList(vertTemp);
-    return locationEx(vertTemp, p);
+    typedef std::pair<double, Vec2<T> > type;
+};
+template <typename T>
+bool angIncrease(const typename AngPoint<T>::type &p1, const typename AngPoint<T>::type &p2)
+{
+    return p1.first < p2.first;
 }
-int Quad::interPts(const Line &line, Vertexes &pts) const
+template <typename T>
+bool angDecrease(const typename AngPoint<T>::type &p1, const typename AngPoint<T>::type &p2)
 {
-    Vertexes vertTemp;
-    getVertList(vertTemp);
-    return interPtsEx(vertTemp, line, pts);
+    return p1.first > p2.first;
 }
 
-double areaEx(const Vertexes &C)
+template <typename T>
+T sumTriangles(const Vec2<T> *C, const int N)
 {
-    if (whichWiseEx(C) == NoneWise)
-        return -1.0;
-
-    double sArea = 0.0;
-    const int N = C.size();
+    T sArea = 0;
     if (N > 2) {
-        const Point &p0 = C.at(0);
+        const Vec2<T> &p0 = C[0];
         for (int i = 1; i < N-1; ++i) {
-            const Point &p1 = C.at(i);
-            const Point &p2 = C.at(i + 1);
-            Point p01 = p1 - p0;
-            Point p02 = p2 - p0;
-            sArea += abs(p01^p02)*0.5;
+            const Vec2<T> &p1 = C[i];
+            const Vec2<T> &p2 = C[i + 1];
+            Vec2<T> p01 = p1 - p0;
+            Vec2<T> p02 = p2 - p0;
+            sArea += abs(p01^p02)*T(0.5);
         }
     }
     return sArea;
 }
-WiseType whichWiseEx(const Vertexes &C)
+template <typename T>
+AABBT<T> boundsP(const Vec2<T> *C, const int N)
 {
+    if (N == 0)
+        return AABBT<T>();
+    AABBT<T> box(C[0].x, C[0].y, C[0].x, C[0].y);
+    for (int i = 1; i < N; ++i) {
+        box.xMin = std::min(box.xMin, C[i].x);
+        box.xMax = std::max(box.xMax, C[i].x);
+        box.yMin = std::min(box.yMin, C[i].y);
+        box.yMax = std::max(box.yMax, C[i].y);
+    }
+    return box;
+}
+template <typename T>
+WiseType whichWiseP(const Vec2<T> *C, const int N)
+{
+    const T zero = Tolerance<T>::zero();
     WiseType wiseType = NoneWise;
-    const int N = C.size();
 
     if (N > 2) {
-        Point p0 = C.at(N - 1);
-        Point p1 = C.at(0);
-        Point p2 = C.at(1);
-        Point p01 = p1 - p0;
-        Point p12 = p2 - p1;
-        if ((abs(p01^p12) <= _ZERO_) && p01*p12 < 0.0)
+        Vec2<T> p0 = C[N - 1];
+        Vec2<T> p1 = C[0];
+        Vec2<T> p2 = C[1];
+        Vec2<T> p01 = p1 - p0;
+        Vec2<T> p12 = p2 - p1;
+        if ((abs(p01^p12) <= zero) && p01*p12 < T(0))
             return NoneWise;
         else
-            wiseType = (p01^p12) > 0.0 ? AntiClockWise : ClockWise;
+            wiseType = (p01^p12) > T(0) ? AntiClockWise : ClockWise;
 
-        const double flip = (wiseType == ClockWise) ? 1.0 : -1.0;
+        const T flip = (wiseType == ClockWise) ? T(1) : T(-1);
         for (int i = 1; i < N ; ++i) {
-            p0 = C.at((i-1)%N);
-            p1 = C.at(i%N);
-            p2 = C.at((i+1)%N);
+            p0 = C[(i-1)%N];
+            p1 = C[i%N];
+            p2 = C[(i+1)%N];
             p01 = p1 - p0;
             p12 = p2 - p1;
-            if ((p01^p12)*flip > 0.0 ||
-                ((abs(p01^p12) <= _ZERO_) && p01*p12 < 0.0)) {
+            if ((p01^p12)*flip > T(0) ||
+                ((abs(p01^p12) <= zero) && p01*p12 < T(0))) {
                 return NoneWise;
             }
         }
     }
     return wiseType;
 }
-typedef std::pair<double, Point> AngPoint;
-bool angIncrease(const AngPoint &p1, const AngPoint &p2)
+template <typename T>
+T areaP(const Vec2<T> *C, const int N)
 {
-    return p1.first < p2.first;
+    if (whichWiseP(C, N) == NoneWise)
+        return T(-1);
+    return sumTriangles(C, N);
 }
-bool angDecrease(const AngPoint &p1, const AngPoint &p2)
+// Quadrant of d, counterclockwise from the x axis as Vec2::theta():
+// [0,pi/2) is 0, ..., [3pi/2,2pi) is 3, and the zero vector comes first.
+template <typename T>
+inline int quadrant(const Vec2<T> &d)
 {
-    return p1.first > p2.first;
+    if (d.x > T(0) && d.y >= T(0))
+        return 0;
+    if (d.x <= T(0) && d.y > T(0))
+        return 1;
+    if (d.x < T(0) && d.y <= T(0))
+        return 2;
+    if (d.x >= T(0) && d.y < T(0))
+        return 3;
+    return -1;
 }
-void beInSomeWiseEx(Vertexes &C, const WiseType wiseType)
-{
-    if (wiseType != NoneWise) {
-        const int N = C.size();
-        if (N>2) {
-            Point pO(0.0,0.0);
-            for (int i = 0; i < N; ++i)
-                pO += C.at(i);
-            pO /= N;
-            std::vector<AngPoint> APList;
-            APList.reserve(N);
-            for (int i = 0; i < N; ++i) {
-                Point op = C.at(i) - pO;
-                double ang = op.theta();
-                APList.push_back(AngPoint(ang, C.at(i)));
-            }
-            if (wiseType == AntiClockWise)
-                std::sort(APList.begin(), APList.end(), angIncrease);
-            else
-                std::sort(APList.begin(), APList.end(), angDecrease);
-            Vertexes vertTemp;
-            for (int i = 0; i < N; ++i)
-                vertTemp.push_back(APList.at(i).second);
-            C.swap(vertTemp);
-        }
+// Counterclockwise order by angle around a center, from the x axis.
+// Within a quadrant the angles differ by less than pi/2, so the sign of
+// the cross product decides.
+template <typename T>
+struct AngleLess
+{
+    explicit AngleLess(const Vec2<T> &_center) : center(_center) {}
+    inline bool operator()(const Vec2<T> &a, const Vec2<T> &b) const {
+        const Vec2<T> da = a - center;
+        const Vec2<T> db = b - center;
+        const int qa = quadrant(da);
+        const int qb = quadrant(db);
+        if (qa != qb)
+            return qa < qb;
+        return (da^db) > T(0);
+    }
+    Vec2<T> center;
+};
+template <typename T>
+struct AngleGreater
+{
+    explicit AngleGreater(const Vec2<T> &center) : less(center) {}
+    inline bool operator()(const Vec2<T> &a, const Vec2<T> &b) const {
+        return less(b, a);
+    }
+    AngleLess<T> less;
+};
+
+// Optimal sorting networks for 2 to 8 items, as pairs of indexes.
+const unsigned char SortNet2[] = { 0,1 };
+const unsigned char SortNet3[] = { 1,2, 0,2, 0,1 };
+const unsigned char SortNet4[] = { 0,1, 2,3, 0,2, 1,3, 1,2 };
+const unsigned char SortNet5[] = { 0,1, 3,4, 2,4, 2,3, 1,4, 0,3, 0,2, 1,3, 1,2 };
+const unsigned char SortNet6[] = { 1,2, 4,5, 0,2, 3,5, 0,1, 3,4, 2,5, 0,3, 1,4,
+                                   2,4, 1,3, 2,3 };
+const unsigned char SortNet7[] = { 1,2, 3,4, 5,6, 0,2, 3,5, 4,6, 0,1, 4,5, 2,6,
+                                   0,4, 1,5, 0,3, 2,5, 1,3, 2,4, 2,3 };
+const unsigned char SortNet8[] = { 0,2, 1,3, 4,6, 5,7, 0,4, 1,5, 2,6, 3,7, 0,1,
+                                   2,3, 4,5, 6,7, 2,4, 3,5, 1,4, 3,6, 1,2, 3,4,
+                                   5,6 };
+const unsigned char* const SortNets[9] = {
+    0, 0, SortNet2, SortNet3, SortNet4, SortNet5, SortNet6, SortNet7, SortNet8 };
+const int SortNetSizes[9] = { 0, 0, 1, 3, 5, 9, 12, 16, 19 };
+
+// Vertex relative to the center, with its quadrant computed once.
+template <typename T>
+struct AngleKey
+{
+    Vec2<T> d;
+    int q;
+    int i;
+};
+template <typename T>
+inline bool keyLess(const AngleKey<T> &a, const AngleKey<T> &b)
+{
+    return a.q != b.q ? a.q < b.q : (a.d^b.d) > T(0);
+}
+
+// Sort C by angle around center, increasing for AntiClockWise and
+// decreasing otherwise. Up to 8 vertexes, the sizes given by
+// quadrilaterals, are sorted by a network over precomputed keys.
+template <typename T>
+void sortByAngle(Vec2<T> *C, const int N, const Vec2<T> &center, const WiseType wiseType)
+{
+    if (N > 8) {
+        if (wiseType == AntiClockWise)
+            std::sort(C, C + N, AngleLess<T>(center));
+        else
+            std::sort(C, C + N, AngleGreater<T>(center));
+        return;
+    }
+    if (N < 2)
+        return;
+    AngleKey<T> keys[8];
+    for (int i = 0; i < N; ++i) {
+        keys[i].d = C[i] - center;
+        keys[i].q = quadrant(keys[i].d);
+        keys[i].i = i;
     }
+    const bool increasing = (wiseType == AntiClockWise);
+    const unsigned char *net = SortNets[N];
+    for (int k = 0; k < SortNetSizes[N]; ++k) {
+        AngleKey<T> &a = keys[net[2*k]];
+        AngleKey<T> &b = keys[net[2*k + 1]];
+        if (increasing ? keyLess(b, a) : keyLess(a, b))
+            std::swap(a, b);
+    }
+    Vec2<T> sorted[8];
+    for (int i = 0; i < N; ++i)
+        sorted[i] = C[keys[i].i];
+    for (int i = 0; i < N; ++i)
+        C[i] = sorted[i];
 }
 
-LocPosition locationEx(const Vertexes &C, const Point &p)
+template <typename T>
+Vec2<T> centroidP(const Vec2<T> *C, const int N)
 {
-    const int N = C.size();
+    Vec2<T> pO(0,0);
+    for (int i = 0; i < N; ++i)
+        pO += C[i];
+    pO /= T(N);
+    return pO;
+}
+// Sort C in place by angle around its centroid, without trigonometry.
+template <typename T>
+void beInSomeWiseP(Vec2<T> *C, const int N, const WiseType wiseType)
+{
+    IOU_STAT_STAGE(StageOrder);
+    if (wiseType != NoneWise && N > 2) {
+        sortByAngle(C, N, centroidP(C, N), wiseType);
+    }
+}
+// Same by the theta of each vertex, using the caller's scratch buffer of
+// at least N entries.
+template <typename T>
+void beInSomeWiseThetaP(Vec2<T> *C, const int N, const WiseType wiseType,
+                        typename AngPoint<T>::type *APList)
+{
+    IOU_STAT_STAGE(StageOrder);
+    if (wiseType != NoneWise && N > 2) {
+        const Vec2<T> pO = centroidP(C, N);
+        for (int i = 0; i < N; ++i) {
+            Vec2<T> op = C[i] - pO;
+            APList[i] = typename AngPoint<T>::type(op.theta(), C[i]);
+        }
+        if (wiseType == AntiClockWise)
+            std::sort(APList, APList + N, angIncrease<T>);
+        else
+            std::sort(APList, APList + N, angDecrease<T>);
+        for (int i = 0; i < N; ++i)
+            C[i] = APList[i].second;
+    }
+}
+template <typename T>
+LocPosition locationP(const Vec2<T> *C, const int N, const Vec2<T> &p)
+{
+    typedef LineT<T> Line;
+
     // Special cases.
     if (N == 0)
         return OutSide;
@@ -264,158 +411,1869 @@ LocPosition locationEx(const Vertexes &C, const Point &p)
             return OnLine;
     }
     // Check outside.
-    Point pO(0.0,0.0);
+    Vec2<T> pO(0,0);
     for (int i=0; i<N; ++i) {
         pO += C[i];
     }
-    pO /= N;
+    pO /= T(N);
     Line op(pO,p);
-    bool bIntersection = true;
     for (int i=0; i<N; ++i) {
-        intersection(Line(C[i%N],C[(i+1)%N]),op,&bIntersection);
-        if (bIntersection)
+        if (Line(C[i%N],C[(i+1)%N]).crossing(op))
             return OutSide;
     }
 
     return InSide;
 }
-int interPtsEx(const Vertexes &C, const Line &line, Vertexes &pts)
+// Same as locationP for a polygon of N >= 3 vertexes given by its edges
+// and the mean of its vertexes.
+template <typename T>
+LocPosition locationEdgesP(const LineT<T> *E, const int N, const Vec2<T> &pO,
+                           const Vec2<T> &p)
 {
-    Vertexes vertTemp;
-    const int N = C.size();
-    bool bIntersection = false;
     for (int i=0; i<N; ++i) {
-        Point p = intersection(Line(C[i%N],C[(i+1)%N]),line,&bIntersection);
-        if (bIntersection)
-            vertTemp.push_back(p);
+        if (isOnLine(E[i],p))
+            return OnLine;
+    }
+    LineT<T> op(pO,p);
+    for (int i=0; i<N; ++i) {
+        if (E[i].crossing(op))
+            return OutSide;
     }
-    pts.swap(vertTemp);
-
     return InSide;
 }
+// Polygons from which the wedge search below beats the linear scan of
+// locationP.
+const int WedgeMinSize = 16;
 
-int findInterPointsEx(const Vertexes &C1, const Vertexes &C2, Vertexes &vert)
+// Squared distance from p to the segment ab.
+template <typename T>
+T segmentSquareDistance(const Vec2<T> &p, const Vec2<T> &a, const Vec2<T> &b)
 {
-    Vertexes _vert;
-    const int N = C2.size();
+    const Vec2<T> ab = b - a;
+    const T len = ab.normSquared();
+    const T t = len > T(0) ? std::min(T(1), std::max(T(0), (p - a)*ab / len)) : T(0);
+    return p.squareDistance(a + ab*t);
+}
+// Squared distance from p to the ray from a through b.
+template <typename T>
+T raySquareDistance(const Vec2<T> &p, const Vec2<T> &a, const Vec2<T> &b)
+{
+    const Vec2<T> ab = b - a;
+    const T len = ab.normSquared();
+    const T t = len > T(0) ? std::max(T(0), (p - a)*ab / len) : T(0);
+    return p.squareDistance(a + ab*t);
+}
+// Distance from pO, inside the convex polygon C, to its boundary.
+template <typename T>
+T boundaryDistanceP(const Vec2<T> *C, const int N, const Vec2<T> &pO)
+{
+    T d2 = std::numeric_limits<T>::max();
+    for (int i = 0; i < N; ++i)
+        d2 = std::min(d2, segmentSquareDistance(pO, C[i], C[(i+1)%N]));
+    return std::sqrt(d2);
+}
+
+template <typename T>
+inline const Vec2<T>& wedgeVertex(const Vec2<T> *C, const int N, const bool anti,
+                                  const int k)
+{
+    return C[anti ? k : (N - k) % N];
+}
+// Same as locationP for a convex polygon of N >= 3 vertexes of known
+// winding, whose vertex mean pO is at distance dO from the boundary, in
+// O(log N). The fan of triangles from vertex 0 is binary searched for
+// the one holding p, which tells InSide from OutSide.
+// locationP reports OnLine within about 1.5 sqrt(zero()) of an edge, and
+// OutSide within zero() |p - pO| inside one, or anywhere if pO itself is
+// that close. Those points are only reached through the edge of the
+// wedge or its two bounding rays, so when any of them is that close, or
+// pO is, the result is left to locationP. Returns false in that case.
+template <typename T>
+bool locationWedgeP(const Vec2<T> *C, const int N, const WiseType wise,
+                    const Vec2<T> &pO, const T dO, const Vec2<T> &p,
+                    LocPosition &loc)
+{
+    const T zero = Tolerance<T>::zero();
+    const T tol = zero*std::sqrt(p.squareDistance(pO));
+    if (dO <= tol)
+        return false;
+    const T band = std::max(T(1.5)*std::sqrt(zero), tol);
+    const T band2 = band*band;
+
+    // Vertexes are walked AntiClockWise, k from 0 to N-1.
+    const bool anti = (wise == AntiClockWise);
+    const Vec2<T> &a = C[0];
+    const Vec2<T> d = p - a;
+    const Vec2<T> &first = wedgeVertex(C, N, anti, 1);
+    const Vec2<T> &last = wedgeVertex(C, N, anti, N-1);
+    if (((first - a)^d) < T(0) || ((last - a)^d) > T(0)) {
+        // Outside the cone of the polygon at vertex 0.
+        if (raySquareDistance(p, a, first) <= band2 || raySquareDistance(p, a, last) <= band2)
+            return false;
+        loc = OutSide;
+        return true;
+    }
+    int lo = 1, hi = N - 1;
+    while (hi - lo > 1) {
+        const int mid = (lo + hi) / 2;
+        if (((wedgeVertex(C, N, anti, mid) - a) ^ d) >= T(0))
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const Vec2<T> &b = wedgeVertex(C, N, anti, lo);
+    const Vec2<T> &c = wedgeVertex(C, N, anti, lo + 1);
+    if (segmentSquareDistance(p, b, c) <= band2 ||
+        raySquareDistance(p, a, b) <= band2 || raySquareDistance(p, a, c) <= band2)
+        return false;
+    loc = ((c - b) ^ (p - b)) > T(0) ? InSide : OutSide;
+    return true;
+}
+
+template <typename T, class Buffer>
+void appendInterPts(const Vec2<T> *C, const int N, const LineT<T> &line, Buffer &pts)
+{
+    Vec2<T> p;
     for (int i=0; i<N; ++i) {
-        Vertexes pts;
-        interPtsEx(C1,Line(C2[i%N],C2[(i+1)%N]),pts);
-        for (int i = 0; i < pts.size(); ++i)
-            _vert.push_back(pts.at(i));
+        if (LineT<T>(C[i%N],C[(i+1)%N]).crossing(line, &p))
+            pts.push_back(p);
     }
-    vert.swap(_vert);
-    return vert.size();
 }
-int findInnerPointsEx(const Vertexes &C1, const Vertexes &C2, Vertexes &vert)
+template <typename T, class Buffer>
+void appendInterPoints(const Vec2<T> *C1, const int N1,
+                       const Vec2<T> *C2, const int N2, Buffer &vert)
+{
+    IOU_STAT_STAGE(StageInterPoints);
+    for (int i=0; i<N2; ++i)
+        appendInterPts(C1, N1, LineT<T>(C2[i%N2],C2[(i+1)%N2]), vert);
+}
+template <typename T, class Buffer>
+void appendInnerPoints(const Vec2<T> *C1, const int N1,
+                       const Vec2<T> *C2, const int N2, Buffer &vert)
 {
-    Vertexes _vert;
-    for (int i=0; i<C2.size(); ++i) {
-        if (locationEx(C1,C2[i]) != OutSide)
-            _vert.push_back(C2[i]);
+    IOU_STAT_STAGE(StageInnerPoints);
+    for (int i=0; i<N2; ++i) {
+        if (locationP(C1, N1, C2[i]) != OutSide)
+            vert.push_back(C2[i]);
     }
-    vert.swap(_vert);
-    return vert.size();
 }
-double areaIntersectionEx(const Vertexes &C1, const Vertexes &C2)
+
+// Whether a buffer lost vertexes for lack of capacity; never for vectors.
+template <typename T>
+inline bool overflowed(const std::vector<Vec2<T> > &) { return false; }
+template <int N, typename T>
+inline bool overflowed(const SmallPolygon<N, T> &P) { return P.overflowed(); }
+
+// Sutherland-Hodgman: clip the convex polygon C1 by every edge of the
+// convex polygon C2 in turn. buf1 and buf2 are scratch buffers of capacity
+// N1+N2, the returned one holds the result in the same order as C1.
+// Stops with the returned buffer overflowed if a fixed one fills up.
+template <typename T, class Buffer>
+Buffer& clipConvexP(const Vec2<T> *C1, const int N1,
+                    const Vec2<T> *C2, const int N2, const WiseType wise2,
+                    Buffer &buf1, Buffer &buf2)
 {
-    if (whichWiseEx(C1) == NoneWise ||
-        whichWiseEx(C2) == NoneWise )
-        return -1.0;
+    IOU_STAT_STAGE(StageClip);
+    Buffer *in = &buf1;
+    Buffer *out = &buf2;
+    out->clear();
+    for (int i = 0; i < N1; ++i)
+        out->push_back(C1[i]);
 
-    Vertexes interVert;
-    Vertexes innerVert12;
-    Vertexes innerVert21;
-    Vertexes allVerts;
-    //---------------
-    findInterPointsEx(C1, C2, interVert);
-    findInnerPointsEx(C1, C2, innerVert12);
-    findInnerPointsEx(C2, C1, innerVert21);
-    //---------------
-    // TODO : Check conditions
-    for (int i = 0; i < interVert.size(); ++i)
-        allVerts.push_back(interVert.at(i));
-    for (int i = 0; i < innerVert12.size(); ++i)
-        allVerts.push_back(innerVert12.at(i));
-    for (int i = 0; i < innerVert21.size(); ++i)
-        allVerts.push_back(innerVert21.at(i));
-
-    if (allVerts.empty())
-        return 0.0;
+    // Inside of an edge is on its right for ClockWise and left otherwise.
+    const T side = (wise2 == ClockWise) ? T(-1) : T(1);
+    for (int j = 0; j < N2 && !out->empty() && !overflowed(*out); ++j) {
+        const Vec2<T> &a = C2[j];
+        const Vec2<T> ab = C2[(j+1)%N2] - a;
+        std::swap(in, out);
+        out->clear();
+
+        const int N = in->size();
+        Vec2<T> prev = (*in)[N-1];
+        T dPrev = side*(ab^(prev - a));
+        for (int i = 0; i < N; ++i) {
+            const Vec2<T> &cur = (*in)[i];
+            const T dCur = side*(ab^(cur - a));
+            if ((dPrev < T(0) && dCur > T(0)) || (dPrev > T(0) && dCur < T(0)))
+                out->push_back(prev + (cur - prev)*(dPrev/(dPrev - dCur)));
+            if (dCur >= T(0))
+                out->push_back(cur);
+            prev = cur;
+            dPrev = dCur;
+        }
+    }
+    return *out;
+}
+// Same as clipConvexP, with C2 given by the outward normal equations of
+// its edges: the inside of edge j is where normals[j]*p <= offsets[j].
+template <typename T, class Buffer>
+Buffer& clipHalfPlanesP(const Vec2<T> *C1, const int N1,
+                        const Vec2<T> *normals, const T *offsets, const int N2,
+                        Buffer &buf1, Buffer &buf2)
+{
+    IOU_STAT_STAGE(StageClip);
+    Buffer *in = &buf1;
+    Buffer *out = &buf2;
+    out->clear();
+    for (int i = 0; i < N1; ++i)
+        out->push_back(C1[i]);
+
+    for (int j = 0; j < N2 && !out->empty() && !overflowed(*out); ++j) {
+        const Vec2<T> &n = normals[j];
+        const T c = offsets[j];
+        std::swap(in, out);
+        out->clear();
+
+        const int N = in->size();
+        Vec2<T> prev = (*in)[N-1];
+        T dPrev = c - n*prev;
+        for (int i = 0; i < N; ++i) {
+            const Vec2<T> &cur = (*in)[i];
+            const T dCur = c - n*cur;
+            if ((dPrev < T(0) && dCur > T(0)) || (dPrev > T(0) && dCur < T(0)))
+                out->push_back(prev + (cur - prev)*(dPrev/(dPrev - dCur)));
+            if (dCur >= T(0))
+                out->push_back(cur);
+            prev = cur;
+            dPrev = dCur;
+        }
+    }
+    return *out;
+}
+
+// Scratch buffers for intersecting two convex polygons. They are reused
+// across calls, so that batched paths only allocate while they grow.
+template <typename T>
+struct InterScratch
+{
+    typedef std::vector<Vec2<T> > InterVert;
+    typedef std::vector<Vec2<T> > ClipVert;
+    typedef std::vector<Vec2<T> > HullVert;
+
+    InterVert allVerts;
+    ClipVert buf1;
+    ClipVert buf2;
+    HullVert hull;
+    std::vector<double> orient12;
+    std::vector<double> orient21;
+    // Clipping buffers which never overflow, for the fixed scratch below.
+    std::vector<Vec2<T> > spill1;
+    std::vector<Vec2<T> > spill2;
+
+    void reserveClip(const int N) {
+        buf1.reserve(N);
+        buf2.reserve(N);
+    }
+    void reserveHull(const int N) {
+        allVerts.reserve(N);
+        hull.reserve(N + 1);
+    }
+    double* orientTable12(const int N) {
+        if ((int)orient12.size() < N)
+            orient12.resize(N);
+        return orient12.data();
+    }
+    double* orientTable21(const int N) {
+        if ((int)orient21.size() < N)
+            orient21.resize(N);
+        return orient21.data();
+    }
+};
+// Same for two quadrilaterals, without heap allocation.
+template <typename T, int MaxN>
+struct FixedInterScratch
+{
+    // Clipping a polygon of N vertexes by M edges leaves at most N+M
+    // vertexes, twice that leaves room for rounding near collinear edges.
+    typedef SmallPolygon<2 * (MaxN + MaxN), T> ClipVert;
+    typedef SmallPolygon<InterCapacity<MaxN>::value, T> InterVert;
+    // The monotone chain repeats its first vertex at the end.
+    typedef SmallPolygon<InterCapacity<MaxN>::value + 1, T> HullVert;
+
+    InterVert allVerts;
+    ClipVert buf1;
+    ClipVert buf2;
+    HullVert hull;
+    double orient12[MaxN * MaxN];
+    double orient21[MaxN * MaxN];
+    // Heap buffers for clippings that overflow buf1 and buf2, left empty,
+    // and so unallocated, otherwise.
+    std::vector<Vec2<T> > spill1;
+    std::vector<Vec2<T> > spill2;
+
+    void reserveClip(const int) {}
+    void reserveHull(const int) {}
+    double* orientTable12(const int) { return orient12; }
+    double* orientTable21(const int) { return orient21; }
+};
+// Same, for polygons of at most 4 vertexes.
+template <typename T>
+struct QuadInterScratch : FixedInterScratch<T, 4>
+{
+};
+
+// clipConvexP and clipHalfPlanesP into the buffers of scratch, redone in
+// its heap buffers if the fixed ones overflow. P points to the result.
+// Returns its size.
+template <typename T, class Scratch>
+int clipConvexScratchP(const Vec2<T> *C1, const int N1,
+                       const Vec2<T> *C2, const int N2, const WiseType wise2,
+                       Scratch &scratch, const Vec2<T> *&P)
+{
+    scratch.reserveClip(N1 + N2);
+    const typename Scratch::ClipVert &vert = clipConvexP(
+        C1, N1, C2, N2, wise2, scratch.buf1, scratch.buf2);
+    if (!overflowed(vert)) {
+        P = vert.data();
+        return vert.size();
+    }
+    const std::vector<Vec2<T> > &spill = clipConvexP(
+        C1, N1, C2, N2, wise2, scratch.spill1, scratch.spill2);
+    P = spill.data();
+    return spill.size();
+}
+template <typename T, class Scratch>
+int clipHalfPlanesScratchP(const Vec2<T> *C1, const int N1,
+                           const Vec2<T> *normals, const T *offsets, const int N2,
+                           Scratch &scratch, const Vec2<T> *&P)
+{
+    scratch.reserveClip(N1 + N2);
+    const typename Scratch::ClipVert &vert = clipHalfPlanesP(
+        C1, N1, normals, offsets, N2, scratch.buf1, scratch.buf2);
+    if (!overflowed(vert)) {
+        P = vert.data();
+        return vert.size();
+    }
+    const std::vector<Vec2<T> > &spill = clipHalfPlanesP(
+        C1, N1, normals, offsets, N2, scratch.spill1, scratch.spill2);
+    P = spill.data();
+    return spill.size();
+}
+
+template <typename T>
+struct LexLess
+{
+    inline bool operator()(const Vec2<T> &a, const Vec2<T> &b) const {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+};
+// Sort the N points P and merge, in the front of P, those equal within the
+// tolerance of T to a point kept before them; sorted, the candidates are
+// the kept points within that tolerance along x, the last ones.
+// Returns the number of points kept.
+template <typename T>
+int uniqueSortedP(Vec2<T> *P, const int N)
+{
+    const T zero = Tolerance<T>::zero();
+    std::sort(P, P + N, LexLess<T>());
+    int M = 0;
+    for (int i = 0; i < N; ++i) {
+        bool merged = false;
+        for (int k = M - 1; k >= 0 && P[i].x - P[k].x <= zero && !merged; --k)
+            merged = P[i] == P[k];
+        if (!merged)
+            P[M++] = P[i];
+    }
+    return M;
+}
+// Convex hull of the N points P, which are reordered, written to hull.
+// Returns the number of hull vertexes, 0 if fewer than 3 points remain.
+template <typename T, class Buffer>
+int hullP(Vec2<T> *P, const int N, Buffer &hull)
+{
+    const int M = uniqueSortedP(P, N);
+    if (M < 3)
+        return 0;
+
+    // Andrew's monotone chain: lower then upper hull, anticlockwise,
+    // collinear points dropped.
+    hull.clear();
+    for (int i = 0; i < M; ++i) {
+        while (hull.size() >= 2 &&
+               orient2d(hull[hull.size()-2], hull[hull.size()-1], P[i]) <= 0.0)
+            hull.pop_back();
+        hull.push_back(P[i]);
+    }
+    const int lower = hull.size() + 1;
+    for (int i = M - 2; i >= 0; --i) {
+        while ((int)hull.size() >= lower &&
+               orient2d(hull[hull.size()-2], hull[hull.size()-1], P[i]) <= 0.0)
+            hull.pop_back();
+        hull.push_back(P[i]);
+    }
+    hull.pop_back();
+    return hull.size();
+}
+// Whether p is on the right of a->b or on that line, the side of the
+// lower chain of a monotone chain from a to b.
+template <typename T>
+struct BelowLine
+{
+    BelowLine(const Vec2<T> &_a, const Vec2<T> &_b) : a(_a), b(_b) {}
+    inline bool operator()(const Vec2<T> &p) const { return orient2d(a, b, p) <= 0.0; }
+    const Vec2<T> a;
+    const Vec2<T> b;
+};
+template <typename T>
+struct LexGreater
+{
+    inline bool operator()(const Vec2<T> &a, const Vec2<T> &b) const {
+        return LexLess<T>()(b, a);
+    }
+};
+// Douglas-Peucker on the closed polygon C of N vertexes, split at the
+// vertexes 0 and far: mark in keep those farther than sqrt(tol2) from the
+// outline of the ones kept.
+template <typename T>
+void simplifyP(const Vec2<T> *C, const int N, const int far,
+               const T tol2, std::vector<char> &keep)
+{
+    // Chains [i0, i1] still to reduce, i1 == N standing for 0.
+    std::vector<std::pair<int, int> > ranges;
+    ranges.reserve(N);
+    ranges.push_back(std::make_pair(0, far));
+    ranges.push_back(std::make_pair(far, N));
+    while (!ranges.empty()) {
+        const int i0 = ranges.back().first;
+        const int i1 = ranges.back().second;
+        ranges.pop_back();
+        const Vec2<T> &a = C[i0];
+        const Vec2<T> &b = C[i1 % N];
+        int k = -1;
+        T kDist = tol2;
+        for (int i = i0 + 1; i < i1; ++i) {
+            const T d = segmentSquareDistance(C[i], a, b);
+            if (d > kDist) {
+                k = i;
+                kDist = d;
+            }
+        }
+        if (k >= 0) {
+            keep[k] = 1;
+            ranges.push_back(std::make_pair(i0, k));
+            ranges.push_back(std::make_pair(k, i1));
+        }
+    }
+}
+
+// Intersection of two convex polygons with exact predicates.
+// The orientation of every vertex of each polygon against every edge of
+// the other, computed once, gives both the inner vertexes and the proper
+// edge crossings. Touching and collinear contacts give vertexes on the
+// boundary of the other polygon, which count as inner. The soup is then
+// ordered as its convex hull, so the result is always convex.
+// The hull, anticlockwise, is left in scratch.hull; returns its size, or
+// -1 if a fixed scratch buffer overflows.
+template <typename T, class Scratch>
+int interRobustP(const Vec2<T> *C1, const int N1, const WiseType wise1,
+                 const Vec2<T> *C2, const int N2, const WiseType wise2,
+                 Scratch &scratch)
+{
+    IOU_STAT_STAGE(StageClip);
+    // o12[j*N1+i] is the side of vertex i of C1 to edge j of C2,
+    // o21[i*N2+j] that of vertex j of C2 to edge i of C1, both >= 0 inside.
+    double *o12 = scratch.orientTable12(N1 * N2);
+    double *o21 = scratch.orientTable21(N1 * N2);
+    const double side1 = (wise1 == ClockWise) ? -1.0 : 1.0;
+    const double side2 = (wise2 == ClockWise) ? -1.0 : 1.0;
+    for (int j = 0; j < N2; ++j)
+        for (int i = 0; i < N1; ++i)
+            o12[j*N1 + i] = side2 * orient2d(C2[j], C2[(j+1)%N2], C1[i]);
+    for (int i = 0; i < N1; ++i)
+        for (int j = 0; j < N2; ++j)
+            o21[i*N2 + j] = side1 * orient2d(C1[i], C1[(i+1)%N1], C2[j]);
+
+    // At most one proper crossing per pair of edges.
+    scratch.reserveHull(N1*N2 + N1 + N2);
+    typename Scratch::InterVert &pts = scratch.allVerts;
+    pts.clear();
+    for (int i = 0; i < N1; ++i) {
+        int j = 0;
+        while (j < N2 && o12[j*N1 + i] >= 0.0)
+            ++j;
+        if (j == N2)
+            pts.push_back(C1[i]);
+    }
+    for (int j = 0; j < N2; ++j) {
+        int i = 0;
+        while (i < N1 && o21[i*N2 + j] >= 0.0)
+            ++i;
+        if (i == N1)
+            pts.push_back(C2[j]);
+    }
+    for (int i = 0; i < N1; ++i) {
+        const int i1 = (i+1)%N1;
+        for (int j = 0; j < N2; ++j) {
+            const double oa = o12[j*N1 + i];
+            const double ob = o12[j*N1 + i1];
+            if (!((oa < 0.0 && ob > 0.0) || (oa > 0.0 && ob < 0.0)))
+                continue;
+            const double oc = o21[i*N2 + j];
+            const double od = o21[i*N2 + (j+1)%N2];
+            if (!((oc < 0.0 && od > 0.0) || (oc > 0.0 && od < 0.0)))
+                continue;
+            pts.push_back(C1[i] + (C1[i1] - C1[i]) * T(oa / (oa - ob)));
+        }
+    }
+    if (overflowed(pts))
+        return -1;
+    const int n = hullP(pts.data(), pts.size(), scratch.hull);
+    return overflowed(scratch.hull) ? -1 : n;
+}
+
+// Vertexes of a strided view copied to a contiguous buffer, on the stack
+// for small polygons.
+template <typename T>
+class GatheredPolygon {
+public:
+    explicit GatheredPolygon(const StridedPolygonViewT<T> &C)
+        : n(C.size())
+    {
+        if (n > Small::capacity()) {
+            big.resize(n);
+            for (int i = 0; i < n; ++i)
+                big[i] = C[i];
+            ptr = big.data();
+        }
+        else {
+            for (int i = 0; i < n; ++i)
+                small.push_back(C[i]);
+            ptr = small.data();
+        }
+    }
+    PolygonViewT<T> view() const { return PolygonViewT<T>(ptr, n); }
+
+private:
+    typedef SmallPolygon<32, T> Small;
+
+    Small small;
+    std::vector<Vec2<T> > big;
+    const Vec2<T> *ptr;
+    int n;
+};
+
+// Point soup of PointSoup ordered clockwise in place.
+// Returns its size, 0 if it has fewer than 3 points, as when the polygons
+// only touch at a corner, or -1 if it cannot be ordered as a convex
+// polygon.
+template <typename T, class Buffer>
+int orderSoupP(Buffer &allVerts)
+{
+    if (overflowed(allVerts))
+        return -1;
+    if (allVerts.size() < 3)
+        return 0;
     else {
-        assert(allVerts.size() >= 3);
-        beInSomeWiseEx(allVerts, ClockWise);
-        if (whichWiseEx(allVerts) == NoneWise)
-            return -1.0;
+        const int N = allVerts.size();
+        beInSomeWiseP(allVerts.data(), N, ClockWise);
+        if (whichWiseP(allVerts.data(), N) == NoneWise)
+            return -1;
         else
-            return areaEx(allVerts);
+            return N;
+    }
+    return -1;
+}
+
+// Intersection of two convex polygons which are known not to be
+// NoneWise, left in scratch with P pointing to its vertexes.
+// Returns their number, or -1 if PointSoup cannot order them.
+template <typename T, class Scratch>
+int interPolygonP(const Vec2<T> *C1, const int N1, const WiseType wise1,
+                  const Vec2<T> *C2, const int N2, const WiseType wise2,
+                  const InterMethod method, Scratch &scratch, const Vec2<T> *&P)
+{
+    if (method == RobustSoup) {
+        const int n = interRobustP(C1, N1, wise1, C2, N2, wise2, scratch);
+        P = scratch.hull.data();
+        return n;
+    }
+    if (method == ConvexClip)
+        return clipConvexScratchP(C1, N1, C2, N2, wise2, scratch, P);
+
+    typename Scratch::InterVert &allVerts = scratch.allVerts;
+    allVerts.clear();
+    //---------------
+    appendInterPoints(C1, N1, C2, N2, allVerts);
+    appendInnerPoints(C1, N1, C2, N2, allVerts);
+    appendInnerPoints(C2, N2, C1, N1, allVerts);
+    //---------------
+    P = allVerts.data();
+    return orderSoupP<T>(allVerts);
+}
+// Area of the n vertexes P of an intersection, -1 if n is.
+template <typename T>
+T interAreaP(const Vec2<T> *P, const int n)
+{
+    IOU_STAT_ADD(StatIntersections, 1);
+    if (n < 0) {
+        IOU_STAT_ADD(StatSoupFailures, 1);
+        return T(-1);
     }
-    return -1.0;
+    IOU_STAT_ADD(StatInterVertexes, n);
+    IOU_STAT_STAGE(StageArea);
+    return sumTriangles(P, n);
 }
-double areaUnionEx(const Vertexes &C1, const Vertexes &C2)
+// Area of the intersection of two convex polygons which are known not to
+// be NoneWise.
+template <typename T, class Scratch>
+T areaInterP(const Vec2<T> *C1, const int N1, const WiseType wise1,
+             const Vec2<T> *C2, const int N2, const WiseType wise2,
+             const InterMethod method, Scratch &scratch)
 {
-    return areaEx(C1) + areaEx(C2) - areaIntersectionEx(C1, C2);
+    const Vec2<T> *P = 0;
+    const int n = interPolygonP(C1, N1, wise1, C2, N2, wise2, method, scratch, P);
+    return interAreaP(P, n);
 }
-double iouEx(const Vertexes &C1, const Vertexes &C2)
+// Copy the n vertexes P of an intersection to out in wise, dropping
+// repeated ones and those collinear with their neighbours within zero,
+// as whichWiseEx would reject them. Returns the number copied, 0 if
+// fewer than 3 are left, or -1 if n is.
+template <typename T>
+int outputPolygonP(const Vec2<T> *P, const int n, const WiseType wise,
+                   std::vector<Vec2<T> > &out)
 {
-    return areaIntersectionEx(C1,C2)/areaUnionEx(C1,C2);
+    out.clear();
+    if (n < 0)
+        return -1;
+    for (int i = 0; i < n; ++i) {
+        if (out.empty() || !(P[i] == out.back()))
+            out.push_back(P[i]);
+    }
+    while (out.size() > 1 && out.front() == out.back())
+        out.pop_back();
+    // Around the polygon until a whole turn keeps every vertex, stepping
+    // back after a drop as the previous vertex has a new neighbour.
+    const T zero = Tolerance<T>::zero();
+    int i = 0, kept = 0;
+    while (out.size() >= 3 && kept < (int)out.size()) {
+        const int m = out.size();
+        const Vec2<T> &a = out[(i + m - 1) % m];
+        const Vec2<T> &b = out[i];
+        const Vec2<T> &c = out[(i + 1) % m];
+        if (abs((b - a)^(c - b)) <= zero) {
+            out.erase(out.begin() + i);
+            kept = 0;
+            i = (i + m - 2) % (m - 1);
+        }
+        else {
+            ++kept;
+            i = (i + 1) % m;
+        }
+    }
+    if (out.size() < 3) {
+        out.clear();
+        return 0;
+    }
+    // Signed area, positive when anticlockwise.
+    T s = 0;
+    for (size_t k = 1; k + 1 < out.size(); ++k)
+        s += (out[k] - out[0]) ^ (out[k+1] - out[0]);
+    if ((s > T(0)) != (wise == AntiClockWise))
+        std::reverse(out.begin(), out.end());
+    return out.size();
 }
 
-int findInterPoints(const Quad &Q1, const Quad &Q2, Vertexes &vert)
+// Area centroid of the convex polygon C, its vertex centroid if it is flat.
+template <typename T>
+Vec2<T> areaCentroidP(const Vec2<T> *C, const int N)
 {
-    Vertexes V1, V2;
-    Q1.getVertList(V1);
-    Q2.getVertList(V2);
-    return findInterPointsEx(V1,V2,vert);
+    Vec2<T> c(0,0);
+    T sArea = 0;
+    for (int i = 1; i < N-1; ++i) {
+        const T a = abs((C[i] - C[0])^(C[i+1] - C[0]));
+        c += (C[0] + C[i] + C[i+1]) * a;
+        sArea += a;
+    }
+    if (sArea > T(0))
+        return c / (T(3) * sArea);
+    return N > 0 ? centroidP(C, N) : Vec2<T>(0,0);
+}
+
+template <typename T>
+IouMetricsT<T> invalidMetrics()
+{
+    IouMetricsT<T> m;
+    m.intersection = m.unionArea = m.iou = m.giou = m.diou = T(-1);
+    return m;
 }
-int findInnerPoints(const Quad &Q1, const Quad &Q2, Vertexes &vert)
+// Fused metrics of two convex polygons which are known not to be
+// NoneWise, from their areas and bounding boxes.
+template <typename T, class Scratch>
+IouMetricsT<T> metricsP(const Vec2<T> *C1, const int N1, const WiseType wise1,
+                        const T area1, const AABBT<T> &box1,
+                        const Vec2<T> *C2, const int N2, const WiseType wise2,
+                        const T area2, const AABBT<T> &box2,
+                        const unsigned int metrics, const InterMethod method,
+                        Scratch &scratch)
 {
-    Vertexes V1, V2;
-    Q1.getVertList(V1);
-    Q2.getVertList(V2);
-    return findInnerPointsEx(V1,V2,vert);
+    IouMetricsT<T> m;
+    IOU_STAT_ADD(StatPairs, 1);
+    if (box1.overlaps(box2))
+        m.intersection = areaInterP(C1, N1, wise1, C2, N2, wise2, method, scratch);
+    else {
+        IOU_STAT_ADD(StatRejected, 1);
+        m.intersection = T(0);
+    }
+    if (m.intersection < T(0))
+        return invalidMetrics<T>();
+    m.unionArea = area1 + area2 - m.intersection;
+    m.iou = m.intersection / m.unionArea;
+    m.giou = 0;
+    m.diou = 0;
+
+    if (metrics & MetricGIou) {
+        // The scratch is free again once the intersection is known.
+        scratch.reserveHull(N1 + N2);
+        typename Scratch::InterVert &pts = scratch.allVerts;
+        pts.clear();
+        for (int i = 0; i < N1; ++i)
+            pts.push_back(C1[i]);
+        for (int i = 0; i < N2; ++i)
+            pts.push_back(C2[i]);
+        const int n = hullP(pts.data(), pts.size(), scratch.hull);
+        const T hull = sumTriangles(scratch.hull.data(), n);
+        m.giou = hull > T(0) ? m.iou - (hull - m.unionArea) / hull : m.iou;
+    }
+    if (metrics & MetricDIou) {
+        const T d2 = areaCentroidP(C1, N1).squareDistance(areaCentroidP(C2, N2));
+        const T w = std::max(box1.xMax, box2.xMax) - std::min(box1.xMin, box2.xMin);
+        const T h = std::max(box1.yMax, box2.yMax) - std::min(box1.yMin, box2.yMin);
+        const T c2 = w*w + h*h;
+        m.diou = c2 > T(0) ? m.iou - d2 / c2 : m.iou;
+    }
+    return m;
 }
-double areaIntersection(const Quad&Q1, const Quad &Q2)
+// Same as areaInterP on the vertexes of P1 and P2, reusing their edges,
+// centroids and normal equations.
+template <typename T, class Scratch>
+T areaInterPreparedP(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+                     const InterMethod method, Scratch &scratch)
 {
-    if (Q1.whichWise() == NoneWise ||
-        Q2.whichWise() == NoneWise )
-        return -1.0;
+    const Vec2<T> *C1 = P1.vertexes().data();
+    const Vec2<T> *C2 = P2.vertexes().data();
+    const int N1 = P1.size();
+    const int N2 = P2.size();
+    if (method == RobustSoup) {
+        const int n = interRobustP(C1, N1, P1.whichWise(),
+                                   C2, N2, P2.whichWise(), scratch);
+        return interAreaP(scratch.hull.data(), n);
+    }
+    if (method == ConvexClip) {
+        const Vec2<T> *P = 0;
+        const int n = clipHalfPlanesScratchP(C1, N1, P2.normals().data(),
+                                             P2.offsets().data(), N2, scratch, P);
+        return interAreaP(P, n);
+    }
 
-    Vertexes interVert;
-    Vertexes innerVert12;
-    Vertexes innerVert21;
-    Vertexes allVerts;
+    const LineT<T> *E1 = P1.edges().data();
+    const LineT<T> *E2 = P2.edges().data();
+    typename Scratch::InterVert &allVerts = scratch.allVerts;
+    allVerts.clear();
     //---------------
-    findInterPoints(Q1, Q2, interVert);
-    findInnerPoints(Q1, Q2, innerVert12);
-    findInnerPoints(Q2, Q1, innerVert21);
+    {
+        IOU_STAT_STAGE(StageInterPoints);
+        Vec2<T> p;
+        for (int j=0; j<N2; ++j) {
+            for (int i=0; i<N1; ++i) {
+                if (E1[i].crossing(E2[j], &p))
+                    allVerts.push_back(p);
+            }
+        }
+    }
+    {
+        IOU_STAT_STAGE(StageInnerPoints);
+        for (int i=0; i<N2; ++i) {
+            if (P1.location(C2[i]) != OutSide)
+                allVerts.push_back(C2[i]);
+        }
+        for (int i=0; i<N1; ++i) {
+            if (P2.location(C1[i]) != OutSide)
+                allVerts.push_back(C1[i]);
+        }
+    }
     //---------------
-    // TODO : Check conditions
-    for (int i = 0; i < interVert.size(); ++i)
-        allVerts.push_back(interVert.at(i));
-    for (int i = 0; i < innerVert12.size(); ++i)
-        allVerts.push_back(innerVert12.at(i));
-    for (int i = 0; i < innerVert21.size(); ++i)
-        allVerts.push_back(innerVert21.at(i));
-
-    if (allVerts.empty())
-        return 0.0;
-    else {
-        assert(allVerts.size() >= 3);
-        beInSomeWiseEx(allVerts, ClockWise);
-        if (whichWiseEx(allVerts) == NoneWise)
-            return -1.0;
+    const int n = orderSoupP<T>(allVerts);
+    return interAreaP(allVerts.data(), n);
+}
+
+// Per-polygon data computed once by the batched paths.
+template <typename T>
+struct BatchPoly
+{
+    const Vec2<T> *C;
+    int N;
+    WiseType wise;
+    T area;
+    AABBT<T> box;
+};
+template <typename T>
+void prepareBatchPoly(const Vec2<T> *C, const int N, BatchPoly<T> &poly)
+{
+    poly.C = C;
+    poly.N = N;
+    poly.wise = whichWiseP(C, N);
+    poly.area = (poly.wise == NoneWise) ? T(-1) : sumTriangles(C, N);
+    poly.box = boundsP(C, N);
+}
+// Same value as iouEx(P1,P2) from the cached data, but -1 if either is
+// NoneWise, where iouEx divides the -1 intersection by their areas.
+template <typename T, class Scratch>
+T iouBatchPair(const BatchPoly<T> &P1, const BatchPoly<T> &P2,
+               const InterMethod method, Scratch &scratch)
+{
+    IOU_STAT_ADD(StatPairs, 1);
+    if (P1.wise == NoneWise || P2.wise == NoneWise) {
+        IOU_STAT_ADD(StatNoneWise, 1);
+        return T(-1);
+    }
+    T inter = 0;
+    if (!P1.box.overlaps(P2.box)) {
+        IOU_STAT_ADD(StatRejected, 1);
+        inter = T(0);
+    }
+    else
+        inter = areaInterP(P1.C, P1.N, P1.wise, P2.C, P2.N, P2.wise, method, scratch);
+    return inter/(P1.area + P2.area - inter);
+}
+
+template <typename T>
+void prepareBatch(const std::vector<QuadT<T> > &Q, std::vector<BatchPoly<T> > &P)
+{
+    P.resize(Q.size());
+    for (size_t i = 0; i < Q.size(); ++i)
+        prepareBatchPoly(Q[i].data(), 4, P[i]);
+}
+template <typename T>
+void prepareBatch(const std::vector<std::vector<Vec2<T> > > &C, std::vector<BatchPoly<T> > &P)
+{
+    P.resize(C.size());
+    for (size_t i = 0; i < C.size(); ++i)
+        prepareBatchPoly(C[i].data(), C[i].size(), P[i]);
+}
+// Fill rows [i0,i1) x columns [j0,j1) of the |PA|x|PB| matrix out.
+template <typename T, class Scratch>
+void fillIouTile(const std::vector<BatchPoly<T> > &PA, const std::vector<BatchPoly<T> > &PB,
+                 const int i0, const int i1, const int j0, const int j1,
+                 const InterMethod method, Scratch &scratch, T *out)
+{
+    const size_t NB = PB.size();
+    for (int i = i0; i < i1; ++i) {
+        T *row = out + i*NB;
+        for (int j = j0; j < j1; ++j)
+            row[j] = iouBatchPair(PA[i], PB[j], method, scratch);
+    }
+}
+// Tiles of TileSize x TileSize pairs keep both blocks of polygons in cache.
+// Their cost varies a lot with the number of overlapping pairs, so they
+// are balanced by the work stealing of the pool.
+const int TileSize = 64;
+template <typename T, class Scratch>
+void fillIouMatrixParallel(const std::vector<BatchPoly<T> > &PA, const std::vector<BatchPoly<T> > &PB,
+                           const InterMethod method, ThreadPool &pool,
+                           std::vector<Scratch> &scratch, T *out)
+{
+    const int NA = PA.size();
+    const int NB = PB.size();
+    const int tileRows = (NA + TileSize - 1) / TileSize;
+    const int tileCols = (NB + TileSize - 1) / TileSize;
+    pool.parallelFor(tileRows*tileCols, [&](int t, int worker) {
+        const int i0 = (t / tileCols) * TileSize;
+        const int j0 = (t % tileCols) * TileSize;
+        fillIouTile(PA, PB, i0, std::min(i0 + TileSize, NA),
+                    j0, std::min(j0 + TileSize, NB),
+                    method, scratch[worker], out);
+    });
+}
+
+// What iouBoundsP needs of a polygon: a circle inside it and one around it.
+template <typename T>
+struct BoundCircles
+{
+    T area;
+    AABBT<T> box;
+    Vec2<T> inCenter;
+    T inRadius;
+    Vec2<T> outCenter;
+    T outRadius;
+};
+// Circles of a polygon which is known not to be NoneWise, as those of
+// PreparedPolygon: inside around the mean of the vertexes, around it
+// from the center of its bounding box.
+template <typename T>
+BoundCircles<T> boundCirclesP(const Vec2<T> *C, const int N)
+{
+    BoundCircles<T> bc;
+    bc.area = sumTriangles(C, N);
+    bc.box = boundsP(C, N);
+    bc.inCenter = centroidP(C, N);
+    bc.outCenter = bc.box.center();
+    T in2 = -1;
+    T out2 = 0;
+    for (int i = 0; i < N; ++i) {
+        const Vec2<T> ab = C[(i+1)%N] - C[i];
+        const T len2 = ab.normSquared();
+        if (len2 > T(0)) {
+            const T c = ab^(bc.inCenter - C[i]);
+            if (in2 < T(0) || c*c < in2*len2)
+                in2 = c*c/len2;
+        }
+        out2 = std::max(out2, bc.outCenter.squareDistance(C[i]));
+    }
+    bc.inRadius = std::sqrt(std::max(in2, T(0)));
+    bc.outRadius = std::sqrt(out2);
+    return bc;
+}
+// Area of the intersection of two circles.
+template <typename T>
+T lensArea(const Vec2<T> &c1, const T r1, const Vec2<T> &c2, const T r2)
+{
+    const T d2 = c1.squareDistance(c2);
+    if (d2 >= (r1 + r2)*(r1 + r2))
+        return T(0);
+    const T rMin = std::min(r1, r2);
+    if (d2 <= (r1 - r2)*(r1 - r2))
+        return T(3.14159265358979323846)*rMin*rMin;
+    const T d = std::sqrt(d2);
+    const T a1 = std::min(T(1), std::max(T(-1), (d2 + r1*r1 - r2*r2)/(T(2)*d*r1)));
+    const T a2 = std::min(T(1), std::max(T(-1), (d2 + r2*r2 - r1*r1)/(T(2)*d*r2)));
+    const T k = (-d + r1 + r2)*(d + r1 - r2)*(d - r1 + r2)*(d + r1 + r2);
+    return r1*r1*std::acos(a1) + r2*r2*std::acos(a2) - T(0.5)*std::sqrt(std::max(k, T(0)));
+}
+// iou for an intersection of area inter.
+template <typename T>
+inline T iouOf(const T inter, const T area1, const T area2)
+{
+    const T uni = area1 + area2 - inter;
+    return uni > T(0) ? inter/uni : T(0);
+}
+template <typename T>
+IouBoundsT<T> iouBoundsP(const BoundCircles<T> &P1, const BoundCircles<T> &P2)
+{
+    IouBoundsT<T> bounds;
+    const T w = std::min(P1.box.xMax, P2.box.xMax) - std::max(P1.box.xMin, P2.box.xMin);
+    const T h = std::min(P1.box.yMax, P2.box.yMax) - std::max(P1.box.yMin, P2.box.yMin);
+    if (w < T(0) || h < T(0)) {
+        bounds.lower = bounds.upper = T(0);
+        return bounds;
+    }
+    const T lower = lensArea(P1.inCenter, P1.inRadius, P2.inCenter, P2.inRadius);
+    T upper = std::min(std::min(P1.area, P2.area), w*h);
+    upper = std::min(upper, lensArea(P1.outCenter, P1.outRadius, P2.outCenter, P2.outRadius));
+    // Widened by the tolerance, for the rounding of the iou computed in T:
+    // a nested pair has the upper bound for iou.
+    const T zero = Tolerance<T>::zero();
+    bounds.lower = std::max(T(0), iouOf(lower, P1.area, P2.area) - zero);
+    bounds.upper = std::max(bounds.lower, iouOf(upper, P1.area, P2.area)) + zero;
+    return bounds;
+}
+template <typename T>
+inline IouBoundsT<T> invalidBounds()
+{
+    IouBoundsT<T> bounds;
+    bounds.lower = bounds.upper = T(-1);
+    return bounds;
+}
+// Whether bounds decide iou > t on their own, the answer in above.
+template <typename T>
+inline bool boundsDecide(const IouBoundsT<T> &bounds, const T t, bool &above)
+{
+    if (bounds.lower > t) {
+        above = true;
+        return true;
+    }
+    if (bounds.upper <= t) {
+        above = false;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+template <typename T>
+void QuadT<T>::getVertList(Vertexes &_vert) const
+{
+    Vertexes vertTemp(data(), data() + 4);
+    _vert.swap(vertTemp);
+}
+template <typename T>
+AABBT<T> QuadT<T>::boundingBox() const
+{
+    return boundsP(data(), 4);
+}
+template <typename T>
+bool QuadT<T>::haveRepeatVert() const
+{
+    bool bRep = (
+        p1() == p2() || p1() == p3() || p1() == p4() ||
+        p2() == p3() || p2() == p4() ||
+        p3() == p4()
+        );
+    return bRep;
+}
+
+template <typename T>
+T QuadT<T>::area() const
+{
+    return areaP(data(), 4);
+}
+
+template <typename T>
+WiseType QuadT<T>::whichWise() const
+{
+    return whichWiseP(data(), 4);
+}
+template <typename T>
+void QuadT<T>::beInSomeWise(const WiseType wiseType, const OrderMethod order)
+{
+    if (order == ThetaOrder) {
+        typename AngPoint<T>::type APList[4];
+        beInSomeWiseThetaP(data(), 4, wiseType, APList);
+    }
+    else
+        beInSomeWiseP(data(), 4, wiseType);
+}
+
+template <typename T>
+LocPosition QuadT<T>::location(const Point &p) const
+{
+    return locationP(data(), 4, p);
+}
+template <typename T>
+int QuadT<T>::interPts(const LineT<T> &line, Vertexes &pts) const
+{
+    Vertexes vertTemp;
+    appendInterPts(data(), 4, line, vertTemp);
+    pts.swap(vertTemp);
+    return InSide;
+}
+
+template <typename T>
+AABBT<T> boundingBoxEx(const std::vector<Vec2<T> > &C)
+{
+    return boundingBoxEx(PolygonViewT<T>(C));
+}
+template <typename T>
+T areaEx(const std::vector<Vec2<T> > &C)
+{
+    return areaEx(PolygonViewT<T>(C));
+}
+template <typename T>
+WiseType whichWiseEx(const std::vector<Vec2<T> > &C)
+{
+    return whichWiseEx(PolygonViewT<T>(C));
+}
+template <typename T>
+void beInSomeWiseEx(std::vector<Vec2<T> > &C, const WiseType wiseType,
+                    const OrderMethod order)
+{
+    if (wiseType != NoneWise && C.size() > 2) {
+        if (order == ThetaOrder) {
+            std::vector<typename AngPoint<T>::type> APList(C.size());
+            beInSomeWiseThetaP(C.data(), C.size(), wiseType, APList.data());
+        }
         else
-            return areaEx(allVerts);
+            beInSomeWiseP(C.data(), C.size(), wiseType);
+    }
+}
+
+template <typename T>
+int convexHullEx(std::vector<Vec2<T> > &C)
+{
+    Vec2<T> *P = C.data();
+    const int M = uniqueSortedP(P, (int)C.size());
+    if (M < 3) {
+        C.clear();
+        return 0;
+    }
+
+    // Order P as the two chains of Andrew's monotone chain: the points on
+    // the right of P[0]->P[M-1] by increasing x, P[M-1], then the others by
+    // decreasing x. The scan then keeps its stack in the front of P.
+    Vec2<T> *mid = std::partition(P + 1, P + M - 1, BelowLine<T>(P[0], P[M-1]));
+    std::sort(P + 1, mid, LexLess<T>());
+    std::rotate(mid, P + M - 1, P + M);
+    std::sort(mid + 1, P + M, LexGreater<T>());
+    const int lastIndex = mid - P;
+
+    int h = 0;
+    int lower = 2;
+    for (int i = 0; i < M; ++i) {
+        while (h >= lower && orient2d(P[h-2], P[h-1], P[i]) <= 0.0)
+            --h;
+        P[h++] = P[i];
+        if (i == lastIndex)
+            lower = h + 1;
+    }
+    while (h >= lower && orient2d(P[h-2], P[h-1], P[0]) <= 0.0)
+        --h;
+    if (h < 3) {
+        C.clear();
+        return 0;
+    }
+    // The scan is anticlockwise.
+    std::reverse(P, P + h);
+    C.resize(h);
+    return h;
+}
+template <typename T>
+int simplifyEx(std::vector<Vec2<T> > &C, const T tolerance)
+{
+    const int N = C.size();
+    if (N <= 3)
+        return N;
+
+    // Split the outline at vertex 0 and the vertex farthest from it, and
+    // reduce both chains.
+    int far = 1;
+    for (int i = 2; i < N; ++i) {
+        if (C[i].squareDistance(C[0]) > C[far].squareDistance(C[0]))
+            far = i;
+    }
+    std::vector<char> keep(N, 0);
+    keep[0] = keep[far] = 1;
+    simplifyP(C.data(), N, far, tolerance*tolerance, keep);
+
+    // Flat within tolerance: keep the vertex farthest from the chord too.
+    if (std::count(keep.begin(), keep.end(), 1) < 3) {
+        int third = far == 1 ? 2 : 1;
+        for (int i = 1; i < N; ++i) {
+            if (i != far && segmentSquareDistance(C[i], C[0], C[far]) >
+                            segmentSquareDistance(C[third], C[0], C[far]))
+                third = i;
+        }
+        keep[third] = 1;
+    }
+
+    int M = 0;
+    for (int i = 0; i < N; ++i) {
+        if (keep[i])
+            C[M++] = C[i];
+    }
+    C.resize(M);
+    return M;
+}
+
+template <typename T>
+LocPosition locationEx(const std::vector<Vec2<T> > &C, const Vec2<T> &p)
+{
+    return locationEx(PolygonViewT<T>(C), p);
+}
+template <typename T>
+int interPtsEx(const std::vector<Vec2<T> > &C, const LineT<T> &line,
+               std::vector<Vec2<T> > &pts)
+{
+    return interPtsEx(PolygonViewT<T>(C), line, pts);
+}
+
+template <typename T>
+int findInterPointsEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                      std::vector<Vec2<T> > &vert)
+{
+    return findInterPointsEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), vert);
+}
+template <typename T>
+int findInnerPointsEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                      std::vector<Vec2<T> > &vert)
+{
+    return findInnerPointsEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), vert);
+}
+template <typename T>
+int clipConvexEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                 std::vector<Vec2<T> > &vert)
+{
+    return clipConvexEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), vert);
+}
+template <typename T>
+T areaIntersectionEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                     const InterMethod method)
+{
+    return areaIntersectionEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), method);
+}
+template <typename T>
+int intersectionPolygonEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                          std::vector<Vec2<T> > &out, const InterMethod method)
+{
+    return intersectionPolygonEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), out, method);
+}
+template <typename T>
+T areaUnionEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+              const InterMethod method)
+{
+    return areaUnionEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), method);
+}
+template <typename T>
+T iouEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+        const InterMethod method)
+{
+    return iouEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), method);
+}
+
+template <typename T>
+AABBT<T> boundingBoxEx(const PolygonViewT<T> &C)
+{
+    return boundsP(C.data(), C.size());
+}
+template <typename T>
+T areaEx(const PolygonViewT<T> &C)
+{
+    return areaP(C.data(), C.size());
+}
+template <typename T>
+WiseType whichWiseEx(const PolygonViewT<T> &C)
+{
+    return whichWiseP(C.data(), C.size());
+}
+template <typename T>
+LocPosition locationEx(const PolygonViewT<T> &C, const Vec2<T> &p)
+{
+    return locationP(C.data(), C.size(), p);
+}
+template <typename T>
+int interPtsEx(const PolygonViewT<T> &C, const LineT<T> &line,
+               std::vector<Vec2<T> > &pts)
+{
+    std::vector<Vec2<T> > vertTemp;
+    appendInterPts(C.data(), C.size(), line, vertTemp);
+    pts.swap(vertTemp);
+
+    return InSide;
+}
+template <typename T>
+int findInterPointsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                      std::vector<Vec2<T> > &vert)
+{
+    std::vector<Vec2<T> > _vert;
+    appendInterPoints(C1.data(), C1.size(), C2.data(), C2.size(), _vert);
+    vert.swap(_vert);
+    return vert.size();
+}
+template <typename T>
+int findInnerPointsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                      std::vector<Vec2<T> > &vert)
+{
+    std::vector<Vec2<T> > _vert;
+    const int N1 = C1.size();
+    const WiseType wise1 = (N1 >= WedgeMinSize) ? whichWiseEx(C1) : NoneWise;
+    if (wise1 != NoneWise) {
+        const Vec2<T> pO = centroidP(C1.data(), N1);
+        const T dO = boundaryDistanceP(C1.data(), N1, pO);
+        for (int i = 0; i < C2.size(); ++i) {
+            LocPosition loc;
+            if (!locationWedgeP(C1.data(), N1, wise1, pO, dO, C2[i], loc))
+                loc = locationP(C1.data(), N1, C2[i]);
+            if (loc != OutSide)
+                _vert.push_back(C2[i]);
+        }
+    }
+    else
+        appendInnerPoints(C1.data(), N1, C2.data(), C2.size(), _vert);
+    vert.swap(_vert);
+    return vert.size();
+}
+template <typename T>
+int clipConvexEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                 std::vector<Vec2<T> > &vert)
+{
+    std::vector<Vec2<T> > _vert;
+    const WiseType wise2 = whichWiseEx(C2);
+    if (wise2 != NoneWise && whichWiseEx(C1) != NoneWise) {
+        std::vector<Vec2<T> > buf1, buf2;
+        buf1.reserve(C1.size() + C2.size());
+        buf2.reserve(C1.size() + C2.size());
+        _vert.swap(clipConvexP(C1.data(), C1.size(), C2.data(), C2.size(),
+                               wise2, buf1, buf2));
+    }
+    vert.swap(_vert);
+    return vert.size();
+}
+template <typename T>
+T areaIntersectionEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                     const InterMethod method)
+{
+    const WiseType wise1 = whichWiseEx(C1);
+    const WiseType wise2 = whichWiseEx(C2);
+    IOU_STAT_ADD(StatPairs, 1);
+    if (wise1 == NoneWise ||
+        wise2 == NoneWise ) {
+        IOU_STAT_ADD(StatNoneWise, 1);
+        return T(-1);
     }
-    return -1.0;
+    if (!boundingBoxEx(C1).overlaps(boundingBoxEx(C2))) {
+        IOU_STAT_ADD(StatRejected, 1);
+        return T(0);
+    }
+
+    // Small polygons are intersected on the stack.
+    if (C1.size() <= PreparedFixedSize && C2.size() <= PreparedFixedSize) {
+        FixedInterScratch<T, PreparedFixedSize> scratch;
+        return areaInterP(C1.data(), C1.size(), wise1, C2.data(), C2.size(), wise2,
+                          method, scratch);
+    }
+    InterScratch<T> scratch;
+    return areaInterP(C1.data(), C1.size(), wise1, C2.data(), C2.size(), wise2,
+                      method, scratch);
+}
+template <typename T>
+int intersectionPolygonEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                          std::vector<Vec2<T> > &out, const InterMethod method)
+{
+    const WiseType wise1 = whichWiseEx(C1);
+    const WiseType wise2 = whichWiseEx(C2);
+    if (wise1 == NoneWise ||
+        wise2 == NoneWise ) {
+        out.clear();
+        return -1;
+    }
+    if (!boundingBoxEx(C1).overlaps(boundingBoxEx(C2))) {
+        out.clear();
+        return 0;
+    }
+
+    const Vec2<T> *P = 0;
+    if (C1.size() <= PreparedFixedSize && C2.size() <= PreparedFixedSize) {
+        FixedInterScratch<T, PreparedFixedSize> scratch;
+        const int n = interPolygonP(C1.data(), C1.size(), wise1,
+                                    C2.data(), C2.size(), wise2, method, scratch, P);
+        return outputPolygonP(P, n, wise1, out);
+    }
+    InterScratch<T> scratch;
+    const int n = interPolygonP(C1.data(), C1.size(), wise1,
+                                C2.data(), C2.size(), wise2, method, scratch, P);
+    return outputPolygonP(P, n, wise1, out);
+}
+template <typename T>
+T areaUnionEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+              const InterMethod method)
+{
+    return areaEx(C1) + areaEx(C2) - areaIntersectionEx(C1, C2, method);
+}
+template <typename T>
+T iouEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+        const InterMethod method)
+{
+    // Same as areaIntersectionEx/areaUnionEx, without running the
+    // intersection twice.
+    const T inter = areaIntersectionEx(C1, C2, method);
+    return inter/(areaEx(C1) + areaEx(C2) - inter);
+}
+
+template <typename T>
+AABBT<T> boundingBoxEx(const StridedPolygonViewT<T> &C)
+{
+    return boundingBoxEx(GatheredPolygon<T>(C).view());
+}
+template <typename T>
+T areaEx(const StridedPolygonViewT<T> &C)
+{
+    return areaEx(GatheredPolygon<T>(C).view());
+}
+template <typename T>
+WiseType whichWiseEx(const StridedPolygonViewT<T> &C)
+{
+    return whichWiseEx(GatheredPolygon<T>(C).view());
+}
+template <typename T>
+LocPosition locationEx(const StridedPolygonViewT<T> &C, const Vec2<T> &p)
+{
+    return locationEx(GatheredPolygon<T>(C).view(), p);
+}
+template <typename T>
+T areaIntersectionEx(const StridedPolygonViewT<T> &C1, const StridedPolygonViewT<T> &C2,
+                     const InterMethod method)
+{
+    return areaIntersectionEx(GatheredPolygon<T>(C1).view(),
+                              GatheredPolygon<T>(C2).view(), method);
+}
+template <typename T>
+T areaUnionEx(const StridedPolygonViewT<T> &C1, const StridedPolygonViewT<T> &C2,
+              const InterMethod method)
+{
+    return areaUnionEx(GatheredPolygon<T>(C1).view(),
+                       GatheredPolygon<T>(C2).view(), method);
+}
+template <typename T>
+T iouEx(const StridedPolygonViewT<T> &C1, const StridedPolygonViewT<T> &C2,
+        const InterMethod method)
+{
+    return iouEx(GatheredPolygon<T>(C1).view(),
+                 GatheredPolygon<T>(C2).view(), method);
+}
+
+template <typename T>
+int findInterPoints(const QuadT<T> &Q1, const QuadT<T> &Q2, std::vector<Vec2<T> > &vert)
+{
+    std::vector<Vec2<T> > _vert;
+    appendInterPoints(Q1.data(), 4, Q2.data(), 4, _vert);
+    vert.swap(_vert);
+    return vert.size();
+}
+template <typename T>
+int findInnerPoints(const QuadT<T> &Q1, const QuadT<T> &Q2, std::vector<Vec2<T> > &vert)
+{
+    std::vector<Vec2<T> > _vert;
+    appendInnerPoints(Q1.data(), 4, Q2.data(), 4, _vert);
+    vert.swap(_vert);
+    return vert.size();
+}
+template <typename T>
+T areaIntersection(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                   const InterMethod method)
+{
+    const WiseType wise1 = Q1.whichWise();
+    const WiseType wise2 = Q2.whichWise();
+    IOU_STAT_ADD(StatPairs, 1);
+    if (wise1 == NoneWise ||
+        wise2 == NoneWise ) {
+        IOU_STAT_ADD(StatNoneWise, 1);
+        return T(-1);
+    }
+    if (!Q1.boundingBox().overlaps(Q2.boundingBox())) {
+        IOU_STAT_ADD(StatRejected, 1);
+        return T(0);
+    }
+
+    QuadInterScratch<T> scratch;
+    return areaInterP(Q1.data(), 4, wise1, Q2.data(), 4, wise2, method, scratch);
+}
+template <typename T>
+int intersectionPolygon(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                        std::vector<Vec2<T> > &out, const InterMethod method)
+{
+    const WiseType wise1 = Q1.whichWise();
+    const WiseType wise2 = Q2.whichWise();
+    if (wise1 == NoneWise ||
+        wise2 == NoneWise ) {
+        out.clear();
+        return -1;
+    }
+    if (!Q1.boundingBox().overlaps(Q2.boundingBox())) {
+        out.clear();
+        return 0;
+    }
+
+    QuadInterScratch<T> scratch;
+    const Vec2<T> *P = 0;
+    const int n = interPolygonP(Q1.data(), 4, wise1, Q2.data(), 4, wise2, method, scratch, P);
+    return outputPolygonP(P, n, wise1, out);
+}
+template <typename T>
+T areaUnion(const QuadT<T> &Q1, const QuadT<T> &Q2, const InterMethod method){
+    return Q1.area()+Q2.area()-areaIntersection(Q1,Q2,method);
+}
+template <typename T>
+T iou(const QuadT<T> &Q1, const QuadT<T> &Q2, const InterMethod method)
+{
+    // Same as areaIntersection(Q1,Q2)/areaUnion(Q1,Q2), without running
+    // the intersection twice.
+    const T inter = areaIntersection(Q1,Q2,method);
+    return inter/(Q1.area()+Q2.area()-inter);
+}
+
+template <typename T>
+PreparedPolygonT<T>::PreparedPolygonT()
+    : wise(NoneWise), areaV(-1), radius(0), inRadius(0), centroidDist(0)
+{
+}
+template <typename T>
+PreparedPolygonT<T>::PreparedPolygonT(const Vertexes &C)
+    : vert(C)
+{
+    prepare();
+}
+template <typename T>
+PreparedPolygonT<T>::PreparedPolygonT(const QuadT<T> &Q)
+    : vert(Q.data(), Q.data() + 4)
+{
+    prepare();
+}
+template <typename T>
+void PreparedPolygonT<T>::prepare()
+{
+    const int N = vert.size();
+    wise = whichWiseP(vert.data(), N);
+    areaV = (wise == NoneWise) ? T(-1) : sumTriangles(vert.data(), N);
+    box = boundsP(vert.data(), N);
+    center = box.center();
+    T r2 = 0;
+    for (int i = 0; i < N; ++i)
+        r2 = std::max(r2, center.squareDistance(vert[i]));
+    radius = std::sqrt(r2);
+
+    centroidV = Point(0,0);
+    for (int i = 0; i < N; ++i)
+        centroidV += vert[i];
+    if (N > 0)
+        centroidV /= T(N);
+
+    // Outward normals: the inside is on the right of the edges of a
+    // ClockWise polygon and on their left otherwise.
+    const T side = (wise == ClockWise) ? T(-1) : T(1);
+    edgesV.resize(N);
+    normalsV.resize(N);
+    offsetsV.resize(N);
+    for (int i = 0; i < N; ++i) {
+        const Point &a = vert[i];
+        const Point &b = vert[(i+1)%N];
+        const Point ab = b - a;
+        edgesV[i] = Line(a, b);
+        normalsV[i] = Point(ab.y, -ab.x) * side;
+        offsetsV[i] = normalsV[i] * a;
+    }
+    inRadius = (wise == NoneWise) ? T(0) : boundCirclesP(vert.data(), N).inRadius;
+    centroidDist = (wise == NoneWise) ? T(0) : boundaryDistanceP(vert.data(), N, centroidV);
+}
+template <typename T>
+LocPosition PreparedPolygonT<T>::location(const Point &p) const
+{
+    const int N = vert.size();
+    if (wise == NoneWise)
+        return locationP(vert.data(), N, p);
+    LocPosition loc;
+    if (N >= WedgeMinSize && locationWedgeP(vert.data(), N, wise, centroidV, centroidDist, p, loc))
+        return loc;
+    return locationEdgesP(edgesV.data(), N, centroidV, p);
+}
+template <typename T>
+T areaIntersection(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+                   const InterMethod method)
+{
+    IOU_STAT_ADD(StatPairs, 1);
+    if (!P1.isValid() || !P2.isValid()) {
+        IOU_STAT_ADD(StatNoneWise, 1);
+        return T(-1);
+    }
+    if (!P1.mayOverlap(P2)) {
+        IOU_STAT_ADD(StatRejected, 1);
+        return T(0);
+    }
+
+    if (P1.size() <= PreparedFixedSize && P2.size() <= PreparedFixedSize) {
+        FixedInterScratch<T, PreparedFixedSize> scratch;
+        return areaInterPreparedP(P1, P2, method, scratch);
+    }
+    InterScratch<T> scratch;
+    return areaInterPreparedP(P1, P2, method, scratch);
+}
+template <typename T>
+T areaUnion(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+            const InterMethod method)
+{
+    return P1.area() + P2.area() - areaIntersection(P1, P2, method);
+}
+template <typename T>
+T iou(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+      const InterMethod method)
+{
+    const T inter = areaIntersection(P1, P2, method);
+    return inter/(P1.area() + P2.area() - inter);
 }
-double areaUnion(const Quad &Q1, const Quad &Q2){
-    return Q1.area()+Q2.area()-areaIntersection(Q1,Q2);
+
+template <typename T>
+IouMetricsT<T> iouMetricsEx(const std::vector<Vec2<T> > &C1,
+                            const std::vector<Vec2<T> > &C2,
+                            const unsigned int metrics, const InterMethod method)
+{
+    return iouMetricsEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), metrics, method);
 }
-double iou(const Quad &Q1, const Quad &Q2)
+template <typename T>
+IouMetricsT<T> iouMetricsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                            const unsigned int metrics, const InterMethod method)
 {
-    return areaIntersection(Q1,Q2)/areaUnion(Q1,Q2);
+    const WiseType wise1 = whichWiseEx(C1);
+    const WiseType wise2 = whichWiseEx(C2);
+    if (wise1 == NoneWise ||
+        wise2 == NoneWise ) {
+        IOU_STAT_ADD(StatPairs, 1);
+        IOU_STAT_ADD(StatNoneWise, 1);
+        return invalidMetrics<T>();
+    }
+
+    const T area1 = sumTriangles(C1.data(), C1.size());
+    const T area2 = sumTriangles(C2.data(), C2.size());
+    const AABBT<T> box1 = boundingBoxEx(C1);
+    const AABBT<T> box2 = boundingBoxEx(C2);
+    if (C1.size() <= PreparedFixedSize && C2.size() <= PreparedFixedSize) {
+        FixedInterScratch<T, PreparedFixedSize> scratch;
+        return metricsP(C1.data(), C1.size(), wise1, area1, box1,
+                        C2.data(), C2.size(), wise2, area2, box2,
+                        metrics, method, scratch);
+    }
+    InterScratch<T> scratch;
+    return metricsP(C1.data(), C1.size(), wise1, area1, box1,
+                    C2.data(), C2.size(), wise2, area2, box2,
+                    metrics, method, scratch);
 }
+template <typename T>
+IouMetricsT<T> iouMetrics(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                          const unsigned int metrics, const InterMethod method)
+{
+    const WiseType wise1 = Q1.whichWise();
+    const WiseType wise2 = Q2.whichWise();
+    if (wise1 == NoneWise ||
+        wise2 == NoneWise ) {
+        IOU_STAT_ADD(StatPairs, 1);
+        IOU_STAT_ADD(StatNoneWise, 1);
+        return invalidMetrics<T>();
+    }
+
+    QuadInterScratch<T> scratch;
+    return metricsP(Q1.data(), 4, wise1, Q1.area(), Q1.boundingBox(),
+                    Q2.data(), 4, wise2, Q2.area(), Q2.boundingBox(),
+                    metrics, method, scratch);
+}
+
+template <typename T>
+IouBoundsT<T> iouBoundsEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2)
+{
+    return iouBoundsEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2));
+}
+template <typename T>
+IouBoundsT<T> iouBoundsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2)
+{
+    if (whichWiseEx(C1) == NoneWise || whichWiseEx(C2) == NoneWise)
+        return invalidBounds<T>();
+    return iouBoundsP(boundCirclesP(C1.data(), C1.size()),
+                      boundCirclesP(C2.data(), C2.size()));
+}
+template <typename T>
+IouBoundsT<T> iouBounds(const QuadT<T> &Q1, const QuadT<T> &Q2)
+{
+    if (Q1.whichWise() == NoneWise || Q2.whichWise() == NoneWise)
+        return invalidBounds<T>();
+    return iouBoundsP(boundCirclesP(Q1.data(), 4), boundCirclesP(Q2.data(), 4));
+}
+template <typename T>
+IouBoundsT<T> iouBounds(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2)
+{
+    if (!P1.isValid() || !P2.isValid())
+        return invalidBounds<T>();
+    const PreparedPolygonT<T> *P[2] = { &P1, &P2 };
+    BoundCircles<T> bc[2];
+    for (int k = 0; k < 2; ++k) {
+        bc[k].area = P[k]->area();
+        bc[k].box = P[k]->boundingBox();
+        bc[k].inCenter = P[k]->centroid();
+        bc[k].inRadius = P[k]->inscribedRadius();
+        bc[k].outCenter = P[k]->circleCenter();
+        bc[k].outRadius = P[k]->circleRadius();
+    }
+    return iouBoundsP(bc[0], bc[1]);
+}
+
+template <typename T>
+bool iouAboveEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                const T t, const InterMethod method)
+{
+    return iouAboveEx(PolygonViewT<T>(C1), PolygonViewT<T>(C2), t, method);
+}
+template <typename T>
+bool iouAboveEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                const T t, const InterMethod method)
+{
+    const IouBoundsT<T> bounds = iouBoundsEx(C1, C2);
+    bool above = false;
+    if (bounds.upper < T(0) || boundsDecide(bounds, t, above))
+        return above;
+    return iouEx(C1, C2, method) > t;
+}
+template <typename T>
+bool iouAbove(const QuadT<T> &Q1, const QuadT<T> &Q2, const T t, const InterMethod method)
+{
+    const IouBoundsT<T> bounds = iouBounds(Q1, Q2);
+    bool above = false;
+    if (bounds.upper < T(0) || boundsDecide(bounds, t, above))
+        return above;
+    return iou(Q1, Q2, method) > t;
+}
+template <typename T>
+bool iouAbove(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+              const T t, const InterMethod method)
+{
+    const IouBoundsT<T> bounds = iouBounds(P1, P2);
+    bool above = false;
+    if (bounds.upper < T(0) || boundsDecide(bounds, t, above))
+        return above;
+    return iou(P1, P2, method) > t;
+}
+
+template <typename T>
+void iouMatrix(const std::vector<QuadT<T> > &A, const std::vector<QuadT<T> > &B,
+               T *out, const InterMethod method)
+{
+    std::vector<BatchPoly<T> > PA, PB;
+    prepareBatch(A, PA);
+    prepareBatch(B, PB);
+    QuadInterScratch<T> scratch;
+    fillIouTile(PA, PB, 0, PA.size(), 0, PB.size(), method, scratch, out);
+}
+template <typename T>
+void iouMatrixEx(const std::vector<std::vector<Vec2<T> > > &A,
+                 const std::vector<std::vector<Vec2<T> > > &B,
+                 T *out, const InterMethod method)
+{
+    std::vector<BatchPoly<T> > PA, PB;
+    prepareBatch(A, PA);
+    prepareBatch(B, PB);
+    InterScratch<T> scratch;
+    fillIouTile(PA, PB, 0, PA.size(), 0, PB.size(), method, scratch, out);
+}
+template <typename T>
+void iouMatrixParallel(const std::vector<QuadT<T> > &A, const std::vector<QuadT<T> > &B,
+                       T *out, ThreadPool &pool, const InterMethod method)
+{
+    std::vector<BatchPoly<T> > PA, PB;
+    prepareBatch(A, PA);
+    prepareBatch(B, PB);
+    std::vector<QuadInterScratch<T> > scratch(pool.size());
+    fillIouMatrixParallel(PA, PB, method, pool, scratch, out);
+}
+template <typename T>
+void iouMatrixParallelEx(const std::vector<std::vector<Vec2<T> > > &A,
+                         const std::vector<std::vector<Vec2<T> > > &B,
+                         T *out, ThreadPool &pool, const InterMethod method)
+{
+    std::vector<BatchPoly<T> > PA, PB;
+    prepareBatch(A, PA);
+    prepareBatch(B, PB);
+    std::vector<InterScratch<T> > scratch(pool.size());
+    fillIouMatrixParallel(PA, PB, method, pool, scratch, out);
+}
+template <typename T>
+void iouMatrixParallel(const std::vector<QuadT<T> > &A, const std::vector<QuadT<T> > &B,
+                       T *out, const int nThreads, const InterMethod method)
+{
+    ThreadPool pool(nThreads);
+    iouMatrixParallel(A, B, out, pool, method);
+}
+template <typename T>
+void iouMatrixParallelEx(const std::vector<std::vector<Vec2<T> > > &A,
+                         const std::vector<std::vector<Vec2<T> > > &B,
+                         T *out, const int nThreads, const InterMethod method)
+{
+    ThreadPool pool(nThreads);
+    iouMatrixParallelEx(A, B, out, pool, method);
+}
+
+// Instantiations for float and double, the only scalar types supported.
+#define IOU_INSTANTIATE(T)                                                              \
+    template class LineT<T>;                                                            \
+    template class QuadT<T>;                                                            \
+    template class PreparedPolygonT<T>;                                                 \
+    template AABBT<T> boundingBoxEx(const std::vector<Vec2<T> > &);                     \
+    template T areaEx(const std::vector<Vec2<T> > &);                                   \
+    template WiseType whichWiseEx(const std::vector<Vec2<T> > &);                       \
+    template void beInSomeWiseEx(std::vector<Vec2<T> > &, const WiseType,               \
+                                 const OrderMethod);                                    \
+    template int convexHullEx(std::vector<Vec2<T> > &);                                 \
+    template int simplifyEx(std::vector<Vec2<T> > &, const T);                          \
+    template LocPosition locationEx(const std::vector<Vec2<T> > &, const Vec2<T> &);    \
+    template int interPtsEx(const std::vector<Vec2<T> > &, const LineT<T> &,            \
+                            std::vector<Vec2<T> > &);                                   \
+    template int findInterPointsEx(const std::vector<Vec2<T> > &,                       \
+                                   const std::vector<Vec2<T> > &,                       \
+                                   std::vector<Vec2<T> > &);                            \
+    template int findInnerPointsEx(const std::vector<Vec2<T> > &,                       \
+                                   const std::vector<Vec2<T> > &,                       \
+                                   std::vector<Vec2<T> > &);                            \
+    template int clipConvexEx(const std::vector<Vec2<T> > &,                            \
+                              const std::vector<Vec2<T> > &,                            \
+                              std::vector<Vec2<T> > &);                                 \
+    template T areaIntersectionEx(const std::vector<Vec2<T> > &,                        \
+                                  const std::vector<Vec2<T> > &, const InterMethod);    \
+    template int intersectionPolygonEx(const std::vector<Vec2<T> > &,                   \
+                                       const std::vector<Vec2<T> > &,                   \
+                                       std::vector<Vec2<T> > &, const InterMethod);     \
+    template T areaUnionEx(const std::vector<Vec2<T> > &,                               \
+                           const std::vector<Vec2<T> > &, const InterMethod);           \
+    template T iouEx(const std::vector<Vec2<T> > &,                                     \
+                     const std::vector<Vec2<T> > &, const InterMethod);                 \
+    template AABBT<T> boundingBoxEx(const PolygonViewT<T> &);                           \
+    template T areaEx(const PolygonViewT<T> &);                                         \
+    template WiseType whichWiseEx(const PolygonViewT<T> &);                             \
+    template LocPosition locationEx(const PolygonViewT<T> &, const Vec2<T> &);          \
+    template T areaIntersectionEx(const PolygonViewT<T> &, const PolygonViewT<T> &,     \
+                                  const InterMethod);                                   \
+    template int intersectionPolygonEx(const PolygonViewT<T> &, const PolygonViewT<T> &, \
+                                       std::vector<Vec2<T> > &, const InterMethod);     \
+    template T areaUnionEx(const PolygonViewT<T> &, const PolygonViewT<T> &,            \
+                           const InterMethod);                                          \
+    template T iouEx(const PolygonViewT<T> &, const PolygonViewT<T> &,                  \
+                     const InterMethod);                                                \
+    template int interPtsEx(const PolygonViewT<T> &, const LineT<T> &,                  \
+                            std::vector<Vec2<T> > &);                                   \
+    template int findInterPointsEx(const PolygonViewT<T> &, const PolygonViewT<T> &,    \
+                                   std::vector<Vec2<T> > &);                            \
+    template int findInnerPointsEx(const PolygonViewT<T> &, const PolygonViewT<T> &,    \
+                                   std::vector<Vec2<T> > &);                            \
+    template int clipConvexEx(const PolygonViewT<T> &, const PolygonViewT<T> &,         \
+                              std::vector<Vec2<T> > &);                                 \
+    template AABBT<T> boundingBoxEx(const StridedPolygonViewT<T> &);                    \
+    template T areaEx(const StridedPolygonViewT<T> &);                                  \
+    template WiseType whichWiseEx(const StridedPolygonViewT<T> &);                      \
+    template LocPosition locationEx(const StridedPolygonViewT<T> &, const Vec2<T> &);   \
+    template T areaIntersectionEx(const StridedPolygonViewT<T> &,                       \
+                                  const StridedPolygonViewT<T> &, const InterMethod);   \
+    template T areaUnionEx(const StridedPolygonViewT<T> &,                              \
+                           const StridedPolygonViewT<T> &, const InterMethod);          \
+    template T iouEx(const StridedPolygonViewT<T> &,                                    \
+                     const StridedPolygonViewT<T> &, const InterMethod);                \
+    template int findInterPoints(const QuadT<T> &, const QuadT<T> &,                    \
+                                 std::vector<Vec2<T> > &);                              \
+    template int findInnerPoints(const QuadT<T> &, const QuadT<T> &,                    \
+                                 std::vector<Vec2<T> > &);                              \
+    template T areaIntersection(const QuadT<T> &, const QuadT<T> &, const InterMethod); \
+    template int intersectionPolygon(const QuadT<T> &, const QuadT<T> &,                \
+                                     std::vector<Vec2<T> > &, const InterMethod);       \
+    template T areaUnion(const QuadT<T> &, const QuadT<T> &, const InterMethod);        \
+    template T iou(const QuadT<T> &, const QuadT<T> &, const InterMethod);              \
+    template T areaIntersection(const PreparedPolygonT<T> &, const PreparedPolygonT<T> &, \
+                                const InterMethod);                                     \
+    template T areaUnion(const PreparedPolygonT<T> &, const PreparedPolygonT<T> &,      \
+                         const InterMethod);                                            \
+    template T iou(const PreparedPolygonT<T> &, const PreparedPolygonT<T> &,            \
+                   const InterMethod);                                                  \
+    template IouMetricsT<T> iouMetricsEx(const std::vector<Vec2<T> > &,                 \
+                                         const std::vector<Vec2<T> > &,                 \
+                                         const unsigned int, const InterMethod);        \
+    template IouMetricsT<T> iouMetricsEx(const PolygonViewT<T> &, const PolygonViewT<T> &, \
+                                         const unsigned int, const InterMethod);        \
+    template IouMetricsT<T> iouMetrics(const QuadT<T> &, const QuadT<T> &,              \
+                                       const unsigned int, const InterMethod);          \
+    template IouBoundsT<T> iouBoundsEx(const std::vector<Vec2<T> > &,                   \
+                                       const std::vector<Vec2<T> > &);                  \
+    template IouBoundsT<T> iouBoundsEx(const PolygonViewT<T> &, const PolygonViewT<T> &); \
+    template IouBoundsT<T> iouBounds(const QuadT<T> &, const QuadT<T> &);               \
+    template IouBoundsT<T> iouBounds(const PreparedPolygonT<T> &,                       \
+                                     const PreparedPolygonT<T> &);                      \
+    template bool iouAboveEx(const std::vector<Vec2<T> > &, const std::vector<Vec2<T> > &, \
+                             const T, const InterMethod);                               \
+    template bool iouAboveEx(const PolygonViewT<T> &, const PolygonViewT<T> &,          \
+                             const T, const InterMethod);                               \
+    template bool iouAbove(const QuadT<T> &, const QuadT<T> &, const T, const InterMethod); \
+    template bool iouAbove(const PreparedPolygonT<T> &, const PreparedPolygonT<T> &,    \
+                           const T, const InterMethod);                                 \
+    template void iouMatrix(const std::vector<QuadT<T> > &, const std::vector<QuadT<T> > &, \
+                            T *, const InterMethod);                                    \
+    template void iouMatrixEx(const std::vector<std::vector<Vec2<T> > > &,              \
+                              const std::vector<std::vector<Vec2<T> > > &,              \
+                              T *, const InterMethod);                                  \
+    template void iouMatrixParallel(const std::vector<QuadT<T> > &,                     \
+                                    const std::vector<QuadT<T> > &,                     \
+                                    T *, const int, const InterMethod);                 \
+    template void iouMatrixParallelEx(const std::vector<std::vector<Vec2<T> > > &,      \
+                                      const std::vector<std::vector<Vec2<T> > > &,      \
+                                      T *, const int, const InterMethod);               \
+    template void iouMatrixParallel(const std::vector<QuadT<T> > &,                     \
+                                    const std::vector<QuadT<T> > &,                     \
+                                    T *, ThreadPool &, const InterMethod);              \
+    template void iouMatrixParallelEx(const std::vector<std::vector<Vec2<T> > > &,      \
+                                      const std::vector<std::vector<Vec2<T> > > &,      \
+                                      T *, ThreadPool &, const InterMethod);
+
+IOU_INSTANTIATE(float)
+IOU_INSTANTIATE(double)
+
+#undef IOU_INSTANTIATE
 
 }
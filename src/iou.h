@@ -15,12 +15,32 @@
 
 #include "math.h"
 #include <assert.h>
+#include <algorithm>
 #include <vector>
 
 namespace IOU
 {
+    class ThreadPool;
+
     const double _ZERO_ = 1e-6;
 
+    // Tolerance of the geometric tests for each scalar type: distances,
+    // cross products and parameters within zero() of 0 count as 0.
+    // Single precision keeps a few ulps of margin for coordinates up to a
+    // few thousands.
+    template <typename T>
+    struct Tolerance {
+        static T zero() { return T(0); }
+    };
+    template <>
+    struct Tolerance<float> {
+        static float zero() { return 1e-4f; }
+    };
+    template <>
+    struct Tolerance<double> {
+        static double zero() { return _ZERO_; }
+    };
+
     enum WiseType
     {
         NoneWise,
@@ -33,6 +53,22 @@ namespace IOU
         OnLine,
         InSide
     };
+    // Backends computing the intersection of two convex polygons.
+    enum InterMethod
+    {
+        PointSoup,  // Edge crossings and inner vertexes, ordered by angle.
+        ConvexClip, // Sutherland-Hodgman clipping of C1 by the edges of C2.
+        RobustSoup  // Point soup from exact orientation predicates, with
+                    // near duplicates merged and ordered as a convex hull:
+                    // never -1 for valid polygons, however degenerate the
+                    // intersection.
+    };
+    // Ways of ordering vertexes by angle around their centroid.
+    enum OrderMethod
+    {
+        QuadrantOrder,  // Quadrant, then sign of the cross product.
+        ThetaOrder      // Vec2::theta() of each vertex, as originally.
+    };
 
 
     template <typename T>
@@ -47,13 +83,14 @@ namespace IOU
             T D[2];
         };
 
-        inline bool isZero() { return (abs(x) <= _ZERO_ && abs(y) <= _ZERO_); }
+        inline bool isZero() {
+            return (abs(x) <= Tolerance<T>::zero() && abs(y) <= Tolerance<T>::zero()); }
         inline bool nonZero() { return !isZero(); }
 
         // Constructors.
-        Vec2() : x(0), y(0) {}
-        Vec2(T _x, T _y) : x(_x), y(_y) {}
-        Vec2(const Vec2& p) : x(p.x), y(p.y) {}
+        constexpr Vec2() : x(0), y(0) {}
+        constexpr Vec2(T _x, T _y) : x(_x), y(_y) {}
+        constexpr Vec2(const Vec2& p) : x(p.x), y(p.y) {}
 
         // Access component.
         inline T& operator[](unsigned int i) { assert(i < 2); return D[i]; }
@@ -62,29 +99,30 @@ namespace IOU
         // Operations.
         inline Vec2& operator=(const Vec2 &p) { x = p.x; y = p.y; return *this; }
         inline bool operator==(const Vec2 &p) const {
-            return (abs(x - p.x) <= _ZERO_ && abs(y - p.y) <= _ZERO_);
+            return (abs(x - p.x) <= Tolerance<T>::zero() &&
+                    abs(y - p.y) <= Tolerance<T>::zero());
         }
-        inline Vec2 operator*(T t) const { return Vec2(x * t, y * t); }
-        inline Vec2 operator/(T t) const { return Vec2(x / t, y / t); }       
+        constexpr Vec2 operator*(T t) const { return Vec2(x * t, y * t); }
+        constexpr Vec2 operator/(T t) const { return Vec2(x / t, y / t); }       
         inline Vec2& operator*=(T t) { x *= t; y *= t; return *this; }
         inline Vec2& operator/=(T t) { x /= t; y /= t; return *this; }
 
-        inline Vec2 operator+(const Vec2 &p) const { return Vec2(x + p.x, y + p.y); }
-        inline Vec2 operator-(const Vec2 &p) const { return Vec2(x - p.x, y - p.y); }
+        constexpr Vec2 operator+(const Vec2 &p) const { return Vec2(x + p.x, y + p.y); }
+        constexpr Vec2 operator-(const Vec2 &p) const { return Vec2(x - p.x, y - p.y); }
         inline Vec2& operator+=(const Vec2 &p) { x += p.x; y += p.y; return *this; }
         inline Vec2& operator-=(const Vec2 &p) { x -= p.x; y -= p.y; return *this; }
 
-        inline Vec2 dmul(const Vec2 &p) const { return Vec2(x * p.x, y * p.y); }
-        inline Vec2 ddiv(const Vec2 &p) const { return Vec2(x / p.x, y / p.y); }
+        constexpr Vec2 dmul(const Vec2 &p) const { return Vec2(x * p.x, y * p.y); }
+        constexpr Vec2 ddiv(const Vec2 &p) const { return Vec2(x / p.x, y / p.y); }
         
-        inline T dot(const Vec2 &p) const { return x * p.x + y * p.y; }
-        inline T operator*(const Vec2 &p) const { return x * p.x + y * p.y; }
+        constexpr T dot(const Vec2 &p) const { return x * p.x + y * p.y; }
+        constexpr T operator*(const Vec2 &p) const { return x * p.x + y * p.y; }
 
-        inline T cmul(const Vec2 &p) const { return x * p.y - y * p.x; }
-        inline T operator^(const Vec2 &p) const { return x * p.y - y * p.x; }
+        constexpr T cmul(const Vec2 &p) const { return x * p.y - y * p.x; }
+        constexpr T operator^(const Vec2 &p) const { return x * p.y - y * p.x; }
 
         inline T norm() const { return std::sqrt(x*x + y*y); }
-        inline T normSquared() const { return x*x + y*y; }
+        constexpr T normSquared() const { return x*x + y*y; }
 
         void normalize() { *this /= norm(); }
         Vec2 normalized() const { return *this / norm(); }
@@ -111,7 +149,7 @@ namespace IOU
         }
     };
     template <typename T>
-    inline Vec2<T> operator*(T t, const Vec2<T>& v) { return Vec2<T>(v.x * t, v.y * t); }
+    constexpr Vec2<T> operator*(T t, const Vec2<T>& v) { return Vec2<T>(v.x * t, v.y * t); }
     template <typename T>
     inline T distance(const Vec2<T> &p1, const Vec2<T> &p2) { return p1.distance(p2); }
     template <typename T>
@@ -126,110 +164,624 @@ namespace IOU
     typedef Vec2<float> Vec2f;
     typedef Vec2<double> Vec2d;
     typedef Vec2d Point;
+    typedef Vec2f Pointf;
     typedef std::vector<Point> Vertexes;
+    typedef std::vector<Pointf> Vertexesf;
+
+    // The geometry below is templated on the scalar type T, and
+    // instantiated for float and double. The names without suffix use
+    // double, those with an f suffix use float.
 
 
-    class Line {
+    // Fixed-capacity polygon stored in place, for allocation-free paths.
+    // It mimics the part of the std::vector interface used by Vertexes.
+    // A push_back on a full polygon stores nothing and returns false, and
+    // overflowed() stays true until the next clear(), so that callers can
+    // redo the work in a std::vector instead of using a truncated polygon.
+    template <int N, typename T = double>
+    class SmallPolygon {
     public:
-        union {
-            struct
-            {
-                Point p1;
-                Point p2;
-            };
-            Point vert[2];
-        };
+        typedef Vec2<T> Point;
+
         // Constructors.
-        Line() : p1(Point()), p2(Point()) {}
-        Line(const Point &_p1, const Point &_p2) : p1(_p1), p2(_p2) {}
-        Line(const Point _vert[2]) : p1(_vert[0]), p2(_vert[1]) {}
-        Line(const Line &line) : p1(line.p1), p2(line.p2) {}
+        SmallPolygon() : n(0), over(false) {}
+
+        // Access vertexes.
+        inline Point& operator[](int i) { assert(i < n); return vert[i]; }
+        inline const Point& operator[](int i) const { assert(i < n); return vert[i]; }
+        inline Point* data() { return vert; }
+        inline const Point* data() const { return vert; }
+        inline Point* begin() { return vert; }
+        inline const Point* begin() const { return vert; }
+        inline Point* end() { return vert + n; }
+        inline const Point* end() const { return vert + n; }
+
+        // Methods.
+        inline int size() const { return n; }
+        inline bool empty() const { return n == 0; }
+        inline bool full() const { return n == N; }
+        inline bool overflowed() const { return over; }
+        static int capacity() { return N; }
+        inline void clear() { n = 0; over = false; }
+        inline bool push_back(const Point &p) {
+            if (n == N) {
+                over = true;
+                return false;
+            }
+            vert[n++] = p;
+            return true;
+        }
+        inline void pop_back() { assert(n > 0); --n; }
+        inline Point& back() { assert(n > 0); return vert[n - 1]; }
+        inline const Point& back() const { assert(n > 0); return vert[n - 1]; }
+        void getVertList(std::vector<Point> &_vert) const {
+            std::vector<Point> vertTemp(vert, vert + n);
+            _vert.swap(vertTemp);
+        }
+
+    private:
+        Point vert[N];
+        int n;
+        bool over;
+    };
+
+
+    // Axis-aligned bounding box.
+    template <typename T>
+    struct AABBT {
+        // Members.
+        T xMin;
+        T yMin;
+        T xMax;
+        T yMax;
+
+        // Constructors.
+        AABBT() : xMin(0), yMin(0), xMax(0), yMax(0) {}
+        AABBT(T _xMin, T _yMin, T _xMax, T _yMax)
+            : xMin(_xMin), yMin(_yMin), xMax(_xMax), yMax(_yMax) {}
+
+        // Methods.
+        inline T width() const { return xMax - xMin; }
+        inline T height() const { return yMax - yMin; }
+        inline Vec2<T> center() const {
+            return Vec2<T>((xMin + xMax) / T(2), (yMin + yMax) / T(2)); }
+        inline bool overlaps(const AABBT &b) const {
+            return !(xMax < b.xMin || b.xMax < xMin ||
+                     yMax < b.yMin || b.yMax < yMin);
+        }
+    };
+    // Upper bound of the iou of two polygons from their bounding boxes and
+    // areas: their intersection fits in that of the boxes and in each of them.
+    template <typename T>
+    inline T iouBound(const AABBT<T> &a, const T areaA, const AABBT<T> &b, const T areaB) {
+        const T w = std::min(a.xMax, b.xMax) - std::max(a.xMin, b.xMin);
+        const T h = std::min(a.yMax, b.yMax) - std::max(a.yMin, b.yMin);
+        if (w < T(0) || h < T(0))
+            return T(0);
+        const T inter = std::min(w * h, std::min(areaA, areaB));
+        const T uni = areaA + areaB - inter;
+        return uni > T(0) ? inter / uni : T(0);
+    }
+    template <typename T>
+    inline bool overlaps(const AABBT<T> &b1, const AABBT<T> &b2) {
+        return b1.overlaps(b2); }
+    typedef AABBT<double> AABB;
+    typedef AABBT<float> AABBf;
+
+
+    template <typename T>
+    class LineT {
+    public:
+        typedef Vec2<T> Point;
+
+        // Members.
+        Point vert[2];
+
+        // Constructors.
+        LineT() {}
+        LineT(const Point &_p1, const Point &_p2) { vert[0] = _p1; vert[1] = _p2; }
+        LineT(const Point _vert[2]) { vert[0] = _vert[0]; vert[1] = _vert[1]; }
+        LineT(const LineT &line) { vert[0] = line.vert[0]; vert[1] = line.vert[1]; }
 
         // Operations.
-        Line& operator=(const Line &line) { p1 = line.p1; p2 = line.p2; return *this; }
+        LineT& operator=(const LineT &line) {
+            vert[0] = line.vert[0]; vert[1] = line.vert[1]; return *this; }
+
+        // Access vertexes.
+        inline Point& p1() { return vert[0]; }
+        inline const Point& p1() const { return vert[0]; }
+        inline Point& p2() { return vert[1]; }
+        inline const Point& p2() const { return vert[1]; }
 
         // Methods
-        double length() const {return p1.distance(p2); }
+        T length() const {return p1().distance(p2()); }
         bool isOnLine(const Point &p) const;
-        Point intersection(const Line &line, bool *bOnline = 0) const;
+        Point intersection(const LineT &line, bool *bOnline = 0) const;
+        // Whether the segment crosses line, with the crossing point in p.
+        // Same tolerances as intersection, from cross products only:
+        // segments parallel within zero() radians, or of zero length, do
+        // not cross.
+        bool crossing(const LineT &line, Point *p = 0) const;
     };
-    inline bool isOnLine(const Line &line, const Point &p) {
+    template <typename T>
+    inline bool isOnLine(const LineT<T> &line, const Vec2<T> &p) {
         return line.isOnLine(p); }
-    inline bool isOnLine(const Point &p, const Line &line) {
+    template <typename T>
+    inline bool isOnLine(const Vec2<T> &p, const LineT<T> &line) {
         return line.isOnLine(p); }
-    inline Point intersection(const Line &line1, const Line &line2, bool *bOnline = 0) {
+    template <typename T>
+    inline Vec2<T> intersection(const LineT<T> &line1, const LineT<T> &line2, bool *bOnline = 0) {
         return line1.intersection(line2,bOnline); }
+    typedef LineT<double> Line;
+    typedef LineT<float> Linef;
 
 
-    class Quad {
+    template <typename T>
+    class QuadT {
     public:
+        typedef Vec2<T> Point;
+        typedef std::vector<Point> Vertexes;
+
         // in clockwise
-        union {
-            struct
-            {
-                Point p1;
-                Point p2;
-                Point p3;
-                Point p4;
-            };
-            Point vert[4];
-        };
+        Point vert[4];
+
         // Constructors.
-        Quad() : p1(Point()), p2(Point()), p3(Point()), p4(Point()) {}
-        Quad(const Point &_p1, const Point &_p2, const Point &_p3, const Point &_p4)
-            : p1(_p1), p2(_p2), p3(_p3), p4(_p4) {}
-        Quad(const Point _vert[4])
-            : p1(_vert[0]), p2(_vert[1]), p3(_vert[2]), p4(_vert[3]) {}
-        Quad(const Quad &quad)
-            : p1(quad.p1), p2(quad.p2), p3(quad.p3), p4(quad.p4) {}
+        QuadT() {}
+        QuadT(const Point &_p1, const Point &_p2, const Point &_p3, const Point &_p4) {
+            vert[0] = _p1; vert[1] = _p2; vert[2] = _p3; vert[3] = _p4; }
+        QuadT(const Point _vert[4]) {
+            for (int i = 0; i < 4; ++i) vert[i] = _vert[i]; }
+        QuadT(const QuadT &quad) {
+            for (int i = 0; i < 4; ++i) vert[i] = quad.vert[i]; }
 
         // Operations.
-        Quad& operator=(const Quad &quad) {
-            p1 = quad.p1; p2 = quad.p2; p3 = quad.p3; p4 = quad.p4; return *this; }
+        QuadT& operator=(const QuadT &quad) {
+            for (int i = 0; i < 4; ++i) vert[i] = quad.vert[i];
+            return *this; }
+
+        // Access vertexes.
+        inline Point& p1() { return vert[0]; }
+        inline const Point& p1() const { return vert[0]; }
+        inline Point& p2() { return vert[1]; }
+        inline const Point& p2() const { return vert[1]; }
+        inline Point& p3() { return vert[2]; }
+        inline const Point& p3() const { return vert[2]; }
+        inline Point& p4() { return vert[3]; }
+        inline const Point& p4() const { return vert[3]; }
+        Point* data() { return vert; }
+        const Point* data() const { return vert; }
 
         // Methods.
-        void flip() { swap(p2, p4); }
+        void flip() { swap(vert[1], vert[3]); }
         void getVertList(Vertexes &_vert) const;
         bool haveRepeatVert() const;
+        AABBT<T> boundingBox() const;
 
-        double area() const;
+        T area() const;
         WiseType whichWise() const;
         bool isInClockWise() const { return ClockWise == whichWise(); }
         bool isInAntiClockWise() const { return AntiClockWise == whichWise(); }
-        void beInSomeWise(const WiseType wiseType);
+        void beInSomeWise(const WiseType wiseType,
+                          const OrderMethod order = QuadrantOrder);
         void beInClockWise() { beInSomeWise(ClockWise); }
         void beInAntiClockWise() { beInSomeWise(AntiClockWise); }
 
         LocPosition location(const Point &p) const;
-        int interPts(const Line &line, Vertexes &pts) const;
+        int interPts(const LineT<T> &line, Vertexes &pts) const;
     };
-    inline LocPosition location(const Quad &quad, const Point &p) {
+    template <typename T>
+    inline LocPosition location(const QuadT<T> &quad, const Vec2<T> &p) {
         return quad.location(p); }
-    inline int interPts(const Quad &quad, const Line &line, Vertexes &pts) {
+    template <typename T>
+    inline int interPts(const QuadT<T> &quad, const LineT<T> &line, std::vector<Vec2<T> > &pts) {
         return quad.interPts(line,pts); }
+    typedef QuadT<double> Quad;
+    typedef QuadT<float> Quadf;
 
 
     // For any convex polygon
-    double areaEx(const Vertexes &C);
-    WiseType whichWiseEx(const Vertexes &C);
-    void beInSomeWiseEx(Vertexes &C, const WiseType wiseType);
-    LocPosition locationEx(const Vertexes &C, const Point &p);
-    int interPtsEx(const Vertexes &C, const Line &line, Vertexes &pts);
+    template <typename T>
+    AABBT<T> boundingBoxEx(const std::vector<Vec2<T> > &C);
+    template <typename T>
+    T areaEx(const std::vector<Vec2<T> > &C);
+    template <typename T>
+    WiseType whichWiseEx(const std::vector<Vec2<T> > &C);
+    // Order C by angle around its centroid. QuadrantOrder calls no
+    // trigonometric function, and sorts up to 8 vertexes with a sorting
+    // network; the intersections use it.
+    template <typename T>
+    void beInSomeWiseEx(std::vector<Vec2<T> > &C, const WiseType wiseType,
+                        const OrderMethod order = QuadrantOrder);
+    // Replace the points of C by their convex hull, in place and without
+    // allocating: Andrew's monotone chain with exact orientations, in
+    // ClockWise as Quad, repeated and collinear points dropped.
+    // Returns the number of vertexes, 0 with C emptied if the points are
+    // all collinear.
+    template <typename T>
+    int convexHullEx(std::vector<Vec2<T> > &C);
+    // Douglas-Peucker reduction of the closed polygon C, in place: the
+    // vertexes within tolerance of the outline of those kept are dropped.
+    // An ordered convex C stays so, in the same wise, and keeps at least
+    // 3 vertexes. Returns the number left.
+    template <typename T>
+    int simplifyEx(std::vector<Vec2<T> > &C, const T tolerance);
+    template <typename T>
+    LocPosition locationEx(const std::vector<Vec2<T> > &C, const Vec2<T> &p);
+    template <typename T>
+    int interPtsEx(const std::vector<Vec2<T> > &C, const LineT<T> &line,
+                   std::vector<Vec2<T> > &pts);
 
 
     // For any convex polygon
-    int findInterPointsEx(const Vertexes &C1, const Vertexes &C2, Vertexes &vert);
-    int findInnerPointsEx(const Vertexes &C1, const Vertexes &C2, Vertexes &vert);
-    double areaIntersectionEx(const Vertexes &C1, const Vertexes &C2);
-    double areaUnionEx(const Vertexes &C1, const Vertexes &C2);
-    double iouEx(const Vertexes &C1, const Vertexes &C2);
+    template <typename T>
+    int findInterPointsEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                          std::vector<Vec2<T> > &vert);
+    // Vertexes of C2 not outside C1; in O(|C2| log |C1|) for a convex C1
+    // of 16 vertexes or more.
+    template <typename T>
+    int findInnerPointsEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                          std::vector<Vec2<T> > &vert);
+    template <typename T>
+    T areaIntersectionEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                         const InterMethod method = PointSoup);
+    template <typename T>
+    T areaUnionEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                  const InterMethod method = PointSoup);
+    template <typename T>
+    T iouEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+            const InterMethod method = PointSoup);
+    // Clip C1 by C2, the result is ordered in the same wise as C1.
+    template <typename T>
+    int clipConvexEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                     std::vector<Vec2<T> > &vert);
+    // Intersection polygon of C1 and C2, written to out, whose capacity is
+    // reused. It is ordered in the same wise as C1, repeated vertexes
+    // dropped, and its area is that of areaIntersectionEx, less the
+    // slivers of the vertexes dropped as collinear with their neighbours,
+    // each of area at most Tolerance<T>::zero()/2.
+    // Returns the number of vertexes, 0 if C1 and C2 do not overlap, or -1
+    // if either is NoneWise or the intersection cannot be ordered.
+    template <typename T>
+    int intersectionPolygonEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                              std::vector<Vec2<T> > &out,
+                              const InterMethod method = PointSoup);
+
+
+    // Vertexes of a polygon stored elsewhere, e.g. in a memory-mapped
+    // file or a caller's buffer, used in place of Vertexes without copying.
+    // The Vertexes versions of the functions below go through it.
+    template <typename T>
+    class PolygonViewT {
+    public:
+        typedef Vec2<T> Point;
+
+        // Constructors.
+        PolygonViewT() : vert(0), n(0) {}
+        PolygonViewT(const Point *_vert, const size_t _n) : vert(_vert), n(int(_n)) {}
+        PolygonViewT(const std::vector<Point> &C) : vert(C.data()), n(C.size()) {}
+
+        // Access vertexes.
+        inline const Point& operator[](int i) const { assert(i < n); return vert[i]; }
+        inline const Point* data() const { return vert; }
+        inline const Point* begin() const { return vert; }
+        inline const Point* end() const { return vert + n; }
+
+        // Methods.
+        inline int size() const { return n; }
+        inline bool empty() const { return n == 0; }
+
+    private:
+        const Point *vert;
+        int n;
+    };
+    typedef PolygonViewT<double> PolygonView;
+    typedef PolygonViewT<float> PolygonViewf;
+
+    // Same as the Vertexes versions.
+    template <typename T>
+    AABBT<T> boundingBoxEx(const PolygonViewT<T> &C);
+    template <typename T>
+    T areaEx(const PolygonViewT<T> &C);
+    template <typename T>
+    WiseType whichWiseEx(const PolygonViewT<T> &C);
+    template <typename T>
+    LocPosition locationEx(const PolygonViewT<T> &C, const Vec2<T> &p);
+    template <typename T>
+    T areaIntersectionEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                         const InterMethod method = PointSoup);
+    template <typename T>
+    T areaUnionEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                  const InterMethod method = PointSoup);
+    template <typename T>
+    T iouEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+            const InterMethod method = PointSoup);
+    template <typename T>
+    int interPtsEx(const PolygonViewT<T> &C, const LineT<T> &line,
+                   std::vector<Vec2<T> > &pts);
+    template <typename T>
+    int findInterPointsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                          std::vector<Vec2<T> > &vert);
+    template <typename T>
+    int findInnerPointsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                          std::vector<Vec2<T> > &vert);
+    template <typename T>
+    int clipConvexEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                     std::vector<Vec2<T> > &vert);
+    template <typename T>
+    int intersectionPolygonEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                              std::vector<Vec2<T> > &out,
+                              const InterMethod method = PointSoup);
+
+
+    // Polygon over raw coordinates stored elsewhere, vertex i being
+    // (x[i*stride], y[i*stride]): interleaved x,y pairs have y = x+1 and
+    // stride 2, separate x and y arrays have stride 1.
+    // Its vertexes are gathered into a buffer, on the stack up to 32 of
+    // them, before calling the PolygonView versions.
+    template <typename T>
+    class StridedPolygonViewT {
+    public:
+        // Constructors.
+        StridedPolygonViewT() : xs(0), ys(0), n(0), step(0) {}
+        StridedPolygonViewT(const T *_x, const T *_y, const size_t _n, const int _stride)
+            : xs(_x), ys(_y), n(int(_n)), step(_stride) {}
+        // Interleaved x,y pairs.
+        StridedPolygonViewT(const T *xy, const size_t _n)
+            : xs(xy), ys(xy + 1), n(int(_n)), step(2) {}
+
+        // Access vertexes.
+        inline Vec2<T> operator[](int i) const {
+            assert(i < n); return Vec2<T>(xs[i*step], ys[i*step]); }
+
+        // Methods.
+        inline int size() const { return n; }
+        inline bool empty() const { return n == 0; }
+        inline int stride() const { return step; }
+
+    private:
+        const T *xs;
+        const T *ys;
+        int n;
+        int step;
+    };
+    typedef StridedPolygonViewT<double> StridedPolygonView;
+    typedef StridedPolygonViewT<float> StridedPolygonViewf;
+
+    // Same as the Vertexes versions.
+    template <typename T>
+    AABBT<T> boundingBoxEx(const StridedPolygonViewT<T> &C);
+    template <typename T>
+    T areaEx(const StridedPolygonViewT<T> &C);
+    template <typename T>
+    WiseType whichWiseEx(const StridedPolygonViewT<T> &C);
+    template <typename T>
+    LocPosition locationEx(const StridedPolygonViewT<T> &C, const Vec2<T> &p);
+    template <typename T>
+    T areaIntersectionEx(const StridedPolygonViewT<T> &C1, const StridedPolygonViewT<T> &C2,
+                         const InterMethod method = PointSoup);
+    template <typename T>
+    T areaUnionEx(const StridedPolygonViewT<T> &C1, const StridedPolygonViewT<T> &C2,
+                  const InterMethod method = PointSoup);
+    template <typename T>
+    T iouEx(const StridedPolygonViewT<T> &C1, const StridedPolygonViewT<T> &C2,
+            const InterMethod method = PointSoup);
 
 
     // For convex quadrilateral
-    int findInterPoints(const Quad &Q1, const Quad &Q2, Vertexes &vert);
-    int findInnerPoints(const Quad &Q1, const Quad &Q2, Vertexes &vert);
-    double areaIntersection(const Quad&Q1, const Quad &Q2);
-    double areaUnion(const Quad &Q1, const Quad &Q2);
-    double iou(const Quad &Q1, const Quad &Q2);
+    // areaIntersection, areaUnion and iou do not allocate on the heap.
+    // Pairs with disjoint bounding boxes are rejected before the exact
+    // computation, here as in areaIntersectionEx.
+    template <typename T>
+    int findInterPoints(const QuadT<T> &Q1, const QuadT<T> &Q2, std::vector<Vec2<T> > &vert);
+    template <typename T>
+    int findInnerPoints(const QuadT<T> &Q1, const QuadT<T> &Q2, std::vector<Vec2<T> > &vert);
+    template <typename T>
+    T areaIntersection(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                       const InterMethod method = PointSoup);
+    template <typename T>
+    T areaUnion(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                const InterMethod method = PointSoup);
+    template <typename T>
+    T iou(const QuadT<T> &Q1, const QuadT<T> &Q2,
+          const InterMethod method = PointSoup);
+    // Same as intersectionPolygonEx.
+    template <typename T>
+    int intersectionPolygon(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                            std::vector<Vec2<T> > &out,
+                            const InterMethod method = PointSoup);
+
+
+    // Largest prepared polygons intersected without allocating.
+    const int PreparedFixedSize = 8;
+
+    // For any convex polygon, with its derived data computed once:
+    // winding, area, vertex centroid, bounding box and circle, edges and
+    // their outward normal equations. Pairs whose bounding boxes or
+    // bounding circles are apart are rejected without computing the
+    // intersection, the others reuse the cached data and, for polygons of
+    // up to PreparedFixedSize vertexes, do not allocate.
+    template <typename T>
+    class PreparedPolygonT {
+    public:
+        typedef Vec2<T> Point;
+        typedef std::vector<Point> Vertexes;
+        typedef LineT<T> Line;
+
+        // Constructors.
+        PreparedPolygonT();
+        explicit PreparedPolygonT(const Vertexes &C);
+        explicit PreparedPolygonT(const QuadT<T> &Q);
+
+        // Methods.
+        const Vertexes& vertexes() const { return vert; }
+        int size() const { return vert.size(); }
+        WiseType whichWise() const { return wise; }
+        bool isValid() const { return wise != NoneWise; }
+        T area() const { return areaV; }
+        const AABBT<T>& boundingBox() const { return box; }
+        const Point& circleCenter() const { return center; }
+        T circleRadius() const { return radius; }
+        // Mean of the vertexes, as used by locationEx.
+        const Point& centroid() const { return centroidV; }
+        // Radius of a circle around centroid() inside the polygon.
+        T inscribedRadius() const { return inRadius; }
+        // edges()[i] goes from vertex i to vertex i+1.
+        const std::vector<Line>& edges() const { return edgesV; }
+        // p is on the inner side of edge i when
+        // normals()[i]*p <= offsets()[i], whatever the winding.
+        const std::vector<Point>& normals() const { return normalsV; }
+        const std::vector<T>& offsets() const { return offsetsV; }
+        // Same as locationEx, in O(log N) from 16 vertexes on.
+        LocPosition location(const Point &p) const;
+        bool mayOverlap(const PreparedPolygonT &P) const {
+            return box.overlaps(P.box) &&
+                   center.squareDistance(P.center) <=
+                   (radius + P.radius)*(radius + P.radius);
+        }
+
+    private:
+        void prepare();
+
+        Vertexes vert;
+        WiseType wise;
+        T areaV;
+        AABBT<T> box;
+        Point center;
+        T radius;
+        Point centroidV;
+        T inRadius;
+        T centroidDist;
+        std::vector<Line> edgesV;
+        std::vector<Point> normalsV;
+        std::vector<T> offsetsV;
+    };
+    template <typename T>
+    T areaIntersection(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+                       const InterMethod method = PointSoup);
+    template <typename T>
+    T areaUnion(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+                const InterMethod method = PointSoup);
+    template <typename T>
+    T iou(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+          const InterMethod method = PointSoup);
+    typedef PreparedPolygonT<double> PreparedPolygon;
+    typedef PreparedPolygonT<float> PreparedPolygonf;
+
+
+    // Metrics of iouMetrics and iouMetricsEx, combined with |.
+    // The intersection, union and iou are always computed.
+    enum IouMetric
+    {
+        MetricIou  = 0,
+        MetricGIou = 1, // Generalized iou, over the convex hull of both.
+        MetricDIou = 2, // Distance iou, over their centroids and the
+                        // diagonal of their common bounding box.
+        MetricAll  = MetricGIou | MetricDIou
+    };
+    template <typename T>
+    struct IouMetricsT {
+        T intersection;
+        T unionArea;
+        T iou;
+        T giou;         // iou - (hull - union)/hull, 0 if not asked for.
+        T diou;         // iou - d^2/c^2, 0 if not asked for.
+    };
+    typedef IouMetricsT<double> IouMetrics;
+    typedef IouMetricsT<float> IouMetricsf;
+
+    // All the metrics asked for from a single intersection, the wise and
+    // area of each polygon computed once.
+    // Every field is -1 if either polygon is NoneWise, or if PointSoup
+    // cannot order their intersection.
+    template <typename T>
+    IouMetricsT<T> iouMetricsEx(const std::vector<Vec2<T> > &C1,
+                                const std::vector<Vec2<T> > &C2,
+                                const unsigned int metrics = MetricAll,
+                                const InterMethod method = PointSoup);
+    template <typename T>
+    IouMetricsT<T> iouMetricsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                                const unsigned int metrics = MetricAll,
+                                const InterMethod method = PointSoup);
+    template <typename T>
+    IouMetricsT<T> iouMetrics(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                              const unsigned int metrics = MetricAll,
+                              const InterMethod method = PointSoup);
+
+    // Bounds of the iou, lower <= iou <= upper.
+    template <typename T>
+    struct IouBoundsT {
+        T lower;
+        T upper;
+    };
+    typedef IouBoundsT<double> IouBounds;
+    typedef IouBoundsT<float> IouBoundsf;
+
+    // Bounds of the iou without intersecting the polygons, in O(N1+N2):
+    // the intersection contains that of the circles inside them, and lies
+    // in those of their bounding boxes and of the circles around them.
+    // Widened by the tolerance of T, so that they hold for the iou as
+    // computed in T, and exactly 0 for polygons whose bounding boxes are
+    // apart.
+    // Both are -1 if either polygon is NoneWise.
+    template <typename T>
+    IouBoundsT<T> iouBoundsEx(const std::vector<Vec2<T> > &C1,
+                              const std::vector<Vec2<T> > &C2);
+    template <typename T>
+    IouBoundsT<T> iouBoundsEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2);
+    template <typename T>
+    IouBoundsT<T> iouBounds(const QuadT<T> &Q1, const QuadT<T> &Q2);
+    // In O(1), from the circles kept by PreparedPolygon.
+    template <typename T>
+    IouBoundsT<T> iouBounds(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2);
+
+    // Whether the iou is above t. The bounds answer when they lie on one
+    // side of t, the exact iou otherwise.
+    // False if either polygon is NoneWise.
+    template <typename T>
+    bool iouAboveEx(const std::vector<Vec2<T> > &C1, const std::vector<Vec2<T> > &C2,
+                    const T t, const InterMethod method = PointSoup);
+    template <typename T>
+    bool iouAboveEx(const PolygonViewT<T> &C1, const PolygonViewT<T> &C2,
+                    const T t, const InterMethod method = PointSoup);
+    template <typename T>
+    bool iouAbove(const QuadT<T> &Q1, const QuadT<T> &Q2,
+                  const T t, const InterMethod method = PointSoup);
+    template <typename T>
+    bool iouAbove(const PreparedPolygonT<T> &P1, const PreparedPolygonT<T> &P2,
+                  const T t, const InterMethod method = PointSoup);
+
+    // Batched, many-to-many.
+    // Fill the |A|x|B| row-major matrix out with out[i*|B|+j] = iou(A[i],B[j]).
+    // Area, wise and bounding box of each polygon are computed only once,
+    // and pairs with disjoint bounding boxes skip the intersection.
+    // The iou is -1 where either polygon is NoneWise.
+    template <typename T>
+    void iouMatrix(const std::vector<QuadT<T> > &A, const std::vector<QuadT<T> > &B,
+                   T *out, const InterMethod method = PointSoup);
+    template <typename T>
+    void iouMatrixEx(const std::vector<std::vector<Vec2<T> > > &A,
+                     const std::vector<std::vector<Vec2<T> > > &B,
+                     T *out, const InterMethod method = PointSoup);
+    // Same, with the matrix split in tiles run by a work-stealing pool of
+    // nThreads workers (nThreads <= 0: one per hardware thread), or by an
+    // existing pool.
+    template <typename T>
+    void iouMatrixParallel(const std::vector<QuadT<T> > &A, const std::vector<QuadT<T> > &B,
+                           T *out, const int nThreads = 0,
+                           const InterMethod method = PointSoup);
+    template <typename T>
+    void iouMatrixParallelEx(const std::vector<std::vector<Vec2<T> > > &A,
+                             const std::vector<std::vector<Vec2<T> > > &B,
+                             T *out, const int nThreads = 0,
+                             const InterMethod method = PointSoup);
+    template <typename T>
+    void iouMatrixParallel(const std::vector<QuadT<T> > &A, const std::vector<QuadT<T> > &B,
+                           T *out, ThreadPool &pool,
+                           const InterMethod method = PointSoup);
+    template <typename T>
+    void iouMatrixParallelEx(const std::vector<std::vector<Vec2<T> > > &A,
+                             const std::vector<std::vector<Vec2<T> > > &B,
+                             T *out, ThreadPool &pool,
+                             const InterMethod method = PointSoup);
 }
 #endif // !_IOU_H_FILE_
@@ -0,0 +1,201 @@
+/***********************************
+ * join.cpp
+ *
+ * Sparse all-pairs iou of two sets of
+ * convex polygons, by sweep and prune.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "join.h"
+#include "sweep.h"
+#include <algorithm>
+
+namespace IOU
+{
+
+namespace
+{
+
+struct XMinLess
+{
+    explicit XMinLess(const std::vector<AABB> &_boxes) : boxes(_boxes) {}
+    bool operator()(const int a, const int b) const {
+        return boxes[a].xMin < boxes[b].xMin;
+    }
+    const std::vector<AABB> &boxes;
+};
+
+// Bounding box and area of every polygon of a set, the area being -1
+// for invalid polygons.
+struct SweepSet
+{
+    std::vector<AABB> boxes;
+    std::vector<double> areas;
+    // Indexes of the valid polygons by increasing xMin.
+    std::vector<int> order;
+
+    void sortOrder() {
+        const int N = boxes.size();
+        order.clear();
+        for (int i = 0; i < N; ++i)
+            if (areas[i] >= 0.0)
+                order.push_back(i);
+        std::sort(order.begin(), order.end(), XMinLess(boxes));
+    }
+};
+
+void fillSet(const std::vector<Quad> &Q, SweepSet &S)
+{
+    const int N = Q.size();
+    S.boxes.resize(N);
+    S.areas.resize(N);
+    for (int i = 0; i < N; ++i) {
+        S.boxes[i] = Q[i].boundingBox();
+        S.areas[i] = Q[i].whichWise() == NoneWise ? -1.0 : Q[i].area();
+    }
+    S.sortOrder();
+}
+void fillSet(const std::vector<Vertexes> &C, SweepSet &S)
+{
+    const int N = C.size();
+    S.boxes.resize(N);
+    S.areas.resize(N);
+    for (int i = 0; i < N; ++i) {
+        S.boxes[i] = boundingBoxEx(C[i]);
+        S.areas[i] = whichWiseEx(C[i]) == NoneWise ? -1.0 : areaEx(C[i]);
+    }
+    S.sortOrder();
+}
+void fillSet(const std::vector<PolygonView> &C, SweepSet &S)
+{
+    const int N = C.size();
+    S.boxes.resize(N);
+    S.areas.resize(N);
+    for (int i = 0; i < N; ++i) {
+        S.boxes[i] = boundingBoxEx(C[i]);
+        S.areas[i] = whichWiseEx(C[i]) == NoneWise ? -1.0 : areaEx(C[i]);
+    }
+    S.sortOrder();
+}
+
+double iouOf(const Quad &Q1, const Quad &Q2, const InterMethod method)
+{
+    return iou(Q1, Q2, method);
+}
+double iouOf(const Vertexes &C1, const Vertexes &C2, const InterMethod method)
+{
+    return iouEx(C1, C2, method);
+}
+double iouOf(const PolygonView &C1, const PolygonView &C2, const InterMethod method)
+{
+    return iouEx(C1, C2, method);
+}
+
+// Pairs handed to the sink chunk by chunk.
+class PairBuffer {
+public:
+    PairBuffer(const IouPairSink &_sink, const int chunkSize)
+        : sink(_sink), capacity(std::max(chunkSize, 1)) {
+        pairs.reserve(capacity);
+    }
+    void push_back(const IouPair &p) {
+        pairs.push_back(p);
+        if ((int)pairs.size() == capacity)
+            flush();
+    }
+    void flush() {
+        if (!pairs.empty())
+            sink(pairs.data(), pairs.size());
+        pairs.clear();
+    }
+
+private:
+    const IouPairSink &sink;
+    const int capacity;
+    std::vector<IouPair> pairs;
+};
+
+template <class Poly>
+void sweepJoin(const std::vector<Poly> &A, const std::vector<Poly> &B,
+               const double thresh, const IouPairSink &sink,
+               const int chunkSize, const InterMethod method)
+{
+    SweepSet SA, SB;
+    fillSet(A, SA);
+    fillSet(B, SB);
+    PairBuffer out(sink, chunkSize);
+
+    sweep::sweepPairs(SA.order, [&](const int i) -> const AABB& { return SA.boxes[i]; },
+                      SB.order, [&](const int j) -> const AABB& { return SB.boxes[j]; },
+                      [&](const bool fromA, const int n, const int m) {
+        IouPair p;
+        p.i = fromA ? n : m;
+        p.j = fromA ? m : n;
+        if (iouBound(SA.boxes[p.i], SA.areas[p.i], SB.boxes[p.j], SB.areas[p.j]) > thresh) {
+            p.iou = iouOf(A[p.i], B[p.j], method);
+            if (p.iou > thresh)
+                out.push_back(p);
+        }
+        return true;
+    });
+    out.flush();
+}
+
+bool pairLess(const IouPair &a, const IouPair &b)
+{
+    return a.i < b.i || (a.i == b.i && a.j < b.j);
+}
+
+template <class Poly>
+std::vector<IouPair> collectJoin(const std::vector<Poly> &A, const std::vector<Poly> &B,
+                                 const double thresh, const InterMethod method)
+{
+    std::vector<IouPair> result;
+    sweepJoin(A, B, thresh, [&](const IouPair *pairs, const int n) {
+        result.insert(result.end(), pairs, pairs + n);
+    }, 4096, method);
+    std::sort(result.begin(), result.end(), pairLess);
+    return result;
+}
+
+} // namespace
+
+void iouJoin(const std::vector<Quad> &A, const std::vector<Quad> &B,
+             const double thresh, const IouPairSink &sink,
+             const int chunkSize, const InterMethod method)
+{
+    sweepJoin(A, B, thresh, sink, chunkSize, method);
+}
+void iouJoinEx(const std::vector<Vertexes> &A, const std::vector<Vertexes> &B,
+               const double thresh, const IouPairSink &sink,
+               const int chunkSize, const InterMethod method)
+{
+    sweepJoin(A, B, thresh, sink, chunkSize, method);
+}
+void iouJoinEx(const std::vector<PolygonView> &A, const std::vector<PolygonView> &B,
+               const double thresh, const IouPairSink &sink,
+               const int chunkSize, const InterMethod method)
+{
+    sweepJoin(A, B, thresh, sink, chunkSize, method);
+}
+
+std::vector<IouPair> iouJoinPairs(const std::vector<Quad> &A, const std::vector<Quad> &B,
+                                  const double thresh, const InterMethod method)
+{
+    return collectJoin(A, B, thresh, method);
+}
+std::vector<IouPair> iouJoinPairsEx(const std::vector<Vertexes> &A,
+                                    const std::vector<Vertexes> &B,
+                                    const double thresh, const InterMethod method)
+{
+    return collectJoin(A, B, thresh, method);
+}
+std::vector<IouPair> iouJoinPairsEx(const std::vector<PolygonView> &A,
+                                    const std::vector<PolygonView> &B,
+                                    const double thresh, const InterMethod method)
+{
+    return collectJoin(A, B, thresh, method);
+}
+
+}
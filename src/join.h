@@ -0,0 +1,64 @@
+/***********************************
+ * join.h
+ *
+ * Sparse all-pairs iou of two sets of
+ * convex polygons, by sweep and prune.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_JOIN_H_FILE_
+#define _IOU_JOIN_H_FILE_
+
+#include "iou.h"
+#include <functional>
+
+namespace IOU
+{
+    // Entry of a sparse iou matrix: iou(A[i], B[j]).
+    struct IouPair {
+        int i;
+        int j;
+        double iou;
+    };
+    // Receives the pairs of a join n at a time.
+    typedef std::function<void(const IouPair *pairs, const int n)> IouPairSink;
+
+    // Every pair (i, j) with iou(A[i], B[j]) > thresh, handed to sink in
+    // chunks of at most chunkSize pairs, so that memory does not grow with
+    // the output.
+    // The bounding boxes of A and B are swept together along x, each set
+    // keeping those that span the sweep position; a new box is only
+    // tested against the boxes of the other set it overlaps along y, and
+    // iou is skipped when the bound from the boxes and the areas is at or
+    // below thresh. Pairs come in sweep order, not sorted.
+    // Invalid polygons are never paired.
+    void iouJoin(const std::vector<Quad> &A, const std::vector<Quad> &B,
+                 const double thresh, const IouPairSink &sink,
+                 const int chunkSize = 4096,
+                 const InterMethod method = PointSoup);
+    void iouJoinEx(const std::vector<Vertexes> &A, const std::vector<Vertexes> &B,
+                   const double thresh, const IouPairSink &sink,
+                   const int chunkSize = 4096,
+                   const InterMethod method = PointSoup);
+    // Over polygons stored elsewhere, e.g. in a PolygonFile, without
+    // copying them.
+    void iouJoinEx(const std::vector<PolygonView> &A, const std::vector<PolygonView> &B,
+                   const double thresh, const IouPairSink &sink,
+                   const int chunkSize = 4096,
+                   const InterMethod method = PointSoup);
+
+    // Same, all the pairs collected and sorted by i then j.
+    std::vector<IouPair> iouJoinPairs(const std::vector<Quad> &A, const std::vector<Quad> &B,
+                                      const double thresh,
+                                      const InterMethod method = PointSoup);
+    std::vector<IouPair> iouJoinPairsEx(const std::vector<Vertexes> &A,
+                                        const std::vector<Vertexes> &B,
+                                        const double thresh,
+                                        const InterMethod method = PointSoup);
+    std::vector<IouPair> iouJoinPairsEx(const std::vector<PolygonView> &A,
+                                        const std::vector<PolygonView> &B,
+                                        const double thresh,
+                                        const InterMethod method = PointSoup);
+}
+#endif // !_IOU_JOIN_H_FILE_
@@ -0,0 +1,343 @@
+/***********************************
+ * nms.cpp
+ *
+ * Non-maximum suppression of rotated boxes
+ * and convex polygons, built on iou.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "nms.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace IOU
+{
+
+namespace
+{
+
+inline bool isFinite(const AABB &b)
+{
+    return std::isfinite(b.xMin) && std::isfinite(b.yMin) &&
+           std::isfinite(b.xMax) && std::isfinite(b.yMax);
+}
+// Bounding box of the n vertexes C, NaN if any of them is not finite:
+// the box alone may miss a NaN, which std::min and std::max skip or not
+// depending on the order of their arguments.
+inline AABB checkedBox(const AABB &box, const Point *C, const int n)
+{
+    for (int i = 0; i < n; ++i) {
+        if (!std::isfinite(C[i].x) || !std::isfinite(C[i].y)) {
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            return AABB(nan, nan, nan, nan);
+        }
+    }
+    return box;
+}
+
+// Uniform grid over a set of bounding boxes, each box being listed in
+// every cell it covers. The cell size follows the mean box size, so that
+// a query only visits the few boxes around it.
+// Boxes with a non-finite coordinate are left out: they are near no box.
+class BoxGrid {
+public:
+    explicit BoxGrid(const std::vector<AABB> &boxes)
+        : stamp(boxes.size(), 0), curStamp(0)
+    {
+        const int N = boxes.size();
+        int nFinite = 0;
+        double meanSize = 0.0;
+        for (int i = 0; i < N; ++i) {
+            const AABB &b = boxes[i];
+            if (!isFinite(b))
+                continue;
+            if (nFinite++ == 0)
+                extent = b;
+            extent.xMin = std::min(extent.xMin, b.xMin);
+            extent.yMin = std::min(extent.yMin, b.yMin);
+            extent.xMax = std::max(extent.xMax, b.xMax);
+            extent.yMax = std::max(extent.yMax, b.yMax);
+            meanSize += std::max(b.width(), b.height());
+        }
+        if (nFinite > 0)
+            meanSize /= nFinite;
+
+        // Keep the number of cells in O(N). Extents of finite boxes may
+        // still overflow to inf, for which the counts are capped.
+        double cell = std::max(meanSize, _ZERO_);
+        const int maxCells = 4*N + 16;
+        while ((extent.width() / cell + 1.0) * (extent.height() / cell + 1.0) > maxCells &&
+               cell < DBL_MAX / 2.0)
+            cell *= 2.0;
+        cellSize = cell;
+        nx = cellCount(extent.width(), maxCells);
+        ny = cellCount(extent.height(), maxCells / nx);
+
+        // Cells as a compressed list: counting pass, then filling pass.
+        cellStart.assign(nx*ny + 1, 0);
+        for (int i = 0; i < N; ++i) {
+            if (!isFinite(boxes[i]))
+                continue;
+            int x0, y0, x1, y1;
+            cellRange(boxes[i], x0, y0, x1, y1);
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    ++cellStart[y*nx + x + 1];
+        }
+        for (int c = 0; c < nx*ny; ++c)
+            cellStart[c + 1] += cellStart[c];
+        items.resize(cellStart[nx*ny]);
+        std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < N; ++i) {
+            if (!isFinite(boxes[i]))
+                continue;
+            int x0, y0, x1, y1;
+            cellRange(boxes[i], x0, y0, x1, y1);
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    items[fill[y*nx + x]++] = i;
+        }
+    }
+
+    // Call f(j) once for every box j sharing a cell with the box b.
+    template <class Func>
+    void forEachNear(const AABB &b, Func f)
+    {
+        if (++curStamp == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            curStamp = 1;
+        }
+        if (!isFinite(b))
+            return;
+        int x0, y0, x1, y1;
+        cellRange(b, x0, y0, x1, y1);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                const int c = y*nx + x;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                    const int j = items[k];
+                    if (stamp[j] != curStamp) {
+                        stamp[j] = curStamp;
+                        f(j);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // Number of cells over len, at least 1 and at most maxCells.
+    int cellCount(const double len, const int maxCells) const {
+        const double n = len / cellSize + 1.0;
+        return n >= 1.0 ? (int)std::min(n, (double)maxCells) : 1;
+    }
+    // Clamped in double before the conversion, which is undefined out of
+    // the range of int.
+    int clampCell(const double v, const int n) const {
+        const double c = v / cellSize;
+        return c >= 0.0 ? (c < n ? (int)c : n - 1) : 0;
+    }
+    void cellRange(const AABB &b, int &x0, int &y0, int &x1, int &y1) const {
+        x0 = clampCell(b.xMin - extent.xMin, nx);
+        x1 = clampCell(b.xMax - extent.xMin, nx);
+        y0 = clampCell(b.yMin - extent.yMin, ny);
+        y1 = clampCell(b.yMax - extent.yMin, ny);
+    }
+
+    AABB extent;
+    double cellSize;
+    int nx, ny;
+    std::vector<int> cellStart;
+    std::vector<int> items;
+    std::vector<unsigned int> stamp;
+    unsigned int curStamp;
+};
+
+// Boxes given as quadrilaterals.
+struct QuadBoxes
+{
+    explicit QuadBoxes(const std::vector<Quad> &_quads) : quads(_quads) {
+        boxes.reserve(quads.size());
+        for (size_t i = 0; i < quads.size(); ++i)
+            boxes.push_back(checkedBox(quads[i].boundingBox(), quads[i].data(), 4));
+    }
+    double iou(const int i, const int j) const {
+        return IOU::iou(quads[i], quads[j]);
+    }
+
+    const std::vector<Quad> &quads;
+    std::vector<AABB> boxes;
+};
+// Boxes given as convex polygons.
+struct PolyBoxes
+{
+    explicit PolyBoxes(const std::vector<Vertexes> &polys) {
+        prepared.reserve(polys.size());
+        boxes.reserve(polys.size());
+        for (size_t i = 0; i < polys.size(); ++i) {
+            prepared.push_back(PreparedPolygon(polys[i]));
+            boxes.push_back(checkedBox(prepared.back().boundingBox(),
+                                       polys[i].data(), polys[i].size()));
+        }
+    }
+    double iou(const int i, const int j) const {
+        return IOU::iou(prepared[i], prepared[j]);
+    }
+
+    std::vector<PreparedPolygon> prepared;
+    std::vector<AABB> boxes;
+};
+
+struct ScoreGreater
+{
+    explicit ScoreGreater(const std::vector<float> &_scores) : scores(_scores) {}
+    bool operator()(const int i, const int j) const { return scores[i] > scores[j]; }
+    const std::vector<float> &scores;
+};
+
+template <class Boxes>
+std::vector<int> greedyNms(const Boxes &B, const std::vector<float> &scores,
+                           const double thresh)
+{
+    const int N = B.boxes.size();
+    if ((int)scores.size() != N)
+        return std::vector<int>();
+
+    // NaN scores are dropped: the sort needs a strict weak ordering.
+    std::vector<int> order;
+    order.reserve(N);
+    for (int i = 0; i < N; ++i)
+        if (!std::isnan(scores[i]))
+            order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), ScoreGreater(scores));
+    std::vector<int> rank(N, -1);
+    for (int k = 0; k < (int)order.size(); ++k)
+        rank[order[k]] = k;
+
+    BoxGrid grid(B.boxes);
+    std::vector<char> suppressed(N, 0);
+    std::vector<int> keep;
+    for (int k = 0; k < (int)order.size(); ++k) {
+        const int i = order[k];
+        if (suppressed[i])
+            continue;
+        keep.push_back(i);
+        const AABB &box = B.boxes[i];
+        grid.forEachNear(box, [&](const int j) {
+            if (rank[j] > k && !suppressed[j] &&
+                box.overlaps(B.boxes[j]) && B.iou(i, j) > thresh)
+                suppressed[j] = 1;
+        });
+    }
+    return keep;
+}
+
+template <class Boxes>
+std::vector<int> softNms(const Boxes &B, const std::vector<float> &scores,
+                         const SoftNMSMethod method, const double thresh,
+                         const double sigma, const double scoreThresh,
+                         std::vector<float> *keptScores)
+{
+    const int N = B.boxes.size();
+    if ((int)scores.size() != N) {
+        if (keptScores != 0)
+            keptScores->clear();
+        return std::vector<int>();
+    }
+
+    // Max-heap of (score, -index), entries made stale by a decay are
+    // skipped when popped. NaN scores fail the scoreThresh test and are
+    // dropped, so that the heap has a strict weak ordering.
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry> heap;
+    std::vector<float> cur(scores);
+    std::vector<char> done(N, 0);
+    for (int i = 0; i < N; ++i) {
+        if (cur[i] >= scoreThresh)
+            heap.push(Entry(cur[i], -i));
+        else
+            done[i] = 1;
+    }
+
+    BoxGrid grid(B.boxes);
+    std::vector<int> keep;
+    std::vector<float> kept;
+    while (!heap.empty()) {
+        const Entry top = heap.top();
+        heap.pop();
+        const int i = -top.second;
+        if (done[i] || top.first != cur[i])
+            continue;
+        done[i] = 1;
+        keep.push_back(i);
+        kept.push_back(cur[i]);
+
+        const AABB &box = B.boxes[i];
+        grid.forEachNear(box, [&](const int j) {
+            if (done[j] || !box.overlaps(B.boxes[j]))
+                return;
+            const double o = B.iou(i, j);
+            if (!(o > 0.0))
+                return;
+            double w = 1.0;
+            if (method == SoftNMSLinear)
+                w = (o > thresh) ? 1.0 - o : 1.0;
+            else
+                w = sigma > 0.0 ? std::exp(-o*o / sigma) : 0.0;
+            if (w >= 1.0)
+                return;
+            cur[j] = (float)(cur[j] * w);
+            if (cur[j] < scoreThresh)
+                done[j] = 1;
+            else
+                heap.push(Entry(cur[j], -j));
+        });
+    }
+    if (keptScores != 0)
+        keptScores->swap(kept);
+    return keep;
+}
+
+} // namespace
+
+std::vector<int> nmsRotated(const std::vector<Quad> &boxes,
+                            const std::vector<float> &scores,
+                            const double thresh)
+{
+    return greedyNms(QuadBoxes(boxes), scores, thresh);
+}
+std::vector<int> nmsRotatedEx(const std::vector<Vertexes> &boxes,
+                              const std::vector<float> &scores,
+                              const double thresh)
+{
+    return greedyNms(PolyBoxes(boxes), scores, thresh);
+}
+
+std::vector<int> softNmsRotated(const std::vector<Quad> &boxes,
+                                const std::vector<float> &scores,
+                                const SoftNMSMethod method,
+                                const double thresh,
+                                const double sigma,
+                                const double scoreThresh,
+                                std::vector<float> *keptScores)
+{
+    return softNms(QuadBoxes(boxes), scores, method, thresh,
+                   sigma, scoreThresh, keptScores);
+}
+std::vector<int> softNmsRotatedEx(const std::vector<Vertexes> &boxes,
+                                  const std::vector<float> &scores,
+                                  const SoftNMSMethod method,
+                                  const double thresh,
+                                  const double sigma,
+                                  const double scoreThresh,
+                                  std::vector<float> *keptScores)
+{
+    return softNms(PolyBoxes(boxes), scores, method, thresh,
+                   sigma, scoreThresh, keptScores);
+}
+
+}
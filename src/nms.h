@@ -0,0 +1,61 @@
+/***********************************
+ * nms.h
+ *
+ * Non-maximum suppression of rotated boxes
+ * and convex polygons, built on iou.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_NMS_H_FILE_
+#define _IOU_NMS_H_FILE_
+
+#include "iou.h"
+
+namespace IOU
+{
+    enum SoftNMSMethod
+    {
+        SoftNMSLinear,  // score *= 1 - iou, for iou > thresh.
+        SoftNMSGaussian // score *= exp(-iou^2 / sigma), 0 when sigma <= 0.
+    };
+
+    // Greedy NMS: visit boxes by decreasing score, keep a box unless its
+    // iou with an already kept box is above thresh.
+    // Returns the kept indexes, by decreasing score.
+    // Candidates are looked up in a uniform grid over the bounding boxes,
+    // so iou is only computed for boxes whose bounding boxes overlap.
+    // Boxes with a non-finite coordinate, NaN included, are compared with
+    // no box: they are neither suppressed nor decayed, and affect no other
+    // box.
+    // Boxes with a NaN score are dropped, and the result is empty if
+    // scores and boxes differ in size.
+    std::vector<int> nmsRotated(const std::vector<Quad> &boxes,
+                                const std::vector<float> &scores,
+                                const double thresh);
+    std::vector<int> nmsRotatedEx(const std::vector<Vertexes> &boxes,
+                                  const std::vector<float> &scores,
+                                  const double thresh);
+
+    // Soft-NMS: repeatedly keep the box of highest score and decay the
+    // scores of the boxes overlapping it, dropping boxes whose score falls
+    // below scoreThresh.
+    // Returns the kept indexes in the order they were kept, and their
+    // decayed scores in keptScores if given. The boxes are handled as by
+    // nmsRotated, and a NaN scoreThresh keeps no box.
+    std::vector<int> softNmsRotated(const std::vector<Quad> &boxes,
+                                    const std::vector<float> &scores,
+                                    const SoftNMSMethod method,
+                                    const double thresh,
+                                    const double sigma = 0.5,
+                                    const double scoreThresh = 0.001,
+                                    std::vector<float> *keptScores = 0);
+    std::vector<int> softNmsRotatedEx(const std::vector<Vertexes> &boxes,
+                                      const std::vector<float> &scores,
+                                      const SoftNMSMethod method,
+                                      const double thresh,
+                                      const double sigma = 0.5,
+                                      const double scoreThresh = 0.001,
+                                      std::vector<float> *keptScores = 0);
+}
+#endif // !_IOU_NMS_H_FILE_
@@ -0,0 +1,236 @@
+/***********************************
+ * polyfile.cpp
+ *
+ * Binary polygon dataset file, written once
+ * and memory-mapped for zero-copy reading.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "polyfile.h"
+#include "fileio.h"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace IOU
+{
+
+static_assert(sizeof(Point) == 2 * sizeof(double) && sizeof(AABB) == 4 * sizeof(double),
+              "Polygon files map Point and AABB straight from their doubles.");
+
+namespace
+{
+
+using namespace fileio;
+
+const char PolygonFileMagic[8] = { 'I', 'O', 'U', 'P', 'O', 'L', 'Y', '\0' };
+
+} // namespace
+
+bool writePolygonFile(const std::string &path, const std::vector<Vertexes> &polys,
+                      const unsigned int flags)
+{
+    const uint64_t count = polys.size();
+    std::vector<uint64_t> offsets(count + 1);
+    offsets[0] = 0;
+    for (uint64_t i = 0; i < count; ++i)
+        offsets[i + 1] = offsets[i] + polys[i].size();
+
+    PolygonFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PolygonFileMagic, sizeof(header.magic));
+    header.version = PolygonFileVersion;
+    header.flags = flags & (PolygonFileBounds | PolygonFileAreas);
+    header.byteOrder = PolygonFileByteOrder;
+    header.count = count;
+    header.vertexCount = offsets[count];
+    header.offsetsPos = align8(sizeof(header));
+    header.vertexesPos = header.offsetsPos + align8((count + 1) * sizeof(uint64_t));
+    uint64_t end = header.vertexesPos + align8(header.vertexCount * sizeof(Point));
+    if (header.flags & PolygonFileBounds) {
+        header.boundsPos = end;
+        end += align8(count * sizeof(AABB));
+    }
+    if (header.flags & PolygonFileAreas)
+        header.areasPos = end;
+
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (f == 0)
+        return false;
+    bool ok = writeAligned(f, &header, sizeof(header)) &&
+              writeAligned(f, offsets.data(), offsets.size() * sizeof(uint64_t));
+    for (uint64_t i = 0; ok && i < count; ++i) {
+        const size_t n = polys[i].size() * sizeof(Point);
+        ok = n == 0 || std::fwrite(polys[i].data(), 1, n, f) == n;
+    }
+    // Points are 16 bytes, the vertex section needs no padding.
+    if (ok && (header.flags & PolygonFileBounds)) {
+        std::vector<AABB> bounds(count);
+        for (uint64_t i = 0; i < count; ++i)
+            bounds[i] = boundingBoxEx(polys[i]);
+        ok = writeAligned(f, bounds.data(), bounds.size() * sizeof(AABB));
+    }
+    if (ok && (header.flags & PolygonFileAreas)) {
+        std::vector<double> areas(count);
+        for (uint64_t i = 0; i < count; ++i)
+            areas[i] = whichWiseEx(polys[i]) == NoneWise ? -1.0 : areaEx(polys[i]);
+        ok = writeAligned(f, areas.data(), areas.size() * sizeof(double));
+    }
+    if (std::fclose(f) != 0)
+        ok = false;
+    return ok;
+}
+
+PolygonFile::PolygonFile()
+    : base(0), mappedSize(0),
+#ifdef _WIN32
+      fileHandle(INVALID_HANDLE_VALUE), mapHandle(0),
+#endif
+      count(0), offsets(0), vert(0), bounds(0), areas(0)
+{
+}
+PolygonFile::PolygonFile(const std::string &path)
+    : base(0), mappedSize(0),
+#ifdef _WIN32
+      fileHandle(INVALID_HANDLE_VALUE), mapHandle(0),
+#endif
+      count(0), offsets(0), vert(0), bounds(0), areas(0)
+{
+    open(path);
+}
+PolygonFile::~PolygonFile()
+{
+    close();
+}
+
+bool PolygonFile::open(const std::string &path)
+{
+    close();
+    uint64_t fileSize = 0;
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart <= 0) {
+        close();
+        return false;
+    }
+    fileSize = size.QuadPart;
+    mapHandle = CreateFileMappingA(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    if (mapHandle == 0) {
+        close();
+        return false;
+    }
+    base = static_cast<const char *>(MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0));
+    if (base == 0) {
+        close();
+        return false;
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    fileSize = st.st_size;
+    void *p = mmap(0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    base = static_cast<const char *>(p);
+#endif
+    mappedSize = fileSize;
+
+    if (!validate(fileSize)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PolygonFile::close()
+{
+#ifdef _WIN32
+    if (base != 0)
+        UnmapViewOfFile(base);
+    if (mapHandle != 0)
+        CloseHandle(mapHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+    fileHandle = INVALID_HANDLE_VALUE;
+    mapHandle = 0;
+#else
+    if (base != 0)
+        munmap(const_cast<char *>(base), mappedSize);
+#endif
+    base = 0;
+    mappedSize = 0;
+    count = 0;
+    offsets = 0;
+    vert = 0;
+    bounds = 0;
+    areas = 0;
+}
+
+// Check the header and that every section, and every polygon, lies in
+// the file, then point into the mapping.
+bool PolygonFile::validate(const uint64_t fileSize)
+{
+    if (fileSize < sizeof(PolygonFileHeader))
+        return false;
+    PolygonFileHeader h;
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, PolygonFileMagic, sizeof(h.magic)) != 0 ||
+        h.version != PolygonFileVersion || h.byteOrder != PolygonFileByteOrder)
+        return false;
+    if (h.count >= (uint64_t)std::numeric_limits<int>::max() ||
+        h.vertexCount > fileSize / sizeof(Point))
+        return false;
+
+    if (!sectionFits(h.offsetsPos, (h.count + 1) * sizeof(uint64_t), fileSize) ||
+        !sectionFits(h.vertexesPos, h.vertexCount * sizeof(Point), fileSize))
+        return false;
+    if ((h.flags & PolygonFileBounds) &&
+        !sectionFits(h.boundsPos, h.count * sizeof(AABB), fileSize))
+        return false;
+    if ((h.flags & PolygonFileAreas) &&
+        !sectionFits(h.areasPos, h.count * sizeof(double), fileSize))
+        return false;
+
+    const uint64_t *off = reinterpret_cast<const uint64_t *>(base + h.offsetsPos);
+    if (off[0] != 0 || off[h.count] != h.vertexCount)
+        return false;
+    for (uint64_t i = 0; i < h.count; ++i) {
+        if (off[i + 1] < off[i] ||
+            off[i + 1] - off[i] > (uint64_t)std::numeric_limits<int>::max())
+            return false;
+    }
+
+    count = h.count;
+    offsets = off;
+    vert = reinterpret_cast<const Point *>(base + h.vertexesPos);
+    bounds = (h.flags & PolygonFileBounds) ?
+        reinterpret_cast<const AABB *>(base + h.boundsPos) : 0;
+    areas = (h.flags & PolygonFileAreas) ?
+        reinterpret_cast<const double *>(base + h.areasPos) : 0;
+    return true;
+}
+
+}
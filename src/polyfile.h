@@ -0,0 +1,108 @@
+/***********************************
+ * polyfile.h
+ *
+ * Binary polygon dataset file, written once
+ * and memory-mapped for zero-copy reading.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_POLYFILE_H_FILE_
+#define _IOU_POLYFILE_H_FILE_
+
+#include "iou.h"
+#include <stdint.h>
+#include <string>
+
+namespace IOU
+{
+    // Optional sections of a polygon file.
+    enum PolygonFileFlag
+    {
+        PolygonFileBounds = 1,  // Bounding box of every polygon.
+        PolygonFileAreas  = 2   // Area of every polygon, -1 if invalid.
+    };
+    const uint32_t PolygonFileVersion = 2;
+    // Written in the byte order of the host: a file is mapped as it is, so
+    // open rejects one written by a host of the other byte order, on which
+    // this reads 0x0807060504030201.
+    const uint64_t PolygonFileByteOrder = 0x0102030405060708ULL;
+
+    // Layout of a polygon file, in the byte order of the host that wrote
+    // it, each section starting on a multiple of 8 bytes:
+    //   PolygonFileHeader
+    //   uint64_t offsets[count+1]   first vertex of every polygon, then
+    //                               vertexCount
+    //   double vertexes[2*vertexCount]  x0 y0 x1 y1 ...
+    //   AABB bounds[count]          if flags & PolygonFileBounds
+    //   double areas[count]         if flags & PolygonFileAreas
+    // Positions are byte offsets from the start of the file, 0 for an
+    // absent section.
+    struct PolygonFileHeader {
+        char magic[8];          // "IOUPOLY" and a null.
+        uint32_t version;
+        uint32_t flags;
+        uint64_t byteOrder;     // PolygonFileByteOrder.
+        uint64_t count;
+        uint64_t vertexCount;
+        uint64_t offsetsPos;
+        uint64_t vertexesPos;
+        uint64_t boundsPos;
+        uint64_t areasPos;
+    };
+
+    // Write polys to path. Returns false if the file cannot be written.
+    bool writePolygonFile(const std::string &path, const std::vector<Vertexes> &polys,
+                          const unsigned int flags = PolygonFileBounds | PolygonFileAreas);
+
+    // Polygon file mapped in memory: polygons are views into the mapping,
+    // valid until the file is closed.
+    class PolygonFile {
+    public:
+        // Constructors.
+        PolygonFile();
+        explicit PolygonFile(const std::string &path);
+        ~PolygonFile();
+
+        // Map path, after closing any file already open.
+        // Returns false, with the file closed, if path cannot be mapped or
+        // is not a valid polygon file of this version and byte order.
+        bool open(const std::string &path);
+        void close();
+        bool isOpen() const { return base != 0; }
+
+        // Methods.
+        int size() const { return count; }
+        PolygonView polygon(const int i) const {
+            assert(i < count);
+            return PolygonView(vert + offsets[i], int(offsets[i+1] - offsets[i]));
+        }
+        bool hasBounds() const { return bounds != 0; }
+        const AABB& boundingBox(const int i) const { assert(bounds && i < count); return bounds[i]; }
+        bool hasAreas() const { return areas != 0; }
+        double area(const int i) const { assert(areas && i < count); return areas[i]; }
+        // All the vertexes, polygon i being vertexes()[offsets()[i]] to
+        // vertexes()[offsets()[i+1]-1].
+        const Point* vertexes() const { return vert; }
+        const uint64_t* vertexOffsets() const { return offsets; }
+
+    private:
+        PolygonFile(const PolygonFile &);
+        PolygonFile& operator=(const PolygonFile &);
+
+        bool validate(const uint64_t fileSize);
+
+        const char *base;
+        uint64_t mappedSize;
+#ifdef _WIN32
+        void *fileHandle;
+        void *mapHandle;
+#endif
+        int count;
+        const uint64_t *offsets;
+        const Point *vert;
+        const AABB *bounds;
+        const double *areas;
+    };
+}
+#endif // !_IOU_POLYFILE_H_FILE_
@@ -0,0 +1,113 @@
+/***********************************
+ * predicates.cpp
+ *
+ * Orientation predicate with an exact sign,
+ * after Shewchuk's adaptive predicates.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "predicates.h"
+#include <cfloat>
+#include <cmath>
+
+namespace IOU
+{
+
+namespace
+{
+
+// Relative error bound of the floating-point determinant,
+// (3 + 16 eps) eps with eps half the unit in the last place of 1.
+const double Epsilon = DBL_EPSILON / 2.0;
+const double OrientErrBound = (3.0 + 16.0 * Epsilon) * Epsilon;
+
+// x + y == a + b exactly, with x the rounded sum.
+inline void twoSum(const double a, const double b, double &x, double &y)
+{
+    x = a + b;
+    const double bv = x - a;
+    const double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+// x + y == a * b exactly, with x the rounded product.
+inline void twoProduct(const double a, const double b, double &x, double &y)
+{
+    x = a * b;
+    y = std::fma(a, b, -x);
+}
+// Add b to the expansion e of n nonoverlapping components of increasing
+// magnitude, dropping zero components. Returns the new size.
+int growExpansion(double *e, const int n, const double b)
+{
+    double Q = b;
+    int m = 0;
+    for (int i = 0; i < n; ++i) {
+        double h;
+        twoSum(Q, e[i], Q, h);
+        if (h != 0.0)
+            e[m++] = h;
+    }
+    if (Q != 0.0)
+        e[m++] = Q;
+    return m;
+}
+
+// The determinant expanded over the six products of coordinates, each
+// exact as two doubles, and summed without error. The largest component
+// of the expansion has the sign of the whole sum.
+double orient2dExact(const Point &a, const Point &b, const Point &c)
+{
+    const double terms[6][2] = {
+        {  a.x, b.y }, { -a.x, c.y }, { -c.x, b.y },
+        { -a.y, b.x }, {  a.y, c.x }, {  c.y, b.x }
+    };
+    double e[24];
+    int n = 0;
+    for (int k = 0; k < 6; ++k) {
+        double hi, lo;
+        twoProduct(terms[k][0], terms[k][1], hi, lo);
+        n = growExpansion(e, n, lo);
+        n = growExpansion(e, n, hi);
+    }
+    // Smallest first: the rounded sum keeps the sign of the largest.
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i)
+        sum += e[i];
+    return sum;
+}
+
+} // namespace
+
+double orient2d(const Point &a, const Point &b, const Point &c)
+{
+    const double detLeft = (a.x - c.x) * (b.y - c.y);
+    const double detRight = (a.y - c.y) * (b.x - c.x);
+    const double det = detLeft - detRight;
+
+    // Terms of different signs, or a zero term: the sign is right.
+    double detSum;
+    if (detLeft > 0.0) {
+        if (detRight <= 0.0)
+            return det;
+        detSum = detLeft + detRight;
+    }
+    else if (detLeft < 0.0) {
+        if (detRight >= 0.0)
+            return det;
+        detSum = -detLeft - detRight;
+    }
+    else
+        return det;
+
+    const double errBound = OrientErrBound * detSum;
+    if (det >= errBound || -det >= errBound)
+        return det;
+    return orient2dExact(a, b, c);
+}
+double orient2d(const Pointf &a, const Pointf &b, const Pointf &c)
+{
+    return orient2d(Point(a.x, a.y), Point(b.x, b.y), Point(c.x, c.y));
+}
+
+}
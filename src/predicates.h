@@ -0,0 +1,26 @@
+/***********************************
+ * predicates.h
+ *
+ * Orientation predicate with an exact sign,
+ * after Shewchuk's adaptive predicates.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_PREDICATES_H_FILE_
+#define _IOU_PREDICATES_H_FILE_
+
+#include "iou.h"
+
+namespace IOU
+{
+    // Twice the signed area of the triangle a, b, c: positive when they
+    // turn anticlockwise, negative when clockwise, 0 when collinear.
+    // The sign is exact. The value is the plain floating-point one unless
+    // it is too close to 0, then it is the exact one rounded, so that
+    // ordinary inputs cost a few more operations than a cross product.
+    double orient2d(const Point &a, const Point &b, const Point &c);
+    // Single precision points, computed in double precision.
+    double orient2d(const Pointf &a, const Pointf &b, const Pointf &c);
+}
+#endif // !_IOU_PREDICATES_H_FILE_
@@ -0,0 +1,176 @@
+/***********************************
+ * rect.cpp
+ *
+ * Axis-aligned and rotated rectangles,
+ * with dedicated iou calculation.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "rect.h"
+#include <algorithm>
+#include <cmath>
+
+namespace IOU
+{
+
+namespace
+{
+
+// A convex polygon clipped by 4 half-planes keeps at most 8 vertexes,
+// twice that leaves room for rounding near the clipping lines.
+typedef SmallPolygon<16> RectClipVert;
+
+// Keep the part of in where s*p[k] <= bound.
+// Returns false if out overflows.
+bool clipAxis(const RectClipVert &in, const int k, const double s,
+              const double bound, RectClipVert &out)
+{
+    out.clear();
+    const int N = in.size();
+    if (N == 0)
+        return true;
+    Point prev = in[N-1];
+    double dPrev = bound - s*prev[k];
+    for (int i = 0; i < N; ++i) {
+        const Point &cur = in[i];
+        const double dCur = bound - s*cur[k];
+        if ((dPrev < 0.0 && dCur > 0.0) || (dPrev > 0.0 && dCur < 0.0))
+            out.push_back(prev + (cur - prev)*(dPrev/(dPrev - dCur)));
+        if (dCur >= 0.0)
+            out.push_back(cur);
+        prev = cur;
+        dPrev = dCur;
+    }
+    return !out.overflowed();
+}
+
+double shoelace(const RectClipVert &C)
+{
+    const int N = C.size();
+    double s = 0.0;
+    for (int i = 0; i < N; ++i)
+        s += C[i] ^ C[(i+1)%N];
+    return std::fabs(s) * 0.5;
+}
+
+// Whether a rectangle has no area. NaN sizes count.
+inline bool isEmpty(const Rect &R)
+{
+    return !(R.x2 > R.x1 && R.y2 > R.y1);
+}
+inline bool isEmpty(const RotatedRect &R)
+{
+    return !(R.w > 0.0 && R.h > 0.0);
+}
+
+// Overlap of [c1-e1,c1+e1] and [c2-e2,c2+e2].
+inline double overlap1D(const double c1, const double e1,
+                        const double c2, const double e2)
+{
+    return std::max(0.0, std::min(c1 + e1, c2 + e2) - std::max(c1 - e1, c2 - e2));
+}
+
+} // namespace
+
+Quad Rect::toQuad() const
+{
+    return Quad(Point(x1, y1), Point(x1, y2), Point(x2, y2), Point(x2, y1));
+}
+
+AABB RotatedRect::boundingBox() const
+{
+    const double c = std::fabs(std::cos(theta));
+    const double s = std::fabs(std::sin(theta));
+    const double ex = (c*w + s*h) / 2.0;
+    const double ey = (s*w + c*h) / 2.0;
+    return AABB(center.x - ex, center.y - ey, center.x + ex, center.y + ey);
+}
+Quad RotatedRect::toQuad() const
+{
+    const double c = std::cos(theta);
+    const double s = std::sin(theta);
+    const Point u = Point(c, s) * (w / 2.0);
+    const Point v = Point(-s, c) * (h / 2.0);
+    return Quad(center - u - v, center - u + v, center + u + v, center + u - v);
+}
+void RotatedRect::getVertList(Vertexes &_vert) const
+{
+    toQuad().getVertList(_vert);
+}
+
+double areaIntersection(const Rect &R1, const Rect &R2)
+{
+    if (isEmpty(R1) || isEmpty(R2))
+        return -1.0;
+    const double w = std::min(R1.x2, R2.x2) - std::max(R1.x1, R2.x1);
+    const double h = std::min(R1.y2, R2.y2) - std::max(R1.y1, R2.y1);
+    return (w > 0.0 && h > 0.0) ? w * h : 0.0;
+}
+double areaUnion(const Rect &R1, const Rect &R2)
+{
+    const double inter = areaIntersection(R1, R2);
+    return inter < 0.0 ? -1.0 : R1.area() + R2.area() - inter;
+}
+double iou(const Rect &R1, const Rect &R2)
+{
+    const double inter = areaIntersection(R1, R2);
+    return inter < 0.0 ? -1.0 : inter / (R1.area() + R2.area() - inter);
+}
+
+double areaIntersection(const RotatedRect &R1, const RotatedRect &R2)
+{
+    if (isEmpty(R1) || isEmpty(R2))
+        return -1.0;
+
+    // Frame of R1: its center at the origin, its w side along x.
+    const double c1 = std::cos(R1.theta);
+    const double s1 = std::sin(R1.theta);
+    const Point d = R2.center - R1.center;
+    const Point o(d.x*c1 + d.y*s1, -d.x*s1 + d.y*c1);
+    const double a = R1.w / 2.0;
+    const double b = R1.h / 2.0;
+
+    // R2 in that frame, and its half extents along x and y.
+    const double phi = R2.theta - R1.theta;
+    const double c = std::cos(phi);
+    const double s = std::sin(phi);
+    const double ex = (std::fabs(c)*R2.w + std::fabs(s)*R2.h) / 2.0;
+    const double ey = (std::fabs(s)*R2.w + std::fabs(c)*R2.h) / 2.0;
+
+    // Separated along the axes of R1.
+    if (std::fabs(o.x) >= a + ex || std::fabs(o.y) >= b + ey)
+        return 0.0;
+    // Edges exactly parallel to those of R1. A small angle is left to the
+    // clipping: the bounding extents ex and ey would overestimate, and the
+    // half sizes would be off by the tilt, along a long side.
+    if (s == 0.0)
+        return overlap1D(0.0, a, o.x, R2.w / 2.0) * overlap1D(0.0, b, o.y, R2.h / 2.0);
+    if (c == 0.0)
+        return overlap1D(0.0, a, o.x, R2.h / 2.0) * overlap1D(0.0, b, o.y, R2.w / 2.0);
+
+    const Point u = Point(c, s) * (R2.w / 2.0);
+    const Point v = Point(-s, c) * (R2.h / 2.0);
+    RectClipVert buf1, buf2;
+    buf1.push_back(o - u - v);
+    buf1.push_back(o - u + v);
+    buf1.push_back(o + u + v);
+    buf1.push_back(o + u - v);
+    if (clipAxis(buf1, 0,  1.0, a, buf2) && clipAxis(buf2, 0, -1.0, a, buf1) &&
+        clipAxis(buf1, 1,  1.0, b, buf2) && clipAxis(buf2, 1, -1.0, b, buf1))
+        return shoelace(buf1);
+    // Rounding near the clipping lines overflowed the buffers.
+    return areaIntersection(R1.toQuad(), R2.toQuad(), ConvexClip);
+}
+double areaUnion(const RotatedRect &R1, const RotatedRect &R2)
+{
+    const double inter = areaIntersection(R1, R2);
+    return inter < 0.0 ? -1.0 : R1.area() + R2.area() - inter;
+}
+double iou(const RotatedRect &R1, const RotatedRect &R2)
+{
+    const double inter = areaIntersection(R1, R2);
+    return inter < 0.0 ? -1.0 : inter / (R1.area() + R2.area() - inter);
+}
+
+}
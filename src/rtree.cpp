@@ -0,0 +1,320 @@
+/***********************************
+ * rtree.cpp
+ *
+ * Static packed R-tree over convex polygons,
+ * answering iou threshold and top-k queries.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "rtree.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace IOU
+{
+
+namespace
+{
+
+struct CenterLess
+{
+    CenterLess(const std::vector<AABB> &_boxes, const int _k)
+        : boxes(_boxes), k(_k) {}
+    bool operator()(const int a, const int b) const {
+        return boxes[a].center()[k] < boxes[b].center()[k];
+    }
+    const std::vector<AABB> &boxes;
+    int k;
+};
+
+// Sort-Tile-Recursive order of boxes for nodes of nodeSize children:
+// sort by center x, cut into vertical slices of about sqrt(nodes) nodes
+// each, and sort every slice by center y.
+std::vector<int> strOrder(const std::vector<AABB> &boxes, const int nodeSize)
+{
+    const int N = boxes.size();
+    std::vector<int> order(N);
+    for (int i = 0; i < N; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), CenterLess(boxes, 0));
+    if (N == 0)
+        return order;
+
+    const int nNodes = (N + nodeSize - 1) / nodeSize;
+    const int nSlices = (int)std::ceil(std::sqrt((double)nNodes));
+    const int sliceSize = ((nNodes + nSlices - 1) / nSlices) * nodeSize;
+    for (int first = 0; first < N; first += sliceSize) {
+        const int last = std::min(first + sliceSize, N);
+        std::sort(order.begin() + first, order.begin() + last, CenterLess(boxes, 1));
+    }
+    return order;
+}
+
+AABB unite(const AABB &a, const AABB &b)
+{
+    return AABB(std::min(a.xMin, b.xMin), std::min(a.yMin, b.yMin),
+                std::max(a.xMax, b.xMax), std::max(a.yMax, b.yMax));
+}
+
+struct Scored
+{
+    double iou;
+    int id;
+};
+// Higher iou first, then lower index: the top of a heap ordered by it
+// is the worst of the k best kept.
+struct ScoredBetter
+{
+    bool operator()(const Scored &a, const Scored &b) const {
+        return a.iou > b.iou || (a.iou == b.iou && a.id < b.id);
+    }
+};
+
+AABB queryBox(const Vertexes &query) { return boundingBoxEx(query); }
+AABB queryBox(const Quad &query) { return query.boundingBox(); }
+double queryArea(const Vertexes &query) {
+    return whichWiseEx(query) == NoneWise ? -1.0 : areaEx(query); }
+double queryArea(const Quad &query) {
+    return query.whichWise() == NoneWise ? -1.0 : query.area(); }
+
+} // namespace
+
+PolygonRTree::PolygonRTree()
+{
+}
+PolygonRTree::PolygonRTree(const std::vector<Vertexes> &polys, const int nodeSize)
+{
+    build(polys, nodeSize);
+}
+PolygonRTree::PolygonRTree(const std::vector<Quad> &quads, const int nodeSize)
+{
+    build(quads, nodeSize);
+}
+
+void PolygonRTree::build(const std::vector<Vertexes> &polys, const int nodeSize)
+{
+    const int N = polys.size();
+    std::vector<AABB> itemBoxes(N);
+    for (int i = 0; i < N; ++i)
+        itemBoxes[i] = boundingBoxEx(polys[i]);
+    build(itemBoxes, nodeSize);
+
+    areas.resize(N);
+    vertStart.resize(N + 1);
+    vertStart[0] = 0;
+    for (int i = 0; i < N; ++i) {
+        const Vertexes &C = polys[ids[i]];
+        areas[i] = queryArea(C);
+        vertStart[i + 1] = vertStart[i] + C.size();
+    }
+    vert.resize(vertStart[N]);
+    for (int i = 0; i < N; ++i)
+        std::copy(polys[ids[i]].begin(), polys[ids[i]].end(), vert.begin() + vertStart[i]);
+}
+void PolygonRTree::build(const std::vector<Quad> &quads, const int nodeSize)
+{
+    const int N = quads.size();
+    std::vector<AABB> itemBoxes(N);
+    for (int i = 0; i < N; ++i)
+        itemBoxes[i] = quads[i].boundingBox();
+    build(itemBoxes, nodeSize);
+
+    areas.resize(N);
+    vertStart.resize(N + 1);
+    vert.resize(4 * N);
+    for (int i = 0; i < N; ++i) {
+        const Quad &Q = quads[ids[i]];
+        areas[i] = queryArea(Q);
+        vertStart[i] = 4 * i;
+        std::copy(Q.data(), Q.data() + 4, vert.begin() + 4 * i);
+    }
+    vertStart[N] = 4 * N;
+}
+void PolygonRTree::build(const std::vector<AABB> &itemBoxes, const int nodeSize)
+{
+    const int B = std::max(nodeSize, 2);
+    const int N = itemBoxes.size();
+    nodes.clear();
+    levelStart.assign(1, 0);
+
+    // Leaves, over the items in STR order.
+    ids = strOrder(itemBoxes, B);
+    boxes.resize(N);
+    for (int i = 0; i < N; ++i)
+        boxes[i] = itemBoxes[ids[i]];
+    for (int first = 0; first < N; first += B) {
+        RTreeNode node;
+        node.first = first;
+        node.count = std::min(B, N - first);
+        node.box = boxes[first];
+        for (int i = first + 1; i < first + node.count; ++i)
+            node.box = unite(node.box, boxes[i]);
+        nodes.push_back(node);
+    }
+    levelStart.push_back(nodes.size());
+
+    // Upper levels, each over the nodes of the level below in STR order,
+    // until a single root is left.
+    while (levelStart.back() - levelStart[levelStart.size() - 2] > 1) {
+        const int begin = levelStart[levelStart.size() - 2];
+        const int end = levelStart.back();
+        std::vector<AABB> childBoxes(end - begin);
+        for (int i = begin; i < end; ++i)
+            childBoxes[i - begin] = nodes[i].box;
+        const std::vector<int> order = strOrder(childBoxes, B);
+        std::vector<RTreeNode> children(nodes.begin() + begin, nodes.begin() + end);
+        for (int i = begin; i < end; ++i)
+            nodes[i] = children[order[i - begin]];
+
+        for (int first = begin; first < end; first += B) {
+            RTreeNode node;
+            node.first = first;
+            node.count = std::min(B, end - first);
+            node.box = nodes[first].box;
+            for (int i = first + 1; i < first + node.count; ++i)
+                node.box = unite(node.box, nodes[i].box);
+            nodes.push_back(node);
+        }
+        levelStart.push_back(nodes.size());
+    }
+}
+
+AABB PolygonRTree::bounds() const
+{
+    return nodes.empty() ? AABB() : nodes.back().box;
+}
+
+template <class Func>
+void PolygonRTree::forEachOverlapping(const AABB &box, Func f) const
+{
+    if (nodes.empty())
+        return;
+    const int nLeaves = levelStart[1];
+    std::vector<int> stack(1, nodes.size() - 1);
+    while (!stack.empty()) {
+        const RTreeNode &node = nodes[stack.back()];
+        const bool leaf = stack.back() < nLeaves;
+        stack.pop_back();
+        if (!node.box.overlaps(box))
+            continue;
+        for (int i = node.first; i < node.first + node.count; ++i) {
+            if (leaf) {
+                if (boxes[i].overlaps(box))
+                    f(i);
+            }
+            else if (nodes[i].box.overlaps(box))
+                stack.push_back(i);
+        }
+    }
+}
+
+std::vector<int> PolygonRTree::overlapping(const AABB &box) const
+{
+    std::vector<int> result;
+    forEachOverlapping(box, [&](const int i) { result.push_back(ids[i]); });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+double PolygonRTree::iouItem(const Vertexes &query, const int item,
+                             const InterMethod method) const
+{
+    const PolygonView C(&vert[vertStart[item]], vertStart[item + 1] - vertStart[item]);
+    return iouEx(PolygonView(query), C, method);
+}
+double PolygonRTree::iouItem(const Quad &query, const int item,
+                             const InterMethod method) const
+{
+    const int n = vertStart[item + 1] - vertStart[item];
+    if (n == 4)
+        return iou(query, Quad(&vert[vertStart[item]]), method);
+    return iouEx(PolygonView(query.data(), 4), PolygonView(&vert[vertStart[item]], n), method);
+}
+
+template <class Query>
+std::vector<int> PolygonRTree::queryAboveT(const Query &query, const double thresh,
+                                           const InterMethod method) const
+{
+    std::vector<int> result;
+    const double area = queryArea(query);
+    if (area < 0.0)
+        return result;
+    const AABB box = queryBox(query);
+    forEachOverlapping(box, [&](const int i) {
+        if (areas[i] < 0.0 || iouBound(box, area, boxes[i], areas[i]) <= thresh)
+            return;
+        if (iouItem(query, i, method) > thresh)
+            result.push_back(ids[i]);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+std::vector<int> PolygonRTree::queryAbove(const Vertexes &query, const double thresh,
+                                          const InterMethod method) const
+{
+    return queryAboveT(query, thresh, method);
+}
+std::vector<int> PolygonRTree::queryAbove(const Quad &query, const double thresh,
+                                          const InterMethod method) const
+{
+    return queryAboveT(query, thresh, method);
+}
+
+template <class Query>
+std::vector<int> PolygonRTree::topKT(const Query &query, const int k,
+                                     std::vector<double> *ious,
+                                     const InterMethod method) const
+{
+    std::priority_queue<Scored, std::vector<Scored>, ScoredBetter> best;
+    const double area = queryArea(query);
+    if (area >= 0.0 && k > 0) {
+        const AABB box = queryBox(query);
+        forEachOverlapping(box, [&](const int i) {
+            if (areas[i] < 0.0)
+                return;
+            // Only candidates that may beat the k-th best so far.
+            const double floor = ((int)best.size() < k) ? 0.0 : best.top().iou;
+            if (iouBound(box, area, boxes[i], areas[i]) < floor)
+                return;
+            Scored s;
+            s.iou = iouItem(query, i, method);
+            s.id = ids[i];
+            if (!(s.iou > 0.0))
+                return;
+            if ((int)best.size() < k)
+                best.push(s);
+            else if (ScoredBetter()(s, best.top())) {
+                best.pop();
+                best.push(s);
+            }
+        });
+    }
+
+    const int n = best.size();
+    std::vector<int> result(n);
+    if (ious != 0)
+        ious->resize(n);
+    for (int i = n - 1; i >= 0; --i) {
+        result[i] = best.top().id;
+        if (ious != 0)
+            (*ious)[i] = best.top().iou;
+        best.pop();
+    }
+    return result;
+}
+std::vector<int> PolygonRTree::topK(const Vertexes &query, const int k,
+                                    std::vector<double> *ious,
+                                    const InterMethod method) const
+{
+    return topKT(query, k, ious, method);
+}
+std::vector<int> PolygonRTree::topK(const Quad &query, const int k,
+                                    std::vector<double> *ious,
+                                    const InterMethod method) const
+{
+    return topKT(query, k, ious, method);
+}
+
+}
@@ -0,0 +1,96 @@
+/***********************************
+ * rtree.h
+ *
+ * Static packed R-tree over convex polygons,
+ * answering iou threshold and top-k queries.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_RTREE_H_FILE_
+#define _IOU_RTREE_H_FILE_
+
+#include "iou.h"
+
+namespace IOU
+{
+    // Node of a packed R-tree: the bounding box of its children, which
+    // are items first to first+count-1 for a leaf and nodes otherwise.
+    struct RTreeNode {
+        AABB box;
+        int first;
+        int count;
+    };
+
+    // Packed R-tree over the bounding boxes of a static set of convex
+    // polygons, bulk loaded with Sort-Tile-Recursive.
+    // Nodes are stored level by level from the leaves up, the root last,
+    // and the polygons in leaf order, every array being contiguous.
+    // Queries compute the iou of a polygon only when its bounding box
+    // overlaps that of the query, and when the bound on the iou given by
+    // the bounding boxes and the areas does not rule it out.
+    // Invalid polygons are kept, so that indexes match the input, but
+    // never returned.
+    class PolygonRTree {
+    public:
+        // Constructors.
+        PolygonRTree();
+        explicit PolygonRTree(const std::vector<Vertexes> &polys, const int nodeSize = 16);
+        explicit PolygonRTree(const std::vector<Quad> &quads, const int nodeSize = 16);
+
+        // Methods.
+        void build(const std::vector<Vertexes> &polys, const int nodeSize = 16);
+        void build(const std::vector<Quad> &quads, const int nodeSize = 16);
+        int size() const { return ids.size(); }
+        bool empty() const { return ids.empty(); }
+        // Bounding box of all the polygons.
+        AABB bounds() const;
+
+        // Indexes of the polygons whose bounding box overlaps box,
+        // in ascending order.
+        std::vector<int> overlapping(const AABB &box) const;
+        // Indexes of the polygons whose iou with query is above thresh,
+        // in ascending order.
+        std::vector<int> queryAbove(const Vertexes &query, const double thresh,
+                                    const InterMethod method = PointSoup) const;
+        std::vector<int> queryAbove(const Quad &query, const double thresh,
+                                    const InterMethod method = PointSoup) const;
+        // Indexes of the k polygons of highest positive iou with query,
+        // by decreasing iou then ascending index, and their ious if given.
+        std::vector<int> topK(const Vertexes &query, const int k,
+                              std::vector<double> *ious = 0,
+                              const InterMethod method = PointSoup) const;
+        std::vector<int> topK(const Quad &query, const int k,
+                              std::vector<double> *ious = 0,
+                              const InterMethod method = PointSoup) const;
+
+    private:
+        void build(const std::vector<AABB> &itemBoxes, const int nodeSize);
+        template <class Func>
+        void forEachOverlapping(const AABB &box, Func f) const;
+        template <class Query>
+        std::vector<int> queryAboveT(const Query &query, const double thresh,
+                                     const InterMethod method) const;
+        template <class Query>
+        std::vector<int> topKT(const Query &query, const int k,
+                               std::vector<double> *ious,
+                               const InterMethod method) const;
+        double iouItem(const Vertexes &query, const int item,
+                       const InterMethod method) const;
+        double iouItem(const Quad &query, const int item,
+                       const InterMethod method) const;
+
+        // Nodes, level by level from the leaves, levelStart[l] being the
+        // first node of level l and levelStart.back() the node count.
+        std::vector<RTreeNode> nodes;
+        std::vector<int> levelStart;
+        // Polygons in leaf order: input index, bounding box, area (-1 if
+        // invalid), and vertexes vert[vertStart[i]] to vert[vertStart[i+1]-1].
+        std::vector<int> ids;
+        std::vector<AABB> boxes;
+        std::vector<double> areas;
+        std::vector<int> vertStart;
+        std::vector<Point> vert;
+    };
+}
+#endif // !_IOU_RTREE_H_FILE_
@@ -0,0 +1,414 @@
+/***********************************
+ * shard.cpp
+ *
+ * Sharded sparse iou join of polygon files:
+ * spatial tiles with halo replication, each
+ * joined on its own, and their merge.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "shard.h"
+#include "fileio.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace IOU
+{
+
+static_assert(sizeof(int) == sizeof(int32_t) && sizeof(AABB) == 4 * sizeof(double),
+              "Plan files store members as int and tiles as AABB.");
+
+namespace
+{
+
+using namespace fileio;
+
+const char ShardPlanMagic[8] = { 'I', 'O', 'U', 'S', 'H', 'R', 'D', '\0' };
+
+// Positions are 64-bit: long is 32-bit on Windows, and the members of a
+// plan over hundreds of millions of polygons go beyond 2 GB.
+bool seekTo(std::FILE *f, const uint64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(f, (__int64)pos, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)pos, SEEK_SET) == 0;
+#endif
+}
+bool readAt(std::FILE *f, const uint64_t pos, void *data, const size_t n)
+{
+    return seekTo(f, pos) && (n == 0 || std::fread(data, 1, n, f) == n);
+}
+uint64_t fileSize(std::FILE *f)
+{
+#ifdef _WIN32
+    if (_fseeki64(f, 0, SEEK_END) != 0)
+        return 0;
+    const __int64 size = _ftelli64(f);
+#else
+    if (fseeko(f, 0, SEEK_END) != 0)
+        return 0;
+    const off_t size = ftello(f);
+#endif
+    return size > 0 ? (uint64_t)size : 0;
+}
+
+// Read and check the header of a plan file: magic, version, and every
+// section inside the file.
+bool readHeader(std::FILE *f, ShardPlanHeader &h)
+{
+    const uint64_t size = fileSize(f);
+    if (size < sizeof(h) || !readAt(f, 0, &h, sizeof(h)))
+        return false;
+    if (std::memcmp(h.magic, ShardPlanMagic, sizeof(h.magic)) != 0 ||
+        h.version != ShardPlanVersion || h.byteOrder != PolygonFileByteOrder)
+        return false;
+    if (h.count >= (uint64_t)std::numeric_limits<int>::max() ||
+        h.memberCountA > size / sizeof(int32_t) || h.memberCountB > size / sizeof(int32_t))
+        return false;
+    if (!sectionFits(h.tilesPos, h.count * sizeof(AABB), size) ||
+        !sectionFits(h.offsetsAPos, (h.count + 1) * sizeof(uint64_t), size) ||
+        !sectionFits(h.membersAPos, h.memberCountA * sizeof(int32_t), size))
+        return false;
+    if (!(h.flags & ShardSelfJoin) &&
+        (!sectionFits(h.offsetsBPos, (h.count + 1) * sizeof(uint64_t), size) ||
+         !sectionFits(h.membersBPos, h.memberCountB * sizeof(int32_t), size)))
+        return false;
+    return true;
+}
+// Members of tile t from the offsets at offsetsPos into the members at
+// membersPos, of memberCount in all.
+bool readMembers(std::FILE *f, const uint64_t offsetsPos, const uint64_t membersPos,
+                 const uint64_t memberCount, const int t, std::vector<int> &members)
+{
+    uint64_t range[2];
+    if (!readAt(f, offsetsPos + (uint64_t)t * sizeof(uint64_t), range, sizeof(range)) ||
+        range[1] < range[0] || range[1] > memberCount)
+        return false;
+    members.resize(range[1] - range[0]);
+    return readAt(f, membersPos + range[0] * sizeof(int32_t), members.data(),
+                  members.size() * sizeof(int32_t));
+}
+
+// Quantiles of the values, without repeats: about n-1 cuts splitting them
+// in n parts of the same size.
+std::vector<double> quantileCuts(std::vector<double> &values, const int n)
+{
+    std::sort(values.begin(), values.end());
+    std::vector<double> cuts;
+    const size_t N = values.size();
+    for (int k = 1; k < n && N > 0; ++k) {
+        const double c = values[(size_t)((double)k * N / n)];
+        if (cuts.empty() || c > cuts.back())
+            cuts.push_back(c);
+    }
+    return cuts;
+}
+// Interval k of those split at cuts: values v with cuts[k-1] <= v < cuts[k].
+inline int intervalOf(const std::vector<double> &cuts, const double v)
+{
+    return std::upper_bound(cuts.begin(), cuts.end(), v) - cuts.begin();
+}
+
+void fileBoxes(const PolygonFile &F, std::vector<AABB> &boxes, std::vector<char> &valid)
+{
+    const int N = F.size();
+    boxes.resize(N);
+    valid.resize(N);
+    for (int i = 0; i < N; ++i) {
+        const PolygonView C = F.polygon(i);
+        boxes[i] = F.hasBounds() ? F.boundingBox(i) : boundingBoxEx(C);
+        valid[i] = F.hasAreas() ? F.area(i) >= 0.0 : whichWiseEx(C) != NoneWise;
+    }
+}
+
+// Views of the members of a tile into the file, and their bounding boxes.
+bool gatherMembers(const PolygonFile &F, const std::vector<int> &members,
+                   std::vector<PolygonView> &polys, std::vector<AABB> &boxes)
+{
+    const int N = members.size();
+    polys.resize(N);
+    boxes.resize(N);
+    for (int k = 0; k < N; ++k) {
+        if (members[k] < 0 || members[k] >= F.size())
+            return false;
+        polys[k] = F.polygon(members[k]);
+        boxes[k] = F.hasBounds() ? F.boundingBox(members[k]) : boundingBoxEx(polys[k]);
+    }
+    return true;
+}
+
+bool pairLess(const IouPair &a, const IouPair &b)
+{
+    return a.i < b.i || (a.i == b.i && a.j < b.j);
+}
+bool pairSame(const IouPair &a, const IouPair &b)
+{
+    return a.i == b.i && a.j == b.j;
+}
+
+} // namespace
+
+ShardPlan::ShardPlan()
+    : self(false)
+{
+}
+
+void ShardPlan::build(const std::vector<AABB> &boxesA, const std::vector<AABB> &boxesB,
+                      const int nTiles)
+{
+    const std::vector<char> validA(boxesA.size(), 1);
+    const std::vector<char> validB(boxesB.size(), 1);
+    build(boxesA, validA, &boxesB, &validB, nTiles);
+}
+void ShardPlan::build(const std::vector<AABB> &boxes, const int nTiles)
+{
+    build(boxes, std::vector<char>(boxes.size(), 1), 0, 0, nTiles);
+}
+void ShardPlan::build(const PolygonFile &A, const PolygonFile &B, const int nTiles)
+{
+    std::vector<AABB> boxesA, boxesB;
+    std::vector<char> validA, validB;
+    fileBoxes(A, boxesA, validA);
+    fileBoxes(B, boxesB, validB);
+    build(boxesA, validA, &boxesB, &validB, nTiles);
+}
+void ShardPlan::build(const PolygonFile &A, const int nTiles)
+{
+    std::vector<AABB> boxes;
+    std::vector<char> valid;
+    fileBoxes(A, boxes, valid);
+    build(boxes, valid, 0, 0, nTiles);
+}
+
+void ShardPlan::build(const std::vector<AABB> &boxesA, const std::vector<char> &validA,
+                      const std::vector<AABB> *boxesB, const std::vector<char> *validB,
+                      const int nTiles)
+{
+    self = boxesB == 0;
+    buildTiles(boxesA, validA, nTiles);
+    assign(boxesA, validA, offsetsA, idsA);
+    if (self) {
+        offsetsB.clear();
+        idsB.clear();
+    }
+    else
+        assign(*boxesB, *validB, offsetsB, idsB);
+}
+
+void ShardPlan::buildTiles(const std::vector<AABB> &boxes, const std::vector<char> &valid,
+                           const int nTiles)
+{
+    const int N = boxes.size();
+    const int nx = std::max(1, (int)(std::sqrt((double)std::max(nTiles, 1)) + 0.5));
+    const int ny = std::max(1, (std::max(nTiles, 1) + nx - 1) / nx);
+
+    std::vector<double> values;
+    for (int i = 0; i < N; ++i) {
+        if (valid[i])
+            values.push_back((boxes[i].xMin + boxes[i].xMax) / 2.0);
+    }
+    cutsX = quantileCuts(values, nx);
+
+    const int slabs = cutsX.size() + 1;
+    std::vector<std::vector<double> > slabValues(slabs);
+    for (int i = 0; i < N; ++i) {
+        if (valid[i]) {
+            const AABB &b = boxes[i];
+            slabValues[intervalOf(cutsX, (b.xMin + b.xMax) / 2.0)].push_back(
+                (b.yMin + b.yMax) / 2.0);
+        }
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    cutsY.resize(slabs);
+    slabStart.assign(1, 0);
+    tiles.clear();
+    for (int s = 0; s < slabs; ++s) {
+        cutsY[s] = quantileCuts(slabValues[s], ny);
+        std::vector<double>().swap(slabValues[s]);
+        const double x0 = s == 0 ? -inf : cutsX[s-1];
+        const double x1 = s == slabs - 1 ? inf : cutsX[s];
+        const int rows = cutsY[s].size() + 1;
+        for (int k = 0; k < rows; ++k) {
+            const double y0 = k == 0 ? -inf : cutsY[s][k-1];
+            const double y1 = k == rows - 1 ? inf : cutsY[s][k];
+            tiles.push_back(AABB(x0, y0, x1, y1));
+        }
+        slabStart.push_back(tiles.size());
+    }
+}
+
+// Every valid box is a member of the tiles [x0, x1) x [y0, y1) where the
+// reference point of one of its pairs may lie: x0 <= xMax, xMin < x1,
+// and the same along y. Counting pass, then filling pass.
+void ShardPlan::assign(const std::vector<AABB> &boxes, const std::vector<char> &valid,
+                       std::vector<uint64_t> &offsets, std::vector<int> &ids) const
+{
+    const int N = boxes.size();
+    const int T = tiles.size();
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 0)
+            offsets.assign(T + 1, 0);
+        std::vector<uint64_t> fill;
+        if (pass == 1) {
+            for (int t = 0; t < T; ++t)
+                offsets[t + 1] += offsets[t];
+            ids.resize(offsets[T]);
+            fill.assign(offsets.begin(), offsets.end() - 1);
+        }
+        for (int i = 0; i < N; ++i) {
+            if (!valid[i])
+                continue;
+            const AABB &b = boxes[i];
+            const int s1 = intervalOf(cutsX, b.xMax);
+            for (int s = intervalOf(cutsX, b.xMin); s <= s1; ++s) {
+                const int k1 = intervalOf(cutsY[s], b.yMax);
+                for (int k = intervalOf(cutsY[s], b.yMin); k <= k1; ++k) {
+                    const int t = slabStart[s] + k;
+                    if (pass == 0)
+                        ++offsets[t + 1];
+                    else
+                        ids[fill[t]++] = i;
+                }
+            }
+        }
+    }
+}
+
+bool ShardPlan::write(const std::string &path) const
+{
+    const uint64_t count = tiles.size();
+    ShardPlanHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ShardPlanMagic, sizeof(header.magic));
+    header.version = ShardPlanVersion;
+    header.flags = self ? ShardSelfJoin : 0;
+    header.byteOrder = PolygonFileByteOrder;
+    header.count = count;
+    header.memberCountA = idsA.size();
+    header.memberCountB = idsB.size();
+    header.tilesPos = align8(sizeof(header));
+    header.offsetsAPos = header.tilesPos + count * sizeof(AABB);
+    header.membersAPos = header.offsetsAPos + (count + 1) * sizeof(uint64_t);
+    if (!self) {
+        header.offsetsBPos = header.membersAPos + align8(idsA.size() * sizeof(int32_t));
+        header.membersBPos = header.offsetsBPos + (count + 1) * sizeof(uint64_t);
+    }
+
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (f == 0)
+        return false;
+    bool ok = writeAligned(f, &header, sizeof(header)) &&
+              writeAligned(f, tiles.data(), tiles.size() * sizeof(AABB)) &&
+              writeAligned(f, offsetsA.data(), offsetsA.size() * sizeof(uint64_t)) &&
+              writeAligned(f, idsA.data(), idsA.size() * sizeof(int32_t));
+    if (ok && !self)
+        ok = writeAligned(f, offsetsB.data(), offsetsB.size() * sizeof(uint64_t)) &&
+             writeAligned(f, idsB.data(), idsB.size() * sizeof(int32_t));
+    if (std::fclose(f) != 0)
+        ok = false;
+    return ok;
+}
+
+void ShardPlan::tile(const int t, ShardTile &out) const
+{
+    assert(t < size());
+    out.box = tiles[t];
+    out.selfJoin = self;
+    out.membersA.assign(idsA.begin() + offsetsA[t], idsA.begin() + offsetsA[t + 1]);
+    if (self)
+        out.membersB.clear();
+    else
+        out.membersB.assign(idsB.begin() + offsetsB[t], idsB.begin() + offsetsB[t + 1]);
+}
+
+int shardTileCount(const std::string &path)
+{
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (f == 0)
+        return -1;
+    ShardPlanHeader h;
+    const bool ok = readHeader(f, h);
+    std::fclose(f);
+    return ok ? (int)h.count : -1;
+}
+
+bool readShardTile(const std::string &path, const int t, ShardTile &tile)
+{
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (f == 0)
+        return false;
+    ShardPlanHeader h;
+    tile.selfJoin = false;
+    tile.membersB.clear();
+    bool ok = readHeader(f, h) && t >= 0 && (uint64_t)t < h.count &&
+              readAt(f, h.tilesPos + (uint64_t)t * sizeof(AABB), &tile.box, sizeof(AABB)) &&
+              readMembers(f, h.offsetsAPos, h.membersAPos, h.memberCountA, t, tile.membersA);
+    if (ok) {
+        tile.selfJoin = (h.flags & ShardSelfJoin) != 0;
+        if (!tile.selfJoin)
+            ok = readMembers(f, h.offsetsBPos, h.membersBPos, h.memberCountB, t,
+                             tile.membersB);
+    }
+    std::fclose(f);
+    return ok;
+}
+
+bool shardJoin(const PolygonFile &A, const PolygonFile &B, const ShardTile &tile,
+               const double thresh, std::vector<IouPair> &pairs,
+               const InterMethod method)
+{
+    pairs.clear();
+    std::vector<PolygonView> polysA, polysB;
+    std::vector<AABB> boxesA, boxesB;
+    if (!gatherMembers(A, tile.membersA, polysA, boxesA) ||
+        (!tile.selfJoin && !gatherMembers(B, tile.membersB, polysB, boxesB)))
+        return false;
+    const std::vector<int> &membersB = tile.selfJoin ? tile.membersA : tile.membersB;
+    const std::vector<PolygonView> &PB = tile.selfJoin ? polysA : polysB;
+    const std::vector<AABB> &BB = tile.selfJoin ? boxesA : boxesB;
+
+    // Keep the pairs whose reference point is in the tile, the outer
+    // tiles closed at infinity so that no pair falls outside every tile.
+    const AABB &box = tile.box;
+    const double inf = std::numeric_limits<double>::infinity();
+    iouJoinEx(polysA, PB, thresh, [&](const IouPair *chunk, const int n) {
+        for (int k = 0; k < n; ++k) {
+            IouPair p = chunk[k];
+            const AABB &a = boxesA[p.i];
+            const AABB &b = BB[p.j];
+            p.i = tile.membersA[p.i];
+            p.j = membersB[p.j];
+            if (tile.selfJoin && p.i >= p.j)
+                continue;
+            const double x = std::max(a.xMin, b.xMin);
+            const double y = std::max(a.yMin, b.yMin);
+            if (box.xMin <= x && (x < box.xMax || box.xMax == inf) &&
+                box.yMin <= y && (y < box.yMax || box.yMax == inf))
+                pairs.push_back(p);
+        }
+    }, 4096, method);
+    std::sort(pairs.begin(), pairs.end(), pairLess);
+    return true;
+}
+
+std::vector<IouPair> mergeShardPairs(const std::vector<std::vector<IouPair> > &parts)
+{
+    size_t n = 0;
+    for (size_t k = 0; k < parts.size(); ++k)
+        n += parts[k].size();
+    std::vector<IouPair> result;
+    result.reserve(n);
+    for (size_t k = 0; k < parts.size(); ++k)
+        result.insert(result.end(), parts[k].begin(), parts[k].end());
+    std::sort(result.begin(), result.end(), pairLess);
+    result.erase(std::unique(result.begin(), result.end(), pairSame), result.end());
+    return result;
+}
+
+}
@@ -0,0 +1,137 @@
+/***********************************
+ * shard.h
+ *
+ * Sharded sparse iou join of polygon files:
+ * spatial tiles with halo replication, each
+ * joined on its own, and their merge.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_SHARD_H_FILE_
+#define _IOU_SHARD_H_FILE_
+
+#include "join.h"
+#include "polyfile.h"
+
+namespace IOU
+{
+    enum ShardPlanFlag
+    {
+        ShardSelfJoin = 1   // A joined with itself, B not stored.
+    };
+    const uint32_t ShardPlanVersion = 3;
+
+    // One tile of a plan, as needed by the node that joins it.
+    // A pair belongs to the tile holding its reference point, the lower
+    // corner of the overlap of the two bounding boxes, in
+    // [xMin, xMax) x [yMin, yMax), closed where xMax or yMax is infinite
+    // so that the outer tiles hold every point. Every polygon whose
+    // bounding box may hold such a point is a member, so that polygons
+    // crossing the border are replicated in each tile they reach.
+    struct ShardTile {
+        AABB box;
+        bool selfJoin;
+        std::vector<int> membersA;  // Ascending indexes in A.
+        std::vector<int> membersB;  // Same in B, empty for a self join.
+    };
+
+    // Layout of a plan file, as that of a polygon file:
+    //   ShardPlanHeader
+    //   AABB tiles[count]
+    //   uint64_t offsetsA[count+1]  first member of every tile in membersA
+    //   int32_t membersA[memberCountA]
+    //   uint64_t offsetsB[count+1]  absent for a self join
+    //   int32_t membersB[memberCountB]
+    struct ShardPlanHeader {
+        char magic[8];          // "IOUSHRD" and a null.
+        uint32_t version;
+        uint32_t flags;
+        uint64_t byteOrder;     // PolygonFileByteOrder.
+        uint64_t count;
+        uint64_t memberCountA;
+        uint64_t memberCountB;
+        uint64_t tilesPos;
+        uint64_t offsetsAPos;
+        uint64_t membersAPos;
+        uint64_t offsetsBPos;
+        uint64_t membersBPos;
+    };
+
+    // Split of the plane in tiles for a join of A with B, or of A with
+    // itself. Built once, written to a file, and each tile then joined
+    // anywhere from that file and the polygon files.
+    class ShardPlan {
+    public:
+        // Constructors.
+        ShardPlan();
+
+        // About nTiles tiles of balanced sizes: slabs along x at the
+        // quantiles of the centers of the bounding boxes of A, each split
+        // along y at the quantiles of the centers it holds. The outer
+        // tiles reach to infinity.
+        void build(const std::vector<AABB> &boxesA, const std::vector<AABB> &boxesB,
+                   const int nTiles);
+        void build(const std::vector<AABB> &boxes, const int nTiles);
+        // Same, from the bounds and areas of the files, computed if they
+        // do not have them; invalid polygons are left out.
+        void build(const PolygonFile &A, const PolygonFile &B, const int nTiles);
+        void build(const PolygonFile &A, const int nTiles);
+        // Returns false if the file cannot be written.
+        bool write(const std::string &path) const;
+
+        // Methods.
+        int size() const { return tiles.size(); }
+        bool empty() const { return tiles.empty(); }
+        bool selfJoin() const { return self; }
+        const AABB& tileBox(const int t) const { assert(t < size()); return tiles[t]; }
+        void tile(const int t, ShardTile &out) const;
+        // Number of memberships of A and B over all tiles, the replication
+        // being their ratio to the number of polygons.
+        long long memberCount() const { return (long long)idsA.size() + idsB.size(); }
+
+    private:
+        void build(const std::vector<AABB> &boxesA, const std::vector<char> &validA,
+                   const std::vector<AABB> *boxesB, const std::vector<char> *validB,
+                   const int nTiles);
+        void buildTiles(const std::vector<AABB> &boxes, const std::vector<char> &valid,
+                        const int nTiles);
+        void assign(const std::vector<AABB> &boxes, const std::vector<char> &valid,
+                    std::vector<uint64_t> &offsets, std::vector<int> &ids) const;
+
+        bool self;
+        // Slab s lies between cutsX[s-1] and cutsX[s], its tiles being
+        // slabStart[s] to slabStart[s+1]-1, split at cutsY[s].
+        std::vector<double> cutsX;
+        std::vector<std::vector<double> > cutsY;
+        std::vector<int> slabStart;
+        std::vector<AABB> tiles;
+        std::vector<uint64_t> offsetsA;
+        std::vector<int> idsA;
+        std::vector<uint64_t> offsetsB;
+        std::vector<int> idsB;
+    };
+
+    // Number of tiles of a plan file, -1 if it is not a valid plan file
+    // of this version and byte order.
+    int shardTileCount(const std::string &path);
+    // Read tile t of a plan file, and only that part of it.
+    // Returns false if the file is not valid or has no tile t.
+    bool readShardTile(const std::string &path, const int t, ShardTile &tile);
+
+    // Pairs (i, j) of the tile, i of A and j of B, with iou > thresh, by
+    // iouJoinEx over views of its members, sorted by i then j. For a self
+    // join, B is not read and only the pairs i < j are kept.
+    // Running every tile and merging their pairs gives those of
+    // iouJoinPairsEx(A, B), each once, or for a self join those of
+    // iouJoinPairsEx(A, A) with i < j.
+    // Returns false, pairs left empty, if a member is not in its file.
+    bool shardJoin(const PolygonFile &A, const PolygonFile &B, const ShardTile &tile,
+                   const double thresh, std::vector<IouPair> &pairs,
+                   const InterMethod method = PointSoup);
+
+    // Pairs of all the tiles, in any order, sorted by i then j with any
+    // repeated pair, e.g. of a tile run twice, kept once.
+    std::vector<IouPair> mergeShardPairs(const std::vector<std::vector<IouPair> > &parts);
+}
+#endif // !_IOU_SHARD_H_FILE_
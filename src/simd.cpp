@@ -0,0 +1,269 @@
+/***********************************
+ * simd.cpp
+ *
+ * One-vs-many iou of rectangles and rotated
+ * rectangles over structure-of-arrays batches,
+ * with SSE2 / AVX2 / NEON kernels chosen at runtime.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "simd.h"
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define IOU_SIMD_KERNEL_BASELINE
+#include "simd_kernel.h"
+
+namespace IOU
+{
+
+namespace simd
+{
+    void iouRectScalar(const RectQuery &q, const RectArrays &b,
+                       const int begin, const int end, float *out)
+    {
+        iouRectRange<VScalar>(q, b, begin, end, out);
+    }
+    void iouRotatedScalar(const RotatedQuery &q, const RotatedArrays &b,
+                          const int begin, const int end, float *out)
+    {
+        iouRotatedRange<VScalar>(q, b, begin, end, out);
+    }
+#ifdef IOU_SIMD_HAS_SSE2
+    void iouRectSSE2(const RectQuery &q, const RectArrays &b,
+                     const int begin, const int end, float *out)
+    {
+        iouRectRange<VSSE>(q, b, begin, end, out);
+    }
+    void iouRotatedSSE2(const RotatedQuery &q, const RotatedArrays &b,
+                        const int begin, const int end, float *out)
+    {
+        iouRotatedRange<VSSE>(q, b, begin, end, out);
+    }
+#endif
+#ifdef IOU_SIMD_HAS_NEON
+    void iouRectNEON(const RectQuery &q, const RectArrays &b,
+                     const int begin, const int end, float *out)
+    {
+        iouRectRange<VNEON>(q, b, begin, end, out);
+    }
+    void iouRotatedNEON(const RotatedQuery &q, const RotatedArrays &b,
+                        const int begin, const int end, float *out)
+    {
+        iouRotatedRange<VNEON>(q, b, begin, end, out);
+    }
+#endif
+} // namespace simd
+
+namespace
+{
+
+// AVX2 needs the instructions and the OS saving the ymm registers.
+bool cpuHasAVX2()
+{
+#if !defined(IOU_SIMD_HAS_AVX2)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+bool supported(const SimdLevel level)
+{
+    switch (level) {
+    case SimdScalar:
+        return true;
+    case SimdSSE2:
+#ifdef IOU_SIMD_HAS_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case SimdAVX2: {
+        static const bool has = cpuHasAVX2();
+        return has;
+    }
+    case SimdNEON:
+#ifdef IOU_SIMD_HAS_NEON
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+// The level to run for a requested one.
+SimdLevel resolve(SimdLevel level)
+{
+    if (level == SimdAuto)
+        return simdLevel();
+    while (!supported(level))
+        level = (level == SimdAVX2) ? SimdSSE2 : SimdScalar;
+    return level;
+}
+
+} // namespace
+
+SimdLevel simdLevel()
+{
+    if (supported(SimdAVX2))
+        return SimdAVX2;
+    if (supported(SimdNEON))
+        return SimdNEON;
+    if (supported(SimdSSE2))
+        return SimdSSE2;
+    return SimdScalar;
+}
+const char* simdLevelName(const SimdLevel level)
+{
+    switch (level) {
+    case SimdAuto:   return "auto";
+    case SimdScalar: return "scalar";
+    case SimdSSE2:   return "sse2";
+    case SimdAVX2:   return "avx2";
+    case SimdNEON:   return "neon";
+    default:         return "unknown";
+    }
+}
+
+void RectBatch::clear()
+{
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+}
+void RectBatch::reserve(const int n)
+{
+    x1.reserve(n);
+    y1.reserve(n);
+    x2.reserve(n);
+    y2.reserve(n);
+}
+void RectBatch::push_back(const Rect &rect)
+{
+    x1.push_back((float)rect.x1);
+    y1.push_back((float)rect.y1);
+    x2.push_back((float)rect.x2);
+    y2.push_back((float)rect.y2);
+}
+
+void RotatedRectBatch::clear()
+{
+    cx.clear();
+    cy.clear();
+    w.clear();
+    h.clear();
+    theta.clear();
+    cosT.clear();
+    sinT.clear();
+}
+void RotatedRectBatch::reserve(const int n)
+{
+    cx.reserve(n);
+    cy.reserve(n);
+    w.reserve(n);
+    h.reserve(n);
+    theta.reserve(n);
+    cosT.reserve(n);
+    sinT.reserve(n);
+}
+void RotatedRectBatch::push_back(const RotatedRect &rect)
+{
+    cx.push_back((float)rect.center.x);
+    cy.push_back((float)rect.center.y);
+    w.push_back((float)rect.w);
+    h.push_back((float)rect.h);
+    theta.push_back((float)rect.theta);
+    cosT.push_back((float)std::cos(rect.theta));
+    sinT.push_back((float)std::sin(rect.theta));
+}
+
+void iouOneToMany(const Rect &query, const RectBatch &batch, float *out,
+                  const SimdLevel level)
+{
+    const int N = batch.size();
+    if (N == 0)
+        return;
+    simd::RectQuery q;
+    q.x1 = (float)query.x1;
+    q.y1 = (float)query.y1;
+    q.x2 = (float)query.x2;
+    q.y2 = (float)query.y2;
+    q.area = (q.x2 - q.x1) * (q.y2 - q.y1);
+    simd::RectArrays b;
+    b.x1 = batch.x1.data();
+    b.y1 = batch.y1.data();
+    b.x2 = batch.x2.data();
+    b.y2 = batch.y2.data();
+
+    switch (resolve(level)) {
+#ifdef IOU_SIMD_HAS_AVX2
+    case SimdAVX2: simd::iouRectAVX2(q, b, 0, N, out); break;
+#endif
+#ifdef IOU_SIMD_HAS_SSE2
+    case SimdSSE2: simd::iouRectSSE2(q, b, 0, N, out); break;
+#endif
+#ifdef IOU_SIMD_HAS_NEON
+    case SimdNEON: simd::iouRectNEON(q, b, 0, N, out); break;
+#endif
+    default:       simd::iouRectScalar(q, b, 0, N, out); break;
+    }
+}
+void iouOneToMany(const RotatedRect &query, const RotatedRectBatch &batch, float *out,
+                  const SimdLevel level)
+{
+    const int N = batch.size();
+    if (N == 0)
+        return;
+    simd::RotatedQuery q;
+    q.cx = (float)query.center.x;
+    q.cy = (float)query.center.y;
+    q.a = (float)(query.w / 2.0);
+    q.b = (float)(query.h / 2.0);
+    q.cosT = (float)std::cos(query.theta);
+    q.sinT = (float)std::sin(query.theta);
+    q.area = (float)query.w * (float)query.h;
+    simd::RotatedArrays b;
+    b.cx = batch.cx.data();
+    b.cy = batch.cy.data();
+    b.w = batch.w.data();
+    b.h = batch.h.data();
+    b.cosT = batch.cosT.data();
+    b.sinT = batch.sinT.data();
+
+    switch (resolve(level)) {
+#ifdef IOU_SIMD_HAS_AVX2
+    case SimdAVX2: simd::iouRotatedAVX2(q, b, 0, N, out); break;
+#endif
+#ifdef IOU_SIMD_HAS_SSE2
+    case SimdSSE2: simd::iouRotatedSSE2(q, b, 0, N, out); break;
+#endif
+#ifdef IOU_SIMD_HAS_NEON
+    case SimdNEON: simd::iouRotatedNEON(q, b, 0, N, out); break;
+#endif
+    default:       simd::iouRotatedScalar(q, b, 0, N, out); break;
+    }
+}
+
+}
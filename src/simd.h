@@ -0,0 +1,78 @@
+/***********************************
+ * simd.h
+ *
+ * One-vs-many iou of rectangles and rotated
+ * rectangles over structure-of-arrays batches,
+ * with SSE2 / AVX2 / NEON kernels chosen at runtime.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_SIMD_H_FILE_
+#define _IOU_SIMD_H_FILE_
+
+#include "rect.h"
+
+namespace IOU
+{
+    enum SimdLevel
+    {
+        SimdAuto,   // Best level supported by the build and the CPU.
+        SimdScalar,
+        SimdSSE2,
+        SimdAVX2,
+        SimdNEON
+    };
+
+    // Best level supported by the build and the running CPU.
+    SimdLevel simdLevel();
+    // Name of a level, for logs.
+    const char* simdLevelName(const SimdLevel level);
+
+    // Batch of axis-aligned rectangles, one array per coordinate.
+    class RectBatch {
+    public:
+        // Members.
+        std::vector<float> x1;
+        std::vector<float> y1;
+        std::vector<float> x2;
+        std::vector<float> y2;
+
+        // Methods.
+        int size() const { return x1.size(); }
+        void clear();
+        void reserve(const int n);
+        void push_back(const Rect &rect);
+    };
+
+    // Batch of rotated rectangles, one array per parameter, plus the
+    // cosine and sine of each angle computed on insertion.
+    class RotatedRectBatch {
+    public:
+        // Members.
+        std::vector<float> cx;
+        std::vector<float> cy;
+        std::vector<float> w;
+        std::vector<float> h;
+        std::vector<float> theta;
+        std::vector<float> cosT;
+        std::vector<float> sinT;
+
+        // Methods.
+        int size() const { return cx.size(); }
+        void clear();
+        void reserve(const int n);
+        void push_back(const RotatedRect &rect);
+    };
+
+    // out[i] = iou(query, batch[i]) for every rectangle of the batch,
+    // computed in single precision, 4 (SSE2, NEON) or 8 (AVX2) at a time.
+    // A level the CPU does not support falls back to the best one below.
+    // All levels run the same formula and agree with SimdScalar up to
+    // rounding.
+    void iouOneToMany(const Rect &query, const RectBatch &batch, float *out,
+                      const SimdLevel level = SimdAuto);
+    void iouOneToMany(const RotatedRect &query, const RotatedRectBatch &batch, float *out,
+                      const SimdLevel level = SimdAuto);
+}
+#endif // !_IOU_SIMD_H_FILE_
@@ -0,0 +1,49 @@
+/***********************************
+ * simd_avx2.cpp
+ *
+ * AVX2 kernels of simd.h, compiled for AVX2
+ * whatever the flags of the build, and only
+ * called when the CPU supports it.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+// The intrinsics are declared before the target switch, the kernels
+// are compiled after it.
+#include <immintrin.h>
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#define IOU_SIMD_KERNEL_AVX2
+#include "simd_kernel.h"
+
+namespace IOU
+{
+namespace simd
+{
+    void iouRectAVX2(const RectQuery &q, const RectArrays &b,
+                     const int begin, const int end, float *out)
+    {
+        iouRectRange<VAVX>(q, b, begin, end, out);
+    }
+    void iouRotatedAVX2(const RotatedQuery &q, const RotatedArrays &b,
+                        const int begin, const int end, float *out)
+    {
+        iouRotatedRange<VAVX>(q, b, begin, end, out);
+    }
+} // namespace simd
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,391 @@
+/***********************************
+ * simd_kernel.h
+ *
+ * Batch kernels of simd.h, written once over
+ * a small vector type per instruction set.
+ * Internal to simd.cpp, simd_avx2.cpp and
+ * gpu.cu.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_SIMD_KERNEL_H_FILE_
+#define _IOU_SIMD_KERNEL_H_FILE_
+
+// This file is compiled for several instruction sets in the same binary,
+// so it includes no header but the intrinsics and instantiates no standard
+// library template: their out-of-line copies would be merged across
+// instruction sets by the linker. Everything it defines has internal
+// linkage.
+//
+// The includer selects the vector types to define: IOU_SIMD_KERNEL_BASELINE
+// for those the build always supports (SSE2 on x86, NEON on AArch64), or
+// IOU_SIMD_KERNEL_AVX2.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IOU_SIMD_X86
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IOU_SIMD_HAS_SSE2
+#endif
+#define IOU_SIMD_HAS_AVX2
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define IOU_SIMD_HAS_NEON
+#endif
+
+#if defined(IOU_SIMD_KERNEL_BASELINE) && defined(IOU_SIMD_HAS_SSE2)
+#define IOU_SIMD_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(IOU_SIMD_KERNEL_BASELINE) && defined(IOU_SIMD_HAS_NEON)
+#define IOU_SIMD_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+#if defined(IOU_SIMD_KERNEL_AVX2)
+#include <immintrin.h>
+#endif
+
+// gpu.cu selects no vector type and runs the kernels over VScalar on the
+// device too, for the same results as SimdScalar.
+#ifdef __CUDACC__
+#define IOU_SIMD_HD __host__ __device__
+#else
+#define IOU_SIMD_HD
+#endif
+
+namespace IOU
+{
+namespace simd
+{
+    // Query and batch, as plain data.
+    struct RectQuery {
+        float x1, y1, x2, y2;
+        float area;
+    };
+    struct RectArrays {
+        const float *x1, *y1, *x2, *y2;
+    };
+    // a and b are the half sizes of the query.
+    struct RotatedQuery {
+        float cx, cy, a, b;
+        float cosT, sinT;
+        float area;
+    };
+    struct RotatedArrays {
+        const float *cx, *cy, *w, *h;
+        const float *cosT, *sinT;
+    };
+
+    // Kernels of each level, for the items [begin, end) of the batch.
+    void iouRectScalar(const RectQuery &q, const RectArrays &b,
+                       const int begin, const int end, float *out);
+    void iouRotatedScalar(const RotatedQuery &q, const RotatedArrays &b,
+                          const int begin, const int end, float *out);
+#ifdef IOU_SIMD_HAS_SSE2
+    void iouRectSSE2(const RectQuery &q, const RectArrays &b,
+                     const int begin, const int end, float *out);
+    void iouRotatedSSE2(const RotatedQuery &q, const RotatedArrays &b,
+                        const int begin, const int end, float *out);
+#endif
+#ifdef IOU_SIMD_HAS_AVX2
+    void iouRectAVX2(const RectQuery &q, const RectArrays &b,
+                     const int begin, const int end, float *out);
+    void iouRotatedAVX2(const RotatedQuery &q, const RotatedArrays &b,
+                        const int begin, const int end, float *out);
+#endif
+#ifdef IOU_SIMD_HAS_NEON
+    void iouRectNEON(const RectQuery &q, const RectArrays &b,
+                     const int begin, const int end, float *out);
+    void iouRotatedNEON(const RotatedQuery &q, const RotatedArrays &b,
+                        const int begin, const int end, float *out);
+#endif
+
+namespace
+{
+    // Vector types. Each provides Width, Mask, set1, load, store, the
+    // arithmetic operators, comparisons to a Mask, and vmin, vmax, vabs,
+    // select and anyOf. vmin / vmax return the second operand when one is
+    // NaN, as the x86 instructions do.
+
+    struct VScalar {
+        enum { Width = 1 };
+        typedef bool Mask;
+        float v;
+
+        IOU_SIMD_HD static inline VScalar set1(const float x) { VScalar r; r.v = x; return r; }
+        IOU_SIMD_HD static inline VScalar load(const float *p) { return set1(*p); }
+        IOU_SIMD_HD inline void store(float *p) const { *p = v; }
+    };
+    IOU_SIMD_HD inline VScalar operator+(VScalar a, VScalar b) { return VScalar::set1(a.v + b.v); }
+    IOU_SIMD_HD inline VScalar operator-(VScalar a, VScalar b) { return VScalar::set1(a.v - b.v); }
+    IOU_SIMD_HD inline VScalar operator*(VScalar a, VScalar b) { return VScalar::set1(a.v * b.v); }
+    IOU_SIMD_HD inline VScalar operator/(VScalar a, VScalar b) { return VScalar::set1(a.v / b.v); }
+    IOU_SIMD_HD inline bool operator<(VScalar a, VScalar b) { return a.v < b.v; }
+    IOU_SIMD_HD inline bool operator<=(VScalar a, VScalar b) { return a.v <= b.v; }
+    IOU_SIMD_HD inline bool operator>(VScalar a, VScalar b) { return a.v > b.v; }
+    IOU_SIMD_HD inline bool operator>=(VScalar a, VScalar b) { return a.v >= b.v; }
+    IOU_SIMD_HD inline VScalar vmin(VScalar a, VScalar b) { return a.v < b.v ? a : b; }
+    IOU_SIMD_HD inline VScalar vmax(VScalar a, VScalar b) { return a.v > b.v ? a : b; }
+    IOU_SIMD_HD inline VScalar vabs(VScalar a) { return VScalar::set1(a.v < 0.0f ? -a.v : a.v); }
+    IOU_SIMD_HD inline VScalar select(bool m, VScalar a, VScalar b) { return m ? a : b; }
+    IOU_SIMD_HD inline bool anyOf(bool m) { return m; }
+
+#if defined(IOU_SIMD_KERNEL_SSE2)
+    struct MSSE { __m128 m; };
+    struct VSSE {
+        enum { Width = 4 };
+        typedef MSSE Mask;
+        __m128 v;
+
+        static inline VSSE make(__m128 x) { VSSE r; r.v = x; return r; }
+        static inline VSSE set1(const float x) { return make(_mm_set1_ps(x)); }
+        static inline VSSE load(const float *p) { return make(_mm_loadu_ps(p)); }
+        inline void store(float *p) const { _mm_storeu_ps(p, v); }
+    };
+    inline MSSE mask(__m128 m) { MSSE r; r.m = m; return r; }
+    inline VSSE operator+(VSSE a, VSSE b) { return VSSE::make(_mm_add_ps(a.v, b.v)); }
+    inline VSSE operator-(VSSE a, VSSE b) { return VSSE::make(_mm_sub_ps(a.v, b.v)); }
+    inline VSSE operator*(VSSE a, VSSE b) { return VSSE::make(_mm_mul_ps(a.v, b.v)); }
+    inline VSSE operator/(VSSE a, VSSE b) { return VSSE::make(_mm_div_ps(a.v, b.v)); }
+    inline MSSE operator<(VSSE a, VSSE b) { return mask(_mm_cmplt_ps(a.v, b.v)); }
+    inline MSSE operator<=(VSSE a, VSSE b) { return mask(_mm_cmple_ps(a.v, b.v)); }
+    inline MSSE operator>(VSSE a, VSSE b) { return mask(_mm_cmpgt_ps(a.v, b.v)); }
+    inline MSSE operator>=(VSSE a, VSSE b) { return mask(_mm_cmpge_ps(a.v, b.v)); }
+    inline MSSE operator|(MSSE a, MSSE b) { return mask(_mm_or_ps(a.m, b.m)); }
+    inline MSSE operator&(MSSE a, MSSE b) { return mask(_mm_and_ps(a.m, b.m)); }
+    inline VSSE vmin(VSSE a, VSSE b) { return VSSE::make(_mm_min_ps(a.v, b.v)); }
+    inline VSSE vmax(VSSE a, VSSE b) { return VSSE::make(_mm_max_ps(a.v, b.v)); }
+    inline VSSE vabs(VSSE a) { return VSSE::make(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+    inline VSSE select(MSSE m, VSSE a, VSSE b) {
+        return VSSE::make(_mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v))); }
+    inline bool anyOf(MSSE m) { return _mm_movemask_ps(m.m) != 0; }
+#endif
+
+#if defined(IOU_SIMD_KERNEL_AVX2)
+    struct MAVX { __m256 m; };
+    struct VAVX {
+        enum { Width = 8 };
+        typedef MAVX Mask;
+        __m256 v;
+
+        static inline VAVX make(__m256 x) { VAVX r; r.v = x; return r; }
+        static inline VAVX set1(const float x) { return make(_mm256_set1_ps(x)); }
+        static inline VAVX load(const float *p) { return make(_mm256_loadu_ps(p)); }
+        inline void store(float *p) const { _mm256_storeu_ps(p, v); }
+    };
+    inline MAVX mask(__m256 m) { MAVX r; r.m = m; return r; }
+    inline VAVX operator+(VAVX a, VAVX b) { return VAVX::make(_mm256_add_ps(a.v, b.v)); }
+    inline VAVX operator-(VAVX a, VAVX b) { return VAVX::make(_mm256_sub_ps(a.v, b.v)); }
+    inline VAVX operator*(VAVX a, VAVX b) { return VAVX::make(_mm256_mul_ps(a.v, b.v)); }
+    inline VAVX operator/(VAVX a, VAVX b) { return VAVX::make(_mm256_div_ps(a.v, b.v)); }
+    inline MAVX operator<(VAVX a, VAVX b) { return mask(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+    inline MAVX operator<=(VAVX a, VAVX b) { return mask(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+    inline MAVX operator>(VAVX a, VAVX b) { return mask(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+    inline MAVX operator>=(VAVX a, VAVX b) { return mask(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)); }
+    inline MAVX operator|(MAVX a, MAVX b) { return mask(_mm256_or_ps(a.m, b.m)); }
+    inline MAVX operator&(MAVX a, MAVX b) { return mask(_mm256_and_ps(a.m, b.m)); }
+    inline VAVX vmin(VAVX a, VAVX b) { return VAVX::make(_mm256_min_ps(a.v, b.v)); }
+    inline VAVX vmax(VAVX a, VAVX b) { return VAVX::make(_mm256_max_ps(a.v, b.v)); }
+    inline VAVX vabs(VAVX a) { return VAVX::make(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+    inline VAVX select(MAVX m, VAVX a, VAVX b) { return VAVX::make(_mm256_blendv_ps(b.v, a.v, m.m)); }
+    inline bool anyOf(MAVX m) { return _mm256_movemask_ps(m.m) != 0; }
+#endif
+
+#if defined(IOU_SIMD_KERNEL_NEON)
+    struct MNEON { uint32x4_t m; };
+    struct VNEON {
+        enum { Width = 4 };
+        typedef MNEON Mask;
+        float32x4_t v;
+
+        static inline VNEON make(float32x4_t x) { VNEON r; r.v = x; return r; }
+        static inline VNEON set1(const float x) { return make(vdupq_n_f32(x)); }
+        static inline VNEON load(const float *p) { return make(vld1q_f32(p)); }
+        inline void store(float *p) const { vst1q_f32(p, v); }
+    };
+    inline MNEON mask(uint32x4_t m) { MNEON r; r.m = m; return r; }
+    inline VNEON operator+(VNEON a, VNEON b) { return VNEON::make(vaddq_f32(a.v, b.v)); }
+    inline VNEON operator-(VNEON a, VNEON b) { return VNEON::make(vsubq_f32(a.v, b.v)); }
+    inline VNEON operator*(VNEON a, VNEON b) { return VNEON::make(vmulq_f32(a.v, b.v)); }
+    inline VNEON operator/(VNEON a, VNEON b) { return VNEON::make(vdivq_f32(a.v, b.v)); }
+    inline MNEON operator<(VNEON a, VNEON b) { return mask(vcltq_f32(a.v, b.v)); }
+    inline MNEON operator<=(VNEON a, VNEON b) { return mask(vcleq_f32(a.v, b.v)); }
+    inline MNEON operator>(VNEON a, VNEON b) { return mask(vcgtq_f32(a.v, b.v)); }
+    inline MNEON operator>=(VNEON a, VNEON b) { return mask(vcgeq_f32(a.v, b.v)); }
+    inline MNEON operator|(MNEON a, MNEON b) { return mask(vorrq_u32(a.m, b.m)); }
+    inline MNEON operator&(MNEON a, MNEON b) { return mask(vandq_u32(a.m, b.m)); }
+    inline VNEON select(MNEON m, VNEON a, VNEON b) { return VNEON::make(vbslq_f32(m.m, a.v, b.v)); }
+    inline VNEON vmin(VNEON a, VNEON b) { return select(a < b, a, b); }
+    inline VNEON vmax(VNEON a, VNEON b) { return select(a > b, a, b); }
+    inline VNEON vabs(VNEON a) { return VNEON::make(vabsq_f32(a.v)); }
+    inline bool anyOf(MNEON m) { return vmaxvq_u32(m.m) != 0; }
+#endif
+
+    // Rectangles, as Rect's iou: -1 for an empty rectangle.
+    template <class V>
+    inline void iouRectT(const RectQuery &q, const RectArrays &b, const int i, float *out)
+    {
+        const V zero = V::set1(0.0f);
+        const V qx1 = V::set1(q.x1), qy1 = V::set1(q.y1);
+        const V qx2 = V::set1(q.x2), qy2 = V::set1(q.y2);
+        const V x1 = V::load(b.x1 + i);
+        const V y1 = V::load(b.y1 + i);
+        const V x2 = V::load(b.x2 + i);
+        const V y2 = V::load(b.y2 + i);
+        const V w = vmax(zero, vmin(qx2, x2) - vmax(qx1, x1));
+        const V h = vmax(zero, vmin(qy2, y2) - vmax(qy1, y1));
+        const V inter = w * h;
+        const V uni = V::set1(q.area) + (x2 - x1) * (y2 - y1) - inter;
+        const typename V::Mask valid = (qx2 > qx1) & (qy2 > qy1) & (x2 > x1) & (y2 > y1);
+        select(valid, inter / uni, V::set1(-1.0f)).store(out + i);
+    }
+
+    // Liang-Barsky: the part [t0,t1] of p + t*d, t in [0,1], inside
+    // |x| <= hx and |y| <= hy. d has no zero component.
+    template <class V>
+    IOU_SIMD_HD inline void clipToBox(const V &px, const V &py, const V &dx, const V &dy,
+                                      const V &hx, const V &hy, V &t0, V &t1)
+    {
+        const V zero = V::set1(0.0f);
+        const V one = V::set1(1.0f);
+        const V ix = one / dx;
+        const V iy = one / dy;
+        const V xa = (zero - hx - px) * ix;
+        const V xb = (hx - px) * ix;
+        const V ya = (zero - hy - py) * iy;
+        const V yb = (hy - py) * iy;
+        t0 = vmax(vmax(zero, vmin(xa, xb)), vmin(ya, yb));
+        t1 = vmin(vmin(one, vmax(xa, xb)), vmax(ya, yb));
+    }
+    // x dy - y dx along p + t*d for t in [t0,t1], 0 where empty.
+    template <class V>
+    IOU_SIMD_HD inline V crossOn(const V &px, const V &py, const V &dx, const V &dy,
+                                 const V &t0, const V &t1)
+    {
+        const V x0 = px + t0 * dx;
+        const V y0 = py + t0 * dy;
+        const V x1 = px + t1 * dx;
+        const V y1 = py + t1 * dy;
+        return select(t1 > t0, x0 * y1 - y0 * x1, V::set1(0.0f));
+    }
+
+    // Rotated rectangles, as RotatedRect's iou.
+    // Works in the frame of the query, which is the box |x|<=a, |y|<=b.
+    // Separated pairs and pairs with parallel edges use closed forms, the
+    // others sum x dy - y dx along the boundary of the intersection, made
+    // of the edges of each rectangle clipped by the other (Green's theorem,
+    // both rectangles counterclockwise).
+    // Only a sine or cosine below 1e-20, where clipToBox would divide by
+    // 0, counts as parallel: a small angle is no longer negligible along a
+    // long side.
+    template <class V>
+    IOU_SIMD_HD inline V iouRotatedV(const RotatedQuery &q, const V &cx, const V &cy,
+                                     const V &w, const V &h, const V &bc, const V &bs)
+    {
+        const V zero = V::set1(0.0f);
+        const V half = V::set1(0.5f);
+        const V eps = V::set1(1e-20f);
+        const V a = V::set1(q.a);
+        const V b = V::set1(q.b);
+        const V qc = V::set1(q.cosT);
+        const V qs = V::set1(q.sinT);
+        const V dx = cx - V::set1(q.cx);
+        const V dy = cy - V::set1(q.cy);
+
+        // Candidate in the frame of the query.
+        const V ox = dx * qc + dy * qs;
+        const V oy = dy * qc - dx * qs;
+        const V c = bc * qc + bs * qs;
+        const V s = bs * qc - bc * qs;
+        const V hw = w * half;
+        const V hh = h * half;
+        const V ac = vabs(c);
+        const V as = vabs(s);
+        const V ex = ac * hw + as * hh;
+        const V ey = as * hw + ac * hh;
+
+        // Not separated along the axes of the query, and not parallel.
+        const typename V::Mask hit = (w > zero) & (h > zero) &
+            (vabs(ox) < a + ex) & (vabs(oy) < b + ey);
+        const typename V::Mask general = (as > eps) & (ac > eps);
+
+        // Parallel edges: overlap of the half sizes, swapped at a right
+        // angle.
+        const typename V::Mask turned = ac < as;
+        const V pw = select(turned, hh, hw);
+        const V ph = select(turned, hw, hh);
+        const V ovx = vmax(zero, vmin(a, ox + pw) - vmax(zero - a, ox - pw));
+        const V ovy = vmax(zero, vmin(b, oy + ph) - vmax(zero - b, oy - ph));
+        V inter = ovx * ovy;
+
+        if (anyOf(hit & general)) {
+            // Candidate corners, counterclockwise, and its edges.
+            const V ux = c * hw, uy = s * hw;
+            const V vx = zero - s * hh, vy = c * hh;
+            const V px[4] = { ox - ux - vx, ox + ux - vx, ox + ux + vx, ox - ux + vx };
+            const V py[4] = { oy - uy - vy, oy + uy - vy, oy + uy + vy, oy - uy + vy };
+            const V ex2[4] = { ux + ux, vx + vx, zero - ux - ux, zero - vx - vx };
+            const V ey2[4] = { uy + uy, vy + vy, zero - uy - uy, zero - vy - vy };
+
+            // Query corners, counterclockwise, in the frame of the
+            // candidate: (x, y) -> R(-phi) ((x, y) - o).
+            const V qx[4] = { zero - a, a, a, zero - a };
+            const V qy[4] = { zero - b, zero - b, b, b };
+
+            V sum = zero;
+            V t0, t1;
+            for (int k = 0; k < 4; ++k) {
+                // Edge k of the candidate, clipped by the query.
+                clipToBox(px[k], py[k], ex2[k], ey2[k], a, b, t0, t1);
+                sum = sum + crossOn(px[k], py[k], ex2[k], ey2[k], t0, t1);
+
+                // Edge k of the query, clipped by the candidate.
+                const int k1 = (k + 1) & 3;
+                const V rx = qx[k] - ox, ry = qy[k] - oy;
+                const V fx = qx[k1] - qx[k], fy = qy[k1] - qy[k];
+                clipToBox(rx * c + ry * s, ry * c - rx * s,
+                          fx * c + fy * s, fy * c - fx * s, hw, hh, t0, t1);
+                sum = sum + crossOn(qx[k], qy[k], fx, fy, t0, t1);
+            }
+            inter = select(general, sum * half, inter);
+        }
+        inter = select(hit, inter, zero);
+
+        const V uni = V::set1(q.area) + w * h - inter;
+        const typename V::Mask valid = (a > zero) & (b > zero) & (w > zero) & (h > zero);
+        return select(valid, inter / uni, V::set1(-1.0f));
+    }
+    template <class V>
+    inline void iouRotatedT(const RotatedQuery &q, const RotatedArrays &B, const int i, float *out)
+    {
+        iouRotatedV<V>(q, V::load(B.cx + i), V::load(B.cy + i), V::load(B.w + i),
+                       V::load(B.h + i), V::load(B.cosT + i), V::load(B.sinT + i)).store(out + i);
+    }
+
+    // Whole vectors, then the remaining items one at a time.
+    template <class V>
+    inline void iouRectRange(const RectQuery &q, const RectArrays &b,
+                             const int begin, const int end, float *out)
+    {
+        int i = begin;
+        for (; i + (int)V::Width <= end; i += V::Width)
+            iouRectT<V>(q, b, i, out);
+        for (; i < end; ++i)
+            iouRectT<VScalar>(q, b, i, out);
+    }
+    template <class V>
+    inline void iouRotatedRange(const RotatedQuery &q, const RotatedArrays &b,
+                                const int begin, const int end, float *out)
+    {
+        int i = begin;
+        for (; i + (int)V::Width <= end; i += V::Width)
+            iouRotatedT<V>(q, b, i, out);
+        for (; i < end; ++i)
+            iouRotatedT<VScalar>(q, b, i, out);
+    }
+} // namespace
+
+} // namespace simd
+}
+#endif // !_IOU_SIMD_KERNEL_H_FILE_
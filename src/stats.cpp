@@ -0,0 +1,172 @@
+/***********************************
+ * stats.cpp
+ *
+ * Optional counters and stage timings of the
+ * intersection paths, for profiling.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "stats.h"
+#include <cstring>
+#ifdef IOU_ENABLE_STATS
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace IOU
+{
+
+const char* statCounterName(const StatCounter counter)
+{
+    static const char *names[StatCounterCount] = {
+        "pairs", "nonewise", "rejected", "intersections",
+        "soup failures", "inter vertexes"
+    };
+    return (counter >= 0 && counter < StatCounterCount) ? names[counter] : "";
+}
+const char* statStageName(const StatStage stage)
+{
+    static const char *names[StatStageCount] = {
+        "inter points", "inner points", "order", "clip", "area"
+    };
+    return (stage >= 0 && stage < StatStageCount) ? names[stage] : "";
+}
+
+void dumpStats(const IouStats &stats, std::FILE *f)
+{
+    for (int c = 0; c < StatCounterCount; ++c)
+        std::fprintf(f, "%-16s %20llu\n", statCounterName(StatCounter(c)),
+                     (unsigned long long)stats.counters[c]);
+    for (int s = 0; s < StatStageCount; ++s) {
+        const uint64_t n = stats.stageCalls[s];
+        std::fprintf(f, "%-16s %20llu calls %14.3f ms %10.1f ns/call\n",
+                     statStageName(StatStage(s)), (unsigned long long)n,
+                     stats.stageNanoseconds[s] * 1e-6,
+                     n > 0 ? double(stats.stageNanoseconds[s]) / n : 0.0);
+    }
+}
+
+#ifdef IOU_ENABLE_STATS
+
+namespace
+{
+
+// Threads alive with their counters, and the sum of those of the threads
+// that have exited.
+struct StatsRegistry
+{
+    std::mutex mutex;
+    std::vector<ThreadStats *> threads;
+    IouStats retired;
+    std::atomic<StatsTracer> tracer;
+    std::atomic<void *> user;
+
+    StatsRegistry() : tracer(0), user(0) {
+        std::memset(&retired, 0, sizeof(retired));
+    }
+};
+StatsRegistry& registry()
+{
+    static StatsRegistry r;
+    return r;
+}
+
+void addTo(IouStats &sum, const ThreadStats &s)
+{
+    for (int c = 0; c < StatCounterCount; ++c)
+        sum.counters[c] += s.counters[c].load(std::memory_order_relaxed);
+    for (int k = 0; k < StatStageCount; ++k) {
+        sum.stageCalls[k] += s.stageCalls[k].load(std::memory_order_relaxed);
+        sum.stageNanoseconds[k] += s.stageNanoseconds[k].load(std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+ThreadStats::ThreadStats()
+{
+    for (int c = 0; c < StatCounterCount; ++c)
+        counters[c].store(0, std::memory_order_relaxed);
+    for (int k = 0; k < StatStageCount; ++k) {
+        stageCalls[k].store(0, std::memory_order_relaxed);
+        stageNanoseconds[k].store(0, std::memory_order_relaxed);
+    }
+    StatsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.push_back(this);
+}
+ThreadStats::~ThreadStats()
+{
+    StatsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    addTo(r.retired, *this);
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+}
+
+void traceStage(const StatStage stage, const uint64_t nanoseconds)
+{
+    StatsRegistry &r = registry();
+    const StatsTracer tracer = r.tracer.load(std::memory_order_acquire);
+    if (tracer != 0)
+        tracer(stage, nanoseconds, r.user.load(std::memory_order_relaxed));
+}
+
+bool statsEnabled()
+{
+    return true;
+}
+IouStats collectStats()
+{
+    StatsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    IouStats sum = r.retired;
+    for (size_t i = 0; i < r.threads.size(); ++i)
+        addTo(sum, *r.threads[i]);
+    return sum;
+}
+void resetStats()
+{
+    StatsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::memset(&r.retired, 0, sizeof(r.retired));
+    for (size_t i = 0; i < r.threads.size(); ++i) {
+        ThreadStats &s = *r.threads[i];
+        for (int c = 0; c < StatCounterCount; ++c)
+            s.counters[c].store(0, std::memory_order_relaxed);
+        for (int k = 0; k < StatStageCount; ++k) {
+            s.stageCalls[k].store(0, std::memory_order_relaxed);
+            s.stageNanoseconds[k].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+void setStatsTracer(StatsTracer tracer, void *user)
+{
+    StatsRegistry &r = registry();
+    r.user.store(user, std::memory_order_relaxed);
+    r.tracer.store(tracer, std::memory_order_release);
+}
+
+#else
+
+bool statsEnabled()
+{
+    return false;
+}
+IouStats collectStats()
+{
+    IouStats sum;
+    std::memset(&sum, 0, sizeof(sum));
+    return sum;
+}
+void resetStats()
+{
+}
+void setStatsTracer(StatsTracer, void *)
+{
+}
+
+#endif
+
+}
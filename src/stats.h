@@ -0,0 +1,128 @@
+/***********************************
+ * stats.h
+ *
+ * Optional counters and stage timings of the
+ * intersection paths, for profiling.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_STATS_H_FILE_
+#define _IOU_STATS_H_FILE_
+
+#include <cstdio>
+#include <stdint.h>
+#ifdef IOU_ENABLE_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace IOU
+{
+    // Events counted when the library is built with IOU_ENABLE_STATS.
+    enum StatCounter
+    {
+        StatPairs,          // Pairs whose intersection was asked for.
+        StatNoneWise,       // Pairs with a NoneWise polygon, giving -1.
+        StatRejected,       // Pairs rejected by their bounds.
+        StatIntersections,  // Pairs actually intersected.
+        StatSoupFailures,   // PointSoup intersections not ordered, giving -1.
+        StatInterVertexes,  // Vertexes of all the intersections.
+        StatCounterCount
+    };
+    // Stages timed when the library is built with IOU_ENABLE_STATS.
+    enum StatStage
+    {
+        StageInterPoints,   // Edge crossings, as findInterPointsEx.
+        StageInnerPoints,   // Inner vertexes, as findInnerPointsEx.
+        StageOrder,         // Ordering by angle, as beInSomeWiseEx.
+        StageClip,          // ConvexClip clipping and RobustSoup hull.
+        StageArea,          // Area of the intersections.
+        StatStageCount
+    };
+
+    // Counters and timings summed over threads.
+    struct IouStats {
+        uint64_t counters[StatCounterCount];
+        uint64_t stageCalls[StatStageCount];
+        uint64_t stageNanoseconds[StatStageCount];
+    };
+
+    // Whether the library counts anything: false, with all the functions
+    // below doing nothing, unless built with IOU_ENABLE_STATS.
+    bool statsEnabled();
+    // Sum of the per-thread counters since the last reset, threads that
+    // have exited included.
+    IouStats collectStats();
+    // Zero the counters of every thread. Counts made meanwhile by running
+    // threads may be partly kept.
+    void resetStats();
+    // Print stats as a table, one line per counter and per stage.
+    void dumpStats(const IouStats &stats, std::FILE *f = stdout);
+    const char* statCounterName(const StatCounter counter);
+    const char* statStageName(const StatStage stage);
+
+    // Called at the end of every timed stage, on the thread running it,
+    // with the user pointer given to setStatsTracer. It must be cheap and
+    // thread-safe. 0 removes the tracer; set it while no stage is running
+    // so that it is never called with the user pointer of another.
+    typedef void (*StatsTracer)(const StatStage stage, const uint64_t nanoseconds,
+                                void *user);
+    void setStatsTracer(StatsTracer tracer, void *user = 0);
+
+#ifdef IOU_ENABLE_STATS
+    // Counters of one thread, written only by it and read by collectStats.
+    struct ThreadStats {
+        std::atomic<uint64_t> counters[StatCounterCount];
+        std::atomic<uint64_t> stageCalls[StatStageCount];
+        std::atomic<uint64_t> stageNanoseconds[StatStageCount];
+
+        ThreadStats();
+        ~ThreadStats();
+
+        // Single writer: a relaxed load and store, not a locked add.
+        static void add(std::atomic<uint64_t> &c, const uint64_t n) {
+            c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+    inline ThreadStats& threadStats()
+    {
+        static thread_local ThreadStats stats;
+        return stats;
+    }
+    void traceStage(const StatStage stage, const uint64_t nanoseconds);
+
+    // Time of the enclosing scope, added to a stage.
+    class StageTimer {
+    public:
+        explicit StageTimer(const StatStage _stage)
+            : stage(_stage), start(std::chrono::steady_clock::now()) {}
+        ~StageTimer() {
+            const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            ThreadStats &s = threadStats();
+            ThreadStats::add(s.stageCalls[stage], 1);
+            ThreadStats::add(s.stageNanoseconds[stage], ns);
+            traceStage(stage, ns);
+        }
+
+    private:
+        StageTimer(const StageTimer &);
+        StageTimer& operator=(const StageTimer &);
+
+        const StatStage stage;
+        const std::chrono::steady_clock::time_point start;
+    };
+
+#define IOU_STAT_ADD(counter, n) \
+    ::IOU::ThreadStats::add(::IOU::threadStats().counters[counter], (n))
+#define IOU_STAT_STAGE_CAT(a, b) a##b
+#define IOU_STAT_STAGE_NAME(line) IOU_STAT_STAGE_CAT(iouStageTimer, line)
+#define IOU_STAT_STAGE(stage) \
+    ::IOU::StageTimer IOU_STAT_STAGE_NAME(__LINE__)(stage)
+#else
+#define IOU_STAT_ADD(counter, n) ((void)0)
+#define IOU_STAT_STAGE(stage) ((void)0)
+#endif
+}
+#endif // !_IOU_STATS_H_FILE_
@@ -0,0 +1,145 @@
+/***********************************
+ * sweep.h
+ *
+ * Sweep and prune of the bounding boxes
+ * of two sets along x.
+ * Internal to join.cpp and convexset.cpp.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_SWEEP_H_FILE_
+#define _IOU_SWEEP_H_FILE_
+
+#include "iou.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace IOU
+{
+namespace sweep
+{
+    // Boxes whose x interval may still reach the sweep, on a 1-D grid of
+    // bands along y: a box is listed in every band its y interval covers,
+    // so that a query only visits the boxes around its own y interval.
+    // Boxes left behind by the sweep are dropped from the bands visited.
+    class ActiveBands {
+    public:
+        // Constructors.
+        ActiveBands(const double _yMin, const double _bandSize, const int n)
+            : yMin(_yMin), bandSize(_bandSize), bands(n) {}
+
+        // Methods.
+        void insert(const int i, const AABB &b) {
+            const int y1 = band(b.yMax);
+            for (int y = band(b.yMin); y <= y1; ++y)
+                bands[y].push_back(i);
+        }
+        // Call f(m) once for every box m, whose bounding box is box(m),
+        // overlapping the box q along y and still reaching q.xMin along x,
+        // q.xMin not decreasing from one call to the next. A pair is met in
+        // every band both cover and reported in the one of the higher
+        // yMin only. Stops at, and returns false on, the first f(m) false.
+        template <class Box, class Func>
+        bool forEachOverlapping(const AABB &q, Box box, Func f) {
+            const int y1 = band(q.yMax);
+            for (int y = band(q.yMin); y <= y1; ++y) {
+                std::vector<int> &active = bands[y];
+                for (int k = 0; k < (int)active.size(); ) {
+                    const int m = active[k];
+                    const AABB &b = box(m);
+                    if (b.xMax < q.xMin) {
+                        // Left behind by the sweep for good.
+                        active[k] = active.back();
+                        active.pop_back();
+                        continue;
+                    }
+                    ++k;
+                    if (b.yMax < q.yMin || q.yMax < b.yMin ||
+                        band(std::max(q.yMin, b.yMin)) != y)
+                        continue;
+                    if (!f(m))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        // Clamped in double before the conversion, which is undefined out
+        // of the range of int.
+        int band(const double y) const {
+            const double c = (y - yMin) / bandSize;
+            const int n = bands.size();
+            return c >= 0.0 ? (c < n ? (int)c : n - 1) : 0;
+        }
+
+        double yMin;
+        double bandSize;
+        std::vector<std::vector<int> > bands;
+    };
+
+    // Sweep along x the boxes of two sets, box1(i) and box2(j), entering
+    // by order1 and order2 of increasing xMin, and call visit(from1, n, m)
+    // once for every pair of overlapping boxes: n the index of the last
+    // one to enter, from the first set if from1, m that of the other.
+    // Stops at, and returns false on, the first visit false.
+    template <class Box1, class Box2, class Visit>
+    bool sweepPairs(const std::vector<int> &order1, Box1 box1,
+                    const std::vector<int> &order2, Box2 box2, Visit visit)
+    {
+        const int N1 = order1.size();
+        const int N2 = order2.size();
+
+        // Bands of the mean box height over the finite boxes, one for every
+        // 32 boxes at most: few boxes are scanned faster in one list.
+        int nFinite = 0;
+        double yMin = 0.0, yMax = 0.0, meanHeight = 0.0;
+        for (int k = 0; k < N1 + N2; ++k) {
+            const AABB &b = k < N1 ? box1(order1[k]) : box2(order2[k - N1]);
+            if (!std::isfinite(b.yMin) || !std::isfinite(b.yMax))
+                continue;
+            yMin = nFinite == 0 ? b.yMin : std::min(yMin, b.yMin);
+            yMax = nFinite == 0 ? b.yMax : std::max(yMax, b.yMax);
+            meanHeight += b.height();
+            ++nFinite;
+        }
+        if (nFinite > 0)
+            meanHeight /= nFinite;
+        const int maxBands = (N1 + N2) / 32 + 1;
+        const double bandSize = std::max(std::max(meanHeight, _ZERO_),
+                                         (yMax - yMin) / maxBands);
+        const double span = (yMax - yMin) / bandSize + 1.0;
+        const int nBands = span >= 1.0 ? (int)std::min(span, (double)maxBands) : 1;
+        ActiveBands active1(yMin, bandSize, nBands), active2(yMin, bandSize, nBands);
+
+        int k1 = 0, k2 = 0;
+        while (k1 < N1 || k2 < N2) {
+            const bool from1 = k2 == N2 ||
+                (k1 < N1 && box1(order1[k1]).xMin <= box2(order2[k2]).xMin);
+            if (from1) {
+                const int n = order1[k1++];
+                const AABB &box = box1(n);
+                if (!active2.forEachOverlapping(box, box2, [&](const int m) {
+                        return visit(true, n, m);
+                    }))
+                    return false;
+                active1.insert(n, box);
+            }
+            else {
+                const int n = order2[k2++];
+                const AABB &box = box2(n);
+                if (!active1.forEachOverlapping(box, box1, [&](const int m) {
+                        return visit(false, n, m);
+                    }))
+                    return false;
+                active2.insert(n, box);
+            }
+        }
+        return true;
+    }
+}
+}
+
+#endif // !_IOU_SWEEP_H_FILE_
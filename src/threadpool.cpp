@@ -0,0 +1,189 @@
+/***********************************
+ * threadpool.cpp
+ *
+ * Work-stealing thread pool for the batched paths.
+ * Only requires the C++11 standard library.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "threadpool.h"
+
+namespace IOU
+{
+
+namespace
+{
+int workerCount(const int nThreads)
+{
+    if (nThreads > 0)
+        return nThreads;
+    const int n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+// Pool and worker index of the task running on this thread, if any.
+thread_local const ThreadPool *currentPool = 0;
+thread_local int currentWorker = 0;
+
+// Marks this thread as running tasks of pool as worker id, until the end
+// of the scope.
+class WorkerScope {
+public:
+    WorkerScope(const ThreadPool *pool, const int id)
+        : prevPool(currentPool), prevWorker(currentWorker) {
+        currentPool = pool;
+        currentWorker = id;
+    }
+    ~WorkerScope() {
+        currentPool = prevPool;
+        currentWorker = prevWorker;
+    }
+
+private:
+    const ThreadPool *prevPool;
+    int prevWorker;
+};
+} // namespace
+
+ThreadPool::ThreadPool(const int nThreads)
+    : nWorkers(workerCount(nThreads)),
+      ranges(nWorkers),
+      job(0), generation(0), active(0), quit(false), remaining(0)
+{
+    for (int i = 0; i < nWorkers; ++i)
+        ranges[i].begin = ranges[i].end = 0;
+    threads.reserve(nWorkers - 1);
+    for (int i = 1; i < nWorkers; ++i)
+        threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+}
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+void ThreadPool::parallelFor(const int nTasks, const Task &task)
+{
+    if (nTasks <= 0)
+        return;
+    // Called from one of our own tasks, the call below would wait for
+    // itself: run on this worker instead.
+    if (currentPool == this) {
+        const int id = currentWorker;
+        for (int t = 0; t < nTasks; ++t)
+            task(t, id);
+        return;
+    }
+    if (nWorkers == 1) {
+        WorkerScope scope(this, 0);
+        for (int t = 0; t < nTasks; ++t)
+            task(t, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(callMutex);
+    {
+        // Workers still leaving the previous job may hold its pointer.
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+
+        for (int i = 0; i < nWorkers; ++i) {
+            std::lock_guard<std::mutex> rangeLock(ranges[i].mutex);
+            ranges[i].begin = (int)((long long)nTasks * i / nWorkers);
+            ranges[i].end = (int)((long long)nTasks * (i + 1) / nWorkers);
+        }
+        remaining = nTasks;
+        job = &task;
+        ++generation;
+        ++active;
+    }
+    wake.notify_all();
+
+    runTasks(0, task);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    --active;
+    done.wait(lock, [this] { return remaining == 0 && active == 0; });
+    job = 0;
+}
+
+void ThreadPool::workerLoop(const int id)
+{
+    unsigned int seen = 0;
+    for (;;) {
+        const Task *task = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return quit || generation != seen; });
+            if (quit)
+                return;
+            seen = generation;
+            task = job;
+            ++active;
+        }
+        if (task != 0)
+            runTasks(id, *task);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --active;
+        }
+        done.notify_all();
+    }
+}
+
+void ThreadPool::runTasks(const int id, const Task &task)
+{
+    WorkerScope scope(this, id);
+    int t = 0;
+    while (popTask(id, t) || stealTask(id, t)) {
+        task(t, id);
+        if (--remaining == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::popTask(const int id, int &t)
+{
+    Range &own = ranges[id];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin >= own.end)
+        return false;
+    t = own.begin++;
+    return true;
+}
+
+bool ThreadPool::stealTask(const int id, int &t)
+{
+    for (int k = 1; k < nWorkers; ++k) {
+        Range &victim = ranges[(id + k) % nWorkers];
+        int begin = 0;
+        int end = 0;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            const int left = victim.end - victim.begin;
+            if (left <= 0)
+                continue;
+            // Take the back half, rounded up so a single task moves too.
+            end = victim.end;
+            begin = end - (left + 1) / 2;
+            victim.end = begin;
+        }
+        t = begin;
+        Range &own = ranges[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+}
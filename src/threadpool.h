@@ -0,0 +1,77 @@
+/***********************************
+ * threadpool.h
+ *
+ * Work-stealing thread pool for the batched paths.
+ * Only requires the C++11 standard library.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#ifndef _IOU_THREADPOOL_H_FILE_
+#define _IOU_THREADPOOL_H_FILE_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace IOU
+{
+    // A fixed set of workers running indexed tasks.
+    // Each worker owns a contiguous range of task indexes and takes them
+    // from the front. A worker whose range is empty steals the back half
+    // of the range of another worker, so uneven tasks still balance.
+    class ThreadPool {
+    public:
+        // Task to run: (task index, worker index in [0, size())).
+        typedef std::function<void(int, int)> Task;
+
+        // nThreads <= 0 means one worker per hardware thread.
+        // The thread calling parallelFor is worker 0, so nThreads-1
+        // threads are started.
+        explicit ThreadPool(const int nThreads = 0);
+        ~ThreadPool();
+
+        int size() const { return nWorkers; }
+
+        // Run task(i, worker) for every i in [0, nTasks) and wait for all
+        // of them. Tasks must not throw.
+        // Calls from different threads run one after the other. A call
+        // made from within a task of the same pool runs all its tasks
+        // on the calling worker, with that worker's index, instead of
+        // waiting for itself.
+        void parallelFor(const int nTasks, const Task &task);
+
+    private:
+        struct Range {
+            std::mutex mutex;
+            int begin;
+            int end;
+        };
+
+        ThreadPool(const ThreadPool &);
+        ThreadPool& operator=(const ThreadPool &);
+
+        void workerLoop(const int id);
+        void runTasks(const int id, const Task &task);
+        bool popTask(const int id, int &t);
+        bool stealTask(const int id, int &t);
+
+        int nWorkers;
+        std::vector<std::thread> threads;
+        std::vector<Range> ranges;
+
+        std::mutex callMutex;   // One parallelFor at a time.
+        std::mutex mutex;       // Guards the members below.
+        std::condition_variable wake;
+        std::condition_variable done;
+        const Task *job;
+        unsigned int generation;
+        int active;
+        bool quit;
+        std::atomic<int> remaining;
+    };
+}
+#endif // !_IOU_THREADPOOL_H_FILE_
@@ -0,0 +1,131 @@
+/***********************************
+ * bounds.cpp
+ *
+ * Regression tests of the iou bounds and
+ * of the threshold query.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+
+namespace
+{
+
+template <typename T>
+std::vector<Vec2<T> > toScalar(const Vertexes &C)
+{
+    std::vector<Vec2<T> > out;
+    for (size_t k = 0; k < C.size(); ++k)
+        out.push_back(Vec2<T>((T)C[k].x, (T)C[k].y));
+    return out;
+}
+
+template <typename T>
+QuadT<T> toScalar(const Quad &Q)
+{
+    QuadT<T> out;
+    for (int k = 0; k < 4; ++k)
+        out.vert[k] = Vec2<T>((T)Q.vert[k].x, (T)Q.vert[k].y);
+    return out;
+}
+
+// lower <= v <= upper, or both -1 with v if the pair is NoneWise.
+template <typename T>
+bool contains(const IouBoundsT<T> &b, const T v, const bool noneWise)
+{
+    if (noneWise)
+        return b.lower == T(-1) && b.upper == T(-1);
+    return b.lower <= v && v <= b.upper;
+}
+
+// The bounds of every overload against the iou of method, and iouAbove
+// against iou > t at a few thresholds and just around the iou.
+template <typename T>
+void checkPair(const char *name, const Vertexes &A, const Vertexes &B,
+               const InterMethod method, const int k)
+{
+    const std::vector<Vec2<T> > CA = toScalar<T>(A), CB = toScalar<T>(B);
+    const PreparedPolygonT<T> PA(CA), PB(CB);
+    const bool noneWise = whichWiseEx(CA) == NoneWise || whichWiseEx(CB) == NoneWise;
+    const T v = iouEx(CA, CB, method);
+    // The iou of PreparedPolygon rounds its own way.
+    const T prepared = iou(PA, PB, method);
+    if (!contains(iouBoundsEx(CA, CB), v, noneWise))
+        fail(name, "iouBoundsEx misses the iou", k);
+    if (!contains(iouBounds(PA, PB), v, noneWise) ||
+        !contains(iouBounds(PA, PB), prepared, noneWise))
+        fail(name, "iouBounds(PreparedPolygon) misses the iou", k);
+
+    const T thresholds[] = { T(0.1), T(0.3), T(0.5), T(0.7), T(0.9),
+                             v - T(1e-3), v, v + T(1e-3) };
+    for (int i = 0; i < 8; ++i) {
+        const T t = thresholds[i];
+        if (iouAboveEx(CA, CB, t, method) != (!noneWise && v > t))
+            fail(name, "iouAboveEx differs", k);
+        if (iouAbove(PA, PB, t, method) != (!noneWise && prepared > t))
+            fail(name, "iouAbove(PreparedPolygon) differs", k);
+    }
+}
+
+template <typename T>
+void checkQuads(const char *name, const Quad &P, const Quad &Q,
+                const InterMethod method, const int k)
+{
+    const QuadT<T> TP = toScalar<T>(P), TQ = toScalar<T>(Q);
+    const bool noneWise = TP.whichWise() == NoneWise || TQ.whichWise() == NoneWise;
+    const T v = iou(TP, TQ, method);
+    if (!contains(iouBounds(TP, TQ), v, noneWise))
+        fail(name, "iouBounds(Quad) misses the iou", k);
+    const T thresholds[] = { T(0.1), T(0.5), T(0.9), v - T(1e-3), v, v + T(1e-3) };
+    for (int i = 0; i < 6; ++i) {
+        const bool above = !noneWise && v > thresholds[i];
+        if (iouAbove(TP, TQ, thresholds[i], method) != above)
+            fail(name, "iouAbove(Quad) differs", k);
+    }
+}
+
+} // namespace
+
+// iouBoundsEx, iouBounds(Quad) and iouBounds(PreparedPolygon) contain the
+// iou, and iouAboveEx and iouAbove agree with iou > t, in double and
+// float, on overlapping, equal, nested, apart and NoneWise pairs.
+void testBounds()
+{
+    const char *name = "bounds";
+    const InterMethod methods[] = { ConvexClip, RobustSoup };
+    Random r(29);
+    for (int k = 0; k < 4000; ++k) {
+        const double cx = r.uniform(20.0, 40.0), cy = r.uniform(20.0, 40.0);
+        const Vertexes A = randomPolygon(r, cx, cy, 10.0);
+        Vertexes B = randomPolygon(r, cx + r.uniform(-8.0, 8.0), cy + r.uniform(-8.0, 8.0),
+                                   r.uniform(3.0, 15.0));
+        if (k % 8 == 0)
+            B = A;
+        else if (k % 8 == 1) {
+            // Shrunk towards its vertex mean, inside A.
+            Point m;
+            for (size_t i = 0; i < A.size(); ++i)
+                m = m + A[i] * (1.0 / A.size());
+            B = A;
+            for (size_t i = 0; i < B.size(); ++i)
+                B[i] = m + (A[i] - m) * 0.6;
+        }
+        else if (k % 8 == 2)
+            B = randomPolygon(r, cx + 40.0, cy, 10.0);
+        else if (k % 8 == 3)
+            B[2] = B[0] + (B[0] - B[1]);
+        const InterMethod method = methods[k % 2];
+        checkPair<double>(name, A, B, method, k);
+        checkPair<float>(name, A, B, method, k);
+
+        const Quad P = randomQuad(r, cx, cy, 10.0);
+        Quad Q = randomQuad(r, cx + r.uniform(-8.0, 8.0), cy + r.uniform(-8.0, 8.0), 10.0);
+        if (k % 8 == 0)
+            Q = P;
+        else if (k % 8 == 3)
+            Q.vert[2] = Q.vert[0];
+        checkQuads<double>(name, P, Q, method, k);
+        checkQuads<float>(name, P, Q, method, k);
+    }
+}
@@ -0,0 +1,125 @@
+/***********************************
+ * convexset.cpp
+ *
+ * Regression tests of the iou of objects
+ * made of several convex parts.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/convexset.h"
+#include <cmath>
+
+namespace
+{
+
+// Up to n parts, one per cell of a 6 x 6 grid of cells of side 10 shifted
+// by (dx, dy), so that their interiors are disjoint.
+std::vector<Vertexes> cellParts(Random &r, const int n, const double dx, const double dy)
+{
+    std::vector<int> cells(36);
+    for (int i = 0; i < 36; ++i)
+        cells[i] = i;
+    r.shuffle(cells.begin(), cells.end());
+    std::vector<Vertexes> parts;
+    for (int i = 0; i < n; ++i)
+        parts.push_back(randomPolygon(r, dx + 10.0 * (cells[i] % 6) + 5.0,
+                                      dy + 10.0 * (cells[i] / 6) + 5.0, 4.9));
+    return parts;
+}
+
+// The box [x1, x2] x [y1, y2] cut into n strips along x, which share edges.
+std::vector<Vertexes> strips(const double x1, const double y1, const double x2,
+                             const double y2, const int n)
+{
+    std::vector<Vertexes> parts(n);
+    for (int i = 0; i < n; ++i) {
+        const double a = x1 + (x2 - x1) * i / n, b = x1 + (x2 - x1) * (i + 1) / n;
+        parts[i].push_back(Point(a, y1));
+        parts[i].push_back(Point(a, y2));
+        parts[i].push_back(Point(b, y2));
+        parts[i].push_back(Point(b, y1));
+    }
+    return parts;
+}
+
+// The sum of the intersections of every pair of parts, -1 if one is.
+double pairSum(const ConvexSet &S1, const ConvexSet &S2, const InterMethod method)
+{
+    double sum = 0.0;
+    for (int i = 0; i < S1.size(); ++i) {
+        for (int j = 0; j < S2.size(); ++j) {
+            const double a = areaIntersection(S1.part(i), S2.part(j), method);
+            if (a < 0.0)
+                return -1.0;
+            sum += a;
+        }
+    }
+    return sum;
+}
+
+// The set functions against pairSum, up to the order of the sum.
+void checkSets(const char *name, const ConvexSet &S1, const ConvexSet &S2,
+               const InterMethod method, const int k)
+{
+    const double inter = pairSum(S1, S2, method);
+    const double got = areaIntersection(S1, S2, method);
+    if (inter < 0.0) {
+        if (got != -1.0 || areaUnion(S1, S2, method) != -1.0 || iouSet(S1, S2, method) != -1.0)
+            fail(name, "failed pair not -1", k);
+        return;
+    }
+    const double uni = S1.area() + S2.area() - inter;
+    const double slack = 1e-12 * std::max(1.0, uni);
+    if (!(std::fabs(got - inter) <= slack))
+        fail(name, "areaIntersection differs from the sum over pairs", k);
+    if (!(std::fabs(areaUnion(S1, S2, method) - uni) <= slack))
+        fail(name, "areaUnion differs from the sum over pairs", k);
+    const double expected = uni > 0.0 ? inter / uni : 0.0;
+    if (!(std::fabs(iouSet(S1, S2, method) - expected) <= 1e-12))
+        fail(name, "iouSet differs from the sum over pairs", k);
+}
+
+} // namespace
+
+// areaIntersection, areaUnion and iouSet of ConvexSets against the sum
+// over every pair of parts of their PreparedPolygon intersections, for
+// every InterMethod: scattered parts, parts sharing edges, sets apart,
+// empty sets, and NoneWise parts refused.
+void testConvexSet()
+{
+    const char *name = "convexset";
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    Random r(22);
+    for (int k = 0; k < 600; ++k) {
+        const InterMethod method = methods[k % 3];
+        const ConvexSet S1(cellParts(r, 1 + r.index(20), 0.0, 0.0));
+        const ConvexSet S2(cellParts(r, 1 + r.index(20), r.uniform(-5.0, 5.0),
+                                     r.uniform(-5.0, 5.0)));
+        checkSets(name, S1, S2, method, k);
+        checkSets(name, S2, S1, method, k);
+
+        const double x = r.uniform(0.0, 40.0), y = r.uniform(0.0, 40.0);
+        const ConvexSet S3(strips(x, y, x + r.uniform(5.0, 20.0), y + r.uniform(5.0, 20.0),
+                                  1 + r.index(6)));
+        checkSets(name, S1, S3, method, k);
+        checkSets(name, S3, S3, method, k);
+        if (!(std::fabs(iouSet(S3, S3, method) - 1.0) <= 1e-12))
+            fail(name, "iouSet of a set with itself not 1", k);
+
+        const ConvexSet S4(cellParts(r, 1 + r.index(20), 100.0, 0.0));
+        if (iouSet(S1, S4, method) != 0.0 || areaIntersection(S1, S4, method) != 0.0)
+            fail(name, "sets apart overlap", k);
+    }
+
+    ConvexSet S, T;
+    if (iouSet(S, T) != 0.0 || areaUnion(S, T) != 0.0)
+        fail(name, "empty sets not 0", 0);
+    Vertexes segment;
+    segment.push_back(Point(0, 0));
+    segment.push_back(Point(1, 1));
+    segment.push_back(Point(2, 2));
+    if (S.add(segment) || !S.empty())
+        fail(name, "NoneWise part added", 0);
+}
@@ -0,0 +1,181 @@
+/***********************************
+ * evaluator.cpp
+ *
+ * Regression tests of the streaming average
+ * precision evaluator.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/evaluator.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+
+Vertexes box(const double x1, const double y1, const double x2, const double y2)
+{
+    Vertexes C;
+    C.push_back(Point(x1, y1));
+    C.push_back(Point(x1, y2));
+    C.push_back(Point(x2, y2));
+    C.push_back(Point(x2, y1));
+    return C;
+}
+Vertexes segment(const double x1, const double y1, const double x2, const double y2)
+{
+    Vertexes C;
+    C.push_back(Point(x1, y1));
+    C.push_back(Point((x1 + x2) / 2.0, (y1 + y2) / 2.0));
+    C.push_back(Point(x2, y2));
+    return C;
+}
+void addDetection(EvalImage &image, const Vertexes &C, const double score)
+{
+    image.detections.push_back(C);
+    image.scores.push_back(score);
+}
+
+// Five images whose matches are worked out by hand, the ious in the
+// comments. No edges are shared, so that every InterMethod agrees.
+std::vector<EvalImage> handImages()
+{
+    std::vector<EvalImage> images(5);
+    // Two ground truths, a duplicate and a match between the thresholds.
+    EvalImage &a = images[0];
+    a.groundTruths.push_back(box(0, 0, 10, 10));
+    a.groundTruths.push_back(box(20, 0, 30, 10));
+    addDetection(a, box(0.5, 0.2, 10.5, 10.2), 0.9);    // g0: 0.871
+    addDetection(a, box(1, -0.5, 11, 9.5), 0.8);        // g0 again
+    addDetection(a, box(20.5, -1, 29.5, 7), 0.7);       // g1: 0.578
+    // A NoneWise ground truth, never matched, not even by a copy of it.
+    EvalImage &b = images[1];
+    b.groundTruths.push_back(box(0, 0, 10, 10));
+    b.groundTruths.push_back(segment(0, 0, 10, 10));
+    addDetection(b, box(-0.5, 0.5, 9.5, 6.5), 0.7);     // g0: 0.553
+    addDetection(b, segment(1, 1, 9, 9), 0.95);
+    addDetection(b, segment(0, 0, 10, 10), 0.6);
+    // A ground truth without detection.
+    images[2].groundTruths.push_back(box(50, 50, 60, 60));
+    // A detection without ground truth.
+    addDetection(images[3], box(0, 0, 5, 5), 0.5);
+    // Tied scores: the first detection takes the ground truth although
+    // the second overlaps it more.
+    EvalImage &e = images[4];
+    e.groundTruths.push_back(box(100, 0, 110, 10));
+    addDetection(e, box(100.2, 0.3, 110.2, 9.3), 0.4);  // 0.866
+    addDetection(e, box(100.1, 0.1, 110.1, 10.1), 0.4); // 0.961
+    return images;
+}
+
+bool near(const double a, const double b)
+{
+    return std::fabs(a - b) <= 1e-12;
+}
+bool nearAll(const std::vector<double> &a, const double *b, const size_t n)
+{
+    if (a.size() != n)
+        return false;
+    for (size_t i = 0; i < n; ++i)
+        if (!near(a[i], b[i]))
+            return false;
+    return true;
+}
+
+// The counts and curves of handImages at the thresholds 0.5 and 0.75.
+void checkHand(const char *name, const StreamingEvaluator &ev, const int k)
+{
+    if (ev.imageCount() != 5 || ev.groundTruthCount() != 6 || ev.detectionCount() != 9) {
+        fail(name, "counts differ", k);
+        return;
+    }
+    // By bin: 0.95 fp, 0.9 tp, 0.8 fp, 0.7 tp tp, 0.6 fp, 0.5 fp,
+    // 0.4 tp fp.
+    const double precision[] = { 0.0, 1.0/2, 1.0/3, 3.0/5, 3.0/6, 3.0/7, 4.0/9 };
+    const double recall[] = { 0.0, 1.0/6, 1.0/6, 3.0/6, 3.0/6, 3.0/6, 4.0/6 };
+    std::vector<double> p, r;
+    ev.precisionRecall(0, p, r);
+    if (!nearAll(p, precision, 7) || !nearAll(r, recall, 7))
+        fail(name, "precision and recall at 0.5 differ", k);
+    // Made non-increasing: 0.6 up to recall 1/2, then 4/9.
+    const double ap50 = 0.5 * 0.6 + (4.0/6 - 3.0/6) * 4.0/9;
+    if (!near(ev.averagePrecision(0), ap50))
+        fail(name, "AP at 0.5 differs", k);
+
+    // At 0.75 the two matches between the thresholds are lost.
+    const double precision75[] = { 0.0, 1.0/2, 1.0/3, 1.0/5, 1.0/6, 1.0/7, 2.0/9 };
+    const double recall75[] = { 0.0, 1.0/6, 1.0/6, 1.0/6, 1.0/6, 1.0/6, 2.0/6 };
+    ev.precisionRecall(1, p, r);
+    if (!nearAll(p, precision75, 7) || !nearAll(r, recall75, 7))
+        fail(name, "precision and recall at 0.75 differ", k);
+    const double ap75 = 1.0/6 * 0.5 + (2.0/6 - 1.0/6) * 2.0/9;
+    if (!near(ev.averagePrecision(1), ap75))
+        fail(name, "AP at 0.75 differs", k);
+    if (!near(ev.meanAveragePrecision(), (ap50 + ap75) / 2.0))
+        fail(name, "mAP differs", k);
+}
+
+} // namespace
+
+// AP, precision and recall worked out by hand over a few images, image by
+// image and through run, for every InterMethod; then a source that throws,
+// and the edge cases.
+void testEvaluator()
+{
+    const char *name = "evaluator";
+    std::vector<double> thresholds;
+    thresholds.push_back(0.5);
+    thresholds.push_back(0.75);
+    const std::vector<EvalImage> images = handImages();
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    for (int m = 0; m < 3; ++m) {
+        StreamingEvaluator ev(thresholds, 2, 1000, methods[m]);
+        for (size_t i = 0; i < images.size(); ++i)
+            if (!ev.add(images[i]))
+                fail(name, "add rejected an image", m);
+        checkHand(name, ev, m);
+
+        ev.reset();
+        size_t next = 0;
+        const bool ok = ev.run([&](EvalImage &image) {
+            if (next == images.size())
+                return false;
+            image = images[next++];
+            return true;
+        });
+        if (!ok)
+            fail(name, "run rejected an image", m);
+        checkHand(name, ev, m);
+    }
+
+    // Thrown by source after two images: those are added, and run
+    // rethrows.
+    StreamingEvaluator ev(thresholds, 1);
+    size_t next = 0;
+    bool thrown = false;
+    try {
+        ev.run([&](EvalImage &image) {
+            if (next == 2)
+                throw std::runtime_error("source failed");
+            image = images[next++];
+            return true;
+        });
+    }
+    catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    if (!thrown || ev.imageCount() != 2)
+        fail(name, "exception of source not rethrown after its images", 0);
+
+    // A score missing, and no ground truth.
+    ev.reset();
+    EvalImage bad = images[0];
+    bad.scores.pop_back();
+    if (ev.add(bad) || ev.imageCount() != 0)
+        fail(name, "image without a score per detection added", 0);
+    if (!ev.add(images[3]) || ev.averagePrecision(0) != -1.0 ||
+        ev.meanAveragePrecision() != -1.0)
+        fail(name, "AP without ground truths not -1", 0);
+}
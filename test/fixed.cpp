@@ -0,0 +1,79 @@
+/***********************************
+ * fixed.cpp
+ *
+ * Regression tests of the header-only iou
+ * of fixed-size polygons.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/fixed.h"
+#include <cstring>
+
+namespace
+{
+
+template <typename T>
+bool sameBits(const T a, const T b)
+{
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+// Random polygon of N vertexes, made NoneWise one time in ten.
+template <std::size_t N, typename T>
+std::array<Vec2<T>, N> fixedPolygon(Random &r, const int k)
+{
+    const Vertexes C = ellipsePolygon(r, N, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0),
+                                      r.uniform(3.0, 10.0), r.uniform(3.0, 10.0),
+                                      r.uniform(0.0, 3.0),
+                                      r.index(2) ? ClockWise : AntiClockWise);
+    std::array<Vec2<T>, N> out;
+    for (std::size_t i = 0; i < N; ++i)
+        out[i] = Vec2<T>((T)C[i].x, (T)C[i].y);
+    if (k % 10 == 0)
+        out[2] = out[0];
+    return out;
+}
+
+// The fixed-size functions against their Ex counterparts, bit for bit.
+template <std::size_t N, std::size_t M, typename T>
+void checkSizes(const char *name, Random &r, const int k)
+{
+    const std::array<Vec2<T>, N> A = fixedPolygon<N, T>(r, k);
+    const std::array<Vec2<T>, M> B = fixedPolygon<M, T>(r, k + 5);
+    const std::vector<Vec2<T> > CA(A.begin(), A.end()), CB(B.begin(), B.end());
+    if (whichWise(A) != whichWiseEx(CA) || !sameBits(area(A), areaEx(CA)))
+        fail(name, "whichWise or area differs", k);
+    const bool noneWise = whichWiseEx(CA) == NoneWise || whichWiseEx(CB) == NoneWise;
+    const T v = iou(A, B);
+    if (noneWise) {
+        if (v != T(-1))
+            fail(name, "iou of a NoneWise polygon not -1", k);
+        return;
+    }
+    if (!sameBits(areaIntersection(A, B), areaIntersectionEx(CA, CB, ConvexClip)))
+        fail(name, "areaIntersection differs", k);
+    if (!sameBits(v, iouEx(CA, CB, ConvexClip)))
+        fail(name, "iou differs", k);
+}
+
+} // namespace
+
+// whichWise, area, areaIntersection and iou of fixed.h against
+// whichWiseEx, areaEx and the ConvexClip areaIntersectionEx and iouEx, bit
+// for bit, in double and float, for a few pairs of sizes; -1 for NoneWise
+// polygons.
+void testFixed()
+{
+    const char *name = "fixed";
+    Random r(26);
+    for (int k = 0; k < 3000; ++k) {
+        checkSizes<3, 4, double>(name, r, k);
+        checkSizes<4, 4, double>(name, r, k);
+        checkSizes<5, 8, double>(name, r, k);
+        checkSizes<8, 3, double>(name, r, k);
+        checkSizes<4, 4, float>(name, r, k);
+        checkSizes<6, 5, float>(name, r, k);
+    }
+}
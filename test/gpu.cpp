@@ -0,0 +1,173 @@
+/***********************************
+ * gpu.cpp
+ *
+ * Regression tests of the CUDA iou matrix
+ * and NMS, skipped without a device.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cstdio>
+
+#ifdef IOU_ENABLE_CUDA
+#include "../src/gpu.h"
+#include "../src/nms.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+
+// Rounded to float, so that the rectangles and their batch agree.
+double f(const double v)
+{
+    return (float)v;
+}
+
+struct ScoreGreater {
+    const std::vector<float> &scores;
+    explicit ScoreGreater(const std::vector<float> &s) : scores(s) {}
+    bool operator()(const int a, const int b) const { return scores[a] > scores[b]; }
+};
+
+bool isFinite(const RotatedRect &R)
+{
+    return std::isfinite(R.center.x) && std::isfinite(R.center.y) && std::isfinite(R.w) &&
+           std::isfinite(R.h) && std::isfinite(R.theta);
+}
+
+// Greedy NMS over the ious of iouOneToMany at SimdScalar, with the guards
+// of nmsRotated. Sets nearThresh if an iou compared lies within 1e-3 of
+// thresh, where the double iou of nmsRotated may fall on the other side.
+std::vector<int> scalarNms(const std::vector<RotatedRect> &rects,
+                           const RotatedRectBatch &batch, const std::vector<float> &scores,
+                           const double thresh, bool &nearThresh)
+{
+    std::vector<int> order;
+    for (size_t i = 0; i < scores.size(); ++i)
+        if (!std::isnan(scores[i]))
+            order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), ScoreGreater(scores));
+    std::vector<int> keep;
+    std::vector<float> row(rects.size());
+    std::vector<bool> removed(rects.size(), false);
+    for (size_t k = 0; k < order.size(); ++k) {
+        const int i = order[k];
+        if (removed[i])
+            continue;
+        keep.push_back(i);
+        if (!isFinite(rects[i]))
+            continue;
+        iouOneToMany(rects[i], batch, row.data(), SimdScalar);
+        for (size_t l = k + 1; l < order.size(); ++l) {
+            const int j = order[l];
+            if (!isFinite(rects[j]))
+                continue;
+            if (std::fabs(row[j] - thresh) < 1e-3)
+                nearThresh = true;
+            if (row[j] > thresh)
+                removed[j] = true;
+        }
+    }
+    return keep;
+}
+
+} // namespace
+
+// iouMatrixGpu against iouOneToMany at SimdScalar bit for bit, and
+// nmsRotatedGpu against the same greedy pass and against nmsRotated, with
+// NaN scores, non-finite boxes, mismatched sizes and nearly parallel long
+// boxes. Skipped when no CUDA device can be used.
+void testGpu()
+{
+    const char *name = "gpu";
+    if (!gpuAvailable()) {
+        std::printf("gpu: skipped, no CUDA device\n");
+        return;
+    }
+    const double pi = 3.14159265358979323846;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    Random r(27);
+    for (int k = 0; k < 40; ++k) {
+        // Not a multiple of the tiles, for the edges.
+        const int N = 30 + r.index(200);
+        std::vector<RotatedRect> rects(N);
+        std::vector<float> scores(N);
+        RotatedRectBatch batch;
+        std::vector<Quad> quads(N);
+        for (int i = 0; i < N; ++i) {
+            rects[i] = RotatedRect(f(r.uniform(0.0, 200.0)), f(r.uniform(0.0, 200.0)),
+                                   f(r.uniform(5.0, 40.0)), f(r.uniform(5.0, 40.0)),
+                                   f(r.uniform(0.0, pi)));
+            if (k % 4 == 3) {
+                // Long boxes in pairs, the second turned by 1e-7 to 1e-6,
+                // a float ulp or so, and shifted across the first.
+                if (i % 2 == 0)
+                    rects[i] = RotatedRect(rects[i].center.x, rects[i].center.y,
+                                           f(r.uniform(100.0, 300.0)), f(r.uniform(2.0, 8.0)),
+                                           rects[i].theta);
+                else {
+                    const RotatedRect &P = rects[i - 1];
+                    rects[i] = RotatedRect(P.center.x, f(P.center.y + r.uniform(-0.5, 0.5) * P.h),
+                                           P.w, P.h, f(P.theta + r.uniform(1e-7, 1e-6)));
+                }
+            }
+            scores[i] = (float)r.uniform(0.0, 1.0);
+            if (i % 17 == 5)
+                scores[i] = scores[i - 1];
+            if (k % 2 == 1 && i % 23 == 7)
+                scores[i] = nan;
+            if (k % 2 == 1 && i % 29 == 11)
+                rects[i].center.x = std::numeric_limits<double>::infinity();
+            batch.push_back(rects[i]);
+            quads[i] = rects[i].toQuad();
+        }
+        const GpuRotatedRectBatch dBatch(batch);
+        if (dBatch.size() != N) {
+            fail(name, "upload failed", k);
+            continue;
+        }
+
+        std::vector<float> out((size_t)N * N), row(N);
+        if (!iouMatrixGpu(dBatch, dBatch, out.data()))
+            fail(name, "iouMatrixGpu failed", k);
+        for (int i = 0; i < N; ++i) {
+            iouOneToMany(rects[i], batch, row.data(), SimdScalar);
+            for (int j = 0; j < N; ++j) {
+                // NaN payloads may differ between host and device.
+                const float v = out[(size_t)i * N + j];
+                if (std::memcmp(&row[j], &v, sizeof(float)) != 0 &&
+                    !(std::isnan(row[j]) && std::isnan(v)))
+                    fail(name, "iouMatrixGpu and iouOneToMany differ", k);
+            }
+        }
+
+        const double thresh = 0.3 + 0.1 * (k % 4);
+        std::vector<int> keep;
+        if (!nmsRotatedGpu(dBatch, scores, thresh, keep))
+            fail(name, "nmsRotatedGpu failed", k);
+        bool nearThresh = false;
+        if (keep != scalarNms(rects, batch, scores, thresh, nearThresh))
+            fail(name, "nmsRotatedGpu and the scalar greedy pass differ", k);
+        if (!nearThresh && keep != nmsRotated(quads, scores, thresh))
+            fail(name, "nmsRotatedGpu and nmsRotated differ", k);
+
+        scores.pop_back();
+        if (!nmsRotatedGpu(dBatch, scores, thresh, keep) || !keep.empty())
+            fail(name, "nmsRotatedGpu kept boxes of mismatched scores", k);
+        std::fill(scores.begin(), scores.end(), nan);
+        scores.push_back(nan);
+        if (!nmsRotatedGpu(dBatch, scores, thresh, keep) || !keep.empty())
+            fail(name, "nmsRotatedGpu kept boxes of NaN scores", k);
+    }
+}
+#else
+// The CUDA backend is not built.
+void testGpu()
+{
+    std::printf("gpu: skipped, built without IOU_ENABLE_CUDA\n");
+}
+#endif
@@ -0,0 +1,55 @@
+/***********************************
+ * hull.cpp
+ *
+ * Regression tests of the convex hull
+ * and its simplification.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cmath>
+
+// Hulls of shuffled clouds, the vertexes of a convex polygon with points
+// inside and copies moved within the tolerance, come out ClockWise with
+// the area of the polygon, and stay so simplified.
+void testHull()
+{
+    const char *name = "hull";
+    // Equal within the tolerance but not next to each other sorted.
+    Vertexes C;
+    C.push_back(Point(0.0, 0.0));
+    C.push_back(Point(5e-8, 1.0));
+    C.push_back(Point(1e-7, 1e-8));
+    C.push_back(Point(1.0, 100.0));
+    if (convexHullEx(C) != 3 || whichWiseEx(C) != ClockWise)
+        fail(name, "near duplicates not merged", -1);
+
+    Random r(28);
+    const double zero = Tolerance<double>::zero();
+    for (int k = 0; k < 2000; ++k) {
+        const Vertexes P = randomPolygon(r, r.uniform(-100.0, 100.0),
+                                         r.uniform(-100.0, 100.0), r.uniform(0.1, 20.0));
+        Vertexes cloud;
+        for (size_t i = 0; i < P.size(); ++i) {
+            const int copies = 1 + r.index(3);
+            for (int c = 0; c < copies; ++c)
+                cloud.push_back(P[i] + Point(r.uniform(-0.45, 0.45) * zero,
+                                             r.uniform(-0.45, 0.45) * zero));
+            const double t = r.uniform(0.1, 0.9);
+            cloud.push_back(P[i] * t + P[(i + 1) % P.size()] * (1.0 - t) * 0.5 +
+                            P[(i + 2) % P.size()] * (1.0 - t) * 0.5);
+        }
+        r.shuffle(cloud.begin(), cloud.end());
+        Vertexes hull = cloud;
+        if (convexHullEx(hull) > (int)P.size() || whichWiseEx(hull) != ClockWise) {
+            fail(name, "hull not ClockWise", k);
+            continue;
+        }
+        const double area = areaEx(P);
+        if (std::fabs(areaEx(hull) - area) > 1e-5 * (1.0 + area))
+            fail(name, "hull area differs", k);
+        if (simplifyEx(hull, 0.01) < 3 || whichWiseEx(hull) != ClockWise)
+            fail(name, "simplified hull not ClockWise", k);
+    }
+}
@@ -0,0 +1,33 @@
+/***********************************
+ * incremental.cpp
+ *
+ * Regression tests of the incremental
+ * iou.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/incremental.h"
+#include <cmath>
+
+// Incremental updates under random rigid motion against RobustSoup from
+// scratch, to a few tens of ulps as the vertexes of the cycle are solved
+// from other edges than those of RobustSoup.
+void testIncremental()
+{
+    const char *name = "incremental";
+    Random r(24);
+    for (int k = 0; k < 1000; ++k) {
+        const Vertexes A = randomPolygon(r, r.uniform(0.0, 10.0), r.uniform(0.0, 10.0), 5.0);
+        const Vertexes B = randomPolygon(r, r.uniform(0.0, 10.0), r.uniform(0.0, 10.0), 5.0);
+        IncrementalIou inc(A, B);
+        for (int f = 0; f < 50; ++f) {
+            const double angle = r.uniform(-0.5, 0.5);
+            const Point t(r.uniform(-2.0, 2.0), r.uniform(-2.0, 2.0));
+            const double v = (f % 2) ? inc.moveFirst(angle, t) : inc.moveSecond(angle, t);
+            if (std::fabs(v - iouEx(inc.first(), inc.second(), RobustSoup)) > 1e-14)
+                fail(name, "incremental and RobustSoup differ", k);
+        }
+    }
+}
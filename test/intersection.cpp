@@ -0,0 +1,107 @@
+/***********************************
+ * intersection.cpp
+ *
+ * Regression tests of the intersection
+ * polygon output.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cmath>
+
+namespace
+{
+
+// Whether no vertex of C lies on the line through its neighbours.
+bool noCollinear(const Vertexes &C)
+{
+    const int n = C.size();
+    for (int i = 0; i < n; ++i) {
+        const Point &a = C[(i + n - 1) % n], &b = C[i], &c = C[(i + 1) % n];
+        if (std::fabs((b - a) ^ (c - b)) <= Tolerance<double>::zero())
+            return false;
+    }
+    return true;
+}
+
+// out against the area of the intersection and the wise of C1. Each
+// collinear vertex dropped from out takes a sliver of area at most zero/2
+// with it, and there are fewer than nIn of them.
+void checkPolygon(const char *name, const char *what, const int n, const Vertexes &out,
+                  const double area, const WiseType wise, const int nIn, const int k)
+{
+    if (area < 0.0) {
+        if (n != -1 || !out.empty())
+            fail(name, what, k);
+        return;
+    }
+    if (n != (int)out.size() || (n != 0 && n < 3)) {
+        fail(name, what, k);
+        return;
+    }
+    const double outArea = n == 0 ? 0.0 : areaEx(out);
+    const double slack = 1e-12 * std::max(1.0, area) + nIn * Tolerance<double>::zero() / 2.0;
+    if (std::fabs(outArea - area) > slack ||
+        (n > 0 && (whichWiseEx(out) != wise || !noCollinear(out))))
+        fail(name, what, k);
+}
+
+} // namespace
+
+// intersectionPolygonEx and intersectionPolygon for every InterMethod,
+// against areaIntersectionEx: same area up to the dropped collinear
+// vertexes, in the wise of C1 and with no collinear vertex, on random,
+// equal, nested, edge-sharing and NoneWise pairs.
+void testIntersection()
+{
+    const char *name = "intersection";
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    Random r(19);
+    Vertexes out;
+    for (int k = 0; k < 5000; ++k) {
+        const Vertexes A = randomPolygon(r, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0), 10.0);
+        Vertexes B = randomPolygon(r, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0), 10.0);
+        if (k % 6 == 0)
+            B = A;
+        else if (k % 6 == 1) {
+            // Shrunk towards its first vertex, inside A.
+            B = A;
+            for (size_t i = 0; i < B.size(); ++i)
+                B[i] = A[0] + (A[i] - A[0]) * 0.5;
+        }
+        else if (k % 6 == 2) {
+            // The square on the first edge of A, outward or inward.
+            const Point d = A[1] - A[0];
+            B.clear();
+            B.push_back(A[0]);
+            B.push_back(A[1]);
+            B.push_back(A[1] + Point(-d.y, d.x));
+            B.push_back(A[0] + Point(-d.y, d.x));
+        }
+        else if (k % 6 == 3)
+            B[2] = B[0] + (B[0] - B[1]);
+        for (int m = 0; m < 3; ++m) {
+            const double area = areaIntersectionEx(A, B, methods[m]);
+            if (methods[m] == RobustSoup && whichWiseEx(B) != NoneWise && area < 0.0)
+                fail(name, "RobustSoup returned -1", k);
+            const int n = intersectionPolygonEx(A, B, out, methods[m]);
+            checkPolygon(name, "intersectionPolygonEx differs", n, out, area,
+                         whichWiseEx(A), A.size() + B.size(), k);
+        }
+    }
+
+    for (int k = 0; k < 5000; ++k) {
+        const Quad P = randomQuad(r, r.uniform(20.0, 30.0), r.uniform(20.0, 30.0), 10.0);
+        const Quad Q = (k % 5 == 0) ? P : randomQuad(r, r.uniform(20.0, 30.0),
+                                                     r.uniform(20.0, 30.0), 10.0);
+        Vertexes A, B;
+        P.getVertList(A);
+        Q.getVertList(B);
+        for (int m = 0; m < 3; ++m) {
+            const int n = intersectionPolygon(P, Q, out, methods[m]);
+            checkPolygon(name, "intersectionPolygon differs", n, out,
+                         areaIntersectionEx(A, B, methods[m]), P.whichWise(), 8, k);
+        }
+    }
+}
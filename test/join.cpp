@@ -0,0 +1,62 @@
+/***********************************
+ * join.cpp
+ *
+ * Regression tests of the sweep join.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+
+// The sweep join against a double loop, pair by pair and bit for bit.
+// Pairs of disjoint bounding boxes are skipped by the loop as their iou of
+// 0 is above no threshold >= 0, and NoneWise polygons as the join never
+// pairs them.
+void testJoin()
+{
+    const char *name = "join";
+    Random r(16);
+    const std::vector<Vertexes> A = randomPolygons(r, 3000, 300.0, 8.0);
+    const std::vector<Vertexes> B = randomPolygons(r, 3000, 300.0, 8.0);
+    const std::vector<Quad> QA = randomQuads(r, 3000, 300.0, 8.0);
+    const std::vector<Quad> QB = randomQuads(r, 3000, 300.0, 8.0);
+    const std::vector<PolygonView> VA(A.begin(), A.end()), VB(B.begin(), B.end());
+    const double thresholds[] = { 0.0, 0.25, 0.5 };
+    for (int t = 0; t < 3; ++t) {
+        const double thresh = thresholds[t];
+        std::vector<IouPair> brute, quadBrute;
+        for (int i = 0; i < (int)A.size(); ++i) {
+            const AABB a = boundingBoxEx(A[i]), qa = QA[i].boundingBox();
+            const bool valid = whichWiseEx(A[i]) != NoneWise;
+            for (int j = 0; j < (int)B.size(); ++j) {
+                IouPair p;
+                p.i = i;
+                p.j = j;
+                if (valid && whichWiseEx(B[j]) != NoneWise &&
+                    a.overlaps(boundingBoxEx(B[j])) && (p.iou = iouEx(A[i], B[j])) > thresh)
+                    brute.push_back(p);
+                if (qa.overlaps(QB[j].boundingBox()) && (p.iou = iou(QA[i], QB[j])) > thresh)
+                    quadBrute.push_back(p);
+            }
+        }
+        if (!samePairs(iouJoinPairsEx(A, B, thresh), brute))
+            fail(name, "iouJoinPairsEx differs", t);
+        if (!samePairs(iouJoinPairsEx(VA, VB, thresh), brute))
+            fail(name, "iouJoinPairsEx(PolygonView) differs", t);
+        if (!samePairs(iouJoinPairs(QA, QB, thresh), quadBrute))
+            fail(name, "iouJoinPairs differs", t);
+
+        // Streamed in small chunks, in sweep order.
+        std::vector<IouPair> streamed;
+        bool chunksFit = true;
+        iouJoinEx(A, B, thresh, [&](const IouPair *pairs, const int n) {
+            chunksFit = chunksFit && n > 0 && n <= 7;
+            streamed.insert(streamed.end(), pairs, pairs + n);
+        }, 7);
+        std::sort(streamed.begin(), streamed.end(), [](const IouPair &a, const IouPair &b) {
+            return a.i < b.i || (a.i == b.i && a.j < b.j);
+        });
+        if (!chunksFit || !samePairs(streamed, brute))
+            fail(name, "iouJoinEx chunks differ", t);
+    }
+}
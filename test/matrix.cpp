@@ -0,0 +1,60 @@
+/***********************************
+ * matrix.cpp
+ *
+ * Regression tests of the batched iou
+ * matrices.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+
+// iouMatrix(Ex) against iou(Quad) and iouEx pair by pair, bit for bit, and
+// -1 wherever either polygon is NoneWise: with a valid one, with another
+// NoneWise one, and with a copy of itself.
+void testMatrix()
+{
+    const char *name = "matrix";
+    Random r(3);
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    for (int m = 0; m < 3; ++m) {
+        const std::vector<Vertexes> A = randomPolygons(r, 120, 60.0, 10.0);
+        std::vector<Vertexes> B = randomPolygons(r, 90, 60.0, 10.0);
+        B.push_back(A[49]);
+        B.push_back(A[99]);
+        std::vector<Quad> QA = randomQuads(r, 80, 60.0, 10.0);
+        std::vector<Quad> QB = randomQuads(r, 70, 60.0, 10.0);
+        for (size_t i = 7; i < QA.size(); i += 20)
+            QA[i].vert[2] = QA[i].vert[0];
+        for (size_t j = 3; j < QB.size(); j += 20)
+            QB[j].vert[3] = QB[j].vert[1];
+
+        std::vector<double> out(A.size() * B.size());
+        iouMatrixEx(A, B, out.data(), methods[m]);
+        for (size_t i = 0; i < A.size(); ++i) {
+            for (size_t j = 0; j < B.size(); ++j) {
+                const double v = out[i * B.size() + j];
+                if (whichWiseEx(A[i]) == NoneWise || whichWiseEx(B[j]) == NoneWise) {
+                    if (v != -1.0)
+                        fail(name, "NoneWise pair of iouMatrixEx not -1", m);
+                }
+                else if (!(v == iouEx(A[i], B[j], methods[m])))
+                    fail(name, "iouMatrixEx and iouEx differ", m);
+            }
+        }
+
+        std::vector<double> quadOut(QA.size() * QB.size());
+        iouMatrix(QA, QB, quadOut.data(), methods[m]);
+        for (size_t i = 0; i < QA.size(); ++i) {
+            for (size_t j = 0; j < QB.size(); ++j) {
+                const double v = quadOut[i * QB.size() + j];
+                if (QA[i].whichWise() == NoneWise || QB[j].whichWise() == NoneWise) {
+                    if (v != -1.0)
+                        fail(name, "NoneWise pair of iouMatrix not -1", m);
+                }
+                else if (!(v == iou(QA[i], QB[j], methods[m])))
+                    fail(name, "iouMatrix and iou(Quad) differ", m);
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/***********************************
+ * metrics.cpp
+ *
+ * Regression tests of the fused iou, GIoU
+ * and DIoU metrics.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cmath>
+
+namespace
+{
+
+// Axis-aligned box, clockwise or anticlockwise.
+Vertexes box(const double x1, const double y1, const double x2, const double y2,
+             const bool clockwise)
+{
+    Vertexes C;
+    C.push_back(Point(x1, y1));
+    C.push_back(clockwise ? Point(x1, y2) : Point(x2, y1));
+    C.push_back(Point(x2, y2));
+    C.push_back(clockwise ? Point(x2, y1) : Point(x1, y2));
+    return C;
+}
+
+bool near(const double a, const double b)
+{
+    return std::fabs(a - b) <= 1e-12;
+}
+
+// A pair of boxes and its metrics worked out by hand.
+struct HandCase {
+    double a[4], b[4];
+    double iou, giou, diou;
+};
+
+} // namespace
+
+// iouMetricsEx and iouMetrics against iouEx, iou(Quad) and the areas bit
+// for bit, for every InterMethod; GIoU and DIoU of overlapping, apart,
+// diagonal and equal boxes against their closed forms; the metrics not
+// asked for, and NoneWise polygons.
+void testMetrics()
+{
+    const char *name = "metrics";
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    Random r(20);
+    for (int k = 0; k < 3000; ++k) {
+        const Vertexes A = randomPolygon(r, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0), 10.0);
+        const Vertexes B = randomPolygon(r, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0), 10.0);
+        const Quad P = randomQuad(r, r.uniform(20.0, 30.0), r.uniform(20.0, 30.0), 10.0);
+        const Quad Q = randomQuad(r, r.uniform(20.0, 30.0), r.uniform(20.0, 30.0), 10.0);
+        for (int m = 0; m < 3; ++m) {
+            const IouMetrics e = iouMetricsEx(A, B, MetricAll, methods[m]);
+            if (!(e.iou == iouEx(A, B, methods[m])) ||
+                !(e.intersection == areaIntersectionEx(A, B, methods[m])) ||
+                !(e.unionArea == areaUnionEx(A, B, methods[m])))
+                fail(name, "iouMetricsEx and iouEx differ", k);
+            // Up to rounding when the hull is the union.
+            if (e.iou >= 0.0 && !(e.diou <= e.iou && e.giou <= e.iou + 1e-12 && e.giou > -1.0))
+                fail(name, "GIoU or DIoU of iouMetricsEx out of range", k);
+            const IouMetrics q = iouMetrics(P, Q, MetricAll, methods[m]);
+            if (!(q.iou == iou(P, Q, methods[m])))
+                fail(name, "iouMetrics and iou(Quad) differ", k);
+        }
+    }
+
+    const HandCase cases[] = {
+        // Overlapping by half a box: the hull is the union.
+        { { 0, 0, 2, 2 }, { 1, 0, 3, 2 }, 1.0/3, 1.0/3, 1.0/3 - 1.0/13 },
+        // Apart along x: the hull is their bounding box.
+        { { 0, 0, 1, 1 }, { 2, 0, 3, 1 }, 0.0, -1.0/3, -4.0/10 },
+        // Apart along the diagonal: the hull is the hexagon of area 5.
+        { { 0, 0, 1, 1 }, { 2, 2, 3, 3 }, 0.0, -3.0/5, -8.0/18 },
+        // Nested, centred: the hull is the outer box.
+        { { 0, 0, 4, 4 }, { 1, 1, 3, 3 }, 4.0/16, 4.0/16, 4.0/16 },
+        { { 0, 0, 2, 3 }, { 0, 0, 2, 3 }, 1.0, 1.0, 1.0 }
+    };
+    for (int c = 0; c < 5; ++c) {
+        const HandCase &h = cases[c];
+        for (int w = 0; w < 4; ++w) {
+            const Vertexes A = box(h.a[0], h.a[1], h.a[2], h.a[3], w % 2 == 0);
+            const Vertexes B = box(h.b[0], h.b[1], h.b[2], h.b[3], w / 2 == 0);
+            for (int m = 0; m < 3; ++m) {
+                const IouMetrics e = iouMetricsEx(A, B, MetricAll, methods[m]);
+                if (!near(e.iou, h.iou) || !near(e.giou, h.giou) || !near(e.diou, h.diou))
+                    fail(name, "metrics of a box pair differ from the closed form", c);
+                const IouMetrics g = iouMetricsEx(A, B, MetricGIou, methods[m]);
+                const IouMetrics d = iouMetricsEx(A, B, MetricDIou, methods[m]);
+                const IouMetrics i = iouMetricsEx(A, B, MetricIou, methods[m]);
+                if (!near(g.giou, h.giou) || g.diou != 0.0 || !near(d.diou, h.diou) ||
+                    d.giou != 0.0 || i.giou != 0.0 || i.diou != 0.0 || !near(i.iou, h.iou))
+                    fail(name, "metrics not asked for not 0", c);
+            }
+        }
+    }
+
+    Vertexes segment;
+    segment.push_back(Point(0, 0));
+    segment.push_back(Point(1, 1));
+    segment.push_back(Point(2, 2));
+    const IouMetrics n = iouMetricsEx(box(0, 0, 2, 2, true), segment);
+    if (n.intersection != -1.0 || n.unionArea != -1.0 || n.iou != -1.0 ||
+        n.giou != -1.0 || n.diou != -1.0)
+        fail(name, "metrics of a NoneWise polygon not -1", 0);
+}
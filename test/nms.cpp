@@ -0,0 +1,173 @@
+/***********************************
+ * nms.cpp
+ *
+ * Regression tests of the rotated-box NMS.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/nms.h"
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+bool isFinite(const Vertexes &C)
+{
+    for (size_t i = 0; i < C.size(); ++i)
+        if (!std::isfinite(C[i].x) || !std::isfinite(C[i].y))
+            return false;
+    return true;
+}
+
+// Greedy NMS as a plain O(N^2) loop over every later box.
+template <class Iou>
+std::vector<int> bruteNms(const std::vector<Vertexes> &P, const std::vector<float> &scores,
+                          const double thresh, Iou iouOf)
+{
+    const int N = P.size();
+    std::vector<int> order;
+    for (int i = 0; i < N; ++i)
+        if (!std::isnan(scores[i]))
+            order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&](const int i, const int j) {
+        return scores[i] > scores[j];
+    });
+    std::vector<char> suppressed(N, 0);
+    std::vector<int> keep;
+    for (size_t k = 0; k < order.size(); ++k) {
+        const int i = order[k];
+        if (suppressed[i])
+            continue;
+        keep.push_back(i);
+        for (size_t m = k + 1; m < order.size(); ++m) {
+            const int j = order[m];
+            if (isFinite(P[i]) && isFinite(P[j]) && iouOf(i, j) > thresh)
+                suppressed[j] = 1;
+        }
+    }
+    return keep;
+}
+
+// Soft-NMS as a plain loop: the box of highest score, lowest index first,
+// decays every other box left.
+template <class Iou>
+std::vector<int> bruteSoftNms(const std::vector<Vertexes> &P, const std::vector<float> &scores,
+                              const SoftNMSMethod method, const double thresh,
+                              const double sigma, const double scoreThresh,
+                              std::vector<float> &keptScores, Iou iouOf)
+{
+    const int N = P.size();
+    std::vector<float> cur(scores);
+    std::vector<char> done(N, 0);
+    for (int i = 0; i < N; ++i)
+        done[i] = !(cur[i] >= scoreThresh);
+    std::vector<int> keep;
+    keptScores.clear();
+    for (;;) {
+        int i = -1;
+        for (int j = 0; j < N; ++j)
+            if (!done[j] && (i < 0 || cur[j] > cur[i]))
+                i = j;
+        if (i < 0)
+            break;
+        done[i] = 1;
+        keep.push_back(i);
+        keptScores.push_back(cur[i]);
+        for (int j = 0; j < N; ++j) {
+            if (done[j] || !isFinite(P[i]) || !isFinite(P[j]))
+                continue;
+            const double o = iouOf(i, j);
+            if (!(o > 0.0))
+                continue;
+            const double w = method == SoftNMSLinear ? (o > thresh ? 1.0 - o : 1.0)
+                                                     : (sigma > 0.0 ? std::exp(-o*o / sigma) : 0.0);
+            if (w >= 1.0)
+                continue;
+            cur[j] = (float)(cur[j] * w);
+            if (cur[j] < scoreThresh)
+                done[j] = 1;
+        }
+    }
+    return keep;
+}
+
+} // namespace
+
+// Greedy and Soft-NMS over the grid against plain loops over every pair,
+// on clustered boxes with tied and NaN scores and boxes with an infinite
+// or NaN coordinate, then on empty and mismatched inputs.
+void testNms()
+{
+    const char *name = "nms";
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    Random r(6);
+    for (int k = 0; k < 40; ++k) {
+        const int N = 50 + r.index(250);
+        std::vector<Quad> Q = randomQuads(r, N, 100.0, 12.0);
+        std::vector<float> scores(N);
+        for (int i = 0; i < N; ++i)
+            scores[i] = (float)(r.index(20) / 20.0);
+        for (int i = 0; i < N; i += 17)
+            scores[i] = nan;
+        for (int i = 5; i < N; i += 23)
+            Q[i].vert[r.index(4)].x = (i % 2) ? inf : std::numeric_limits<double>::quiet_NaN();
+        std::vector<Vertexes> P(N);
+        std::vector<PreparedPolygon> prepared(N);
+        for (int i = 0; i < N; ++i) {
+            Q[i].getVertList(P[i]);
+            prepared[i] = PreparedPolygon(P[i]);
+        }
+        const auto quadIou = [&](const int i, const int j) { return iou(Q[i], Q[j]); };
+        const auto polyIou = [&](const int i, const int j) {
+            return iou(prepared[i], prepared[j]);
+        };
+
+        const double thresholds[] = { 0.0, 0.3, 0.7 };
+        for (int t = 0; t < 3; ++t) {
+            const double thresh = thresholds[t];
+            if (nmsRotated(Q, scores, thresh) != bruteNms(P, scores, thresh, quadIou))
+                fail(name, "nmsRotated differs", k);
+            if (nmsRotatedEx(P, scores, thresh) != bruteNms(P, scores, thresh, polyIou))
+                fail(name, "nmsRotatedEx differs", k);
+
+            const SoftNMSMethod method = (t % 2) ? SoftNMSGaussian : SoftNMSLinear;
+            const double sigma = (t == 2) ? 0.0 : 0.5;
+            std::vector<float> kept, bruteKept;
+            if (softNmsRotated(Q, scores, method, thresh, sigma, 0.01, &kept) !=
+                    bruteSoftNms(P, scores, method, thresh, sigma, 0.01, bruteKept,
+                                 quadIou) ||
+                kept != bruteKept)
+                fail(name, "softNmsRotated differs", k);
+            if (softNmsRotatedEx(P, scores, method, thresh, sigma, 0.01, &kept) !=
+                    bruteSoftNms(P, scores, method, thresh, sigma, 0.01, bruteKept,
+                                 polyIou) ||
+                kept != bruteKept)
+                fail(name, "softNmsRotatedEx differs", k);
+        }
+    }
+
+    // Empty, NaN and mismatched inputs.
+    Random e(60);
+    const std::vector<Quad> Q = randomQuads(e, 10, 20.0, 8.0);
+    const std::vector<float> scores(10, 0.5f), nanScores(10, nan);
+    std::vector<float> kept(3, 1.0f);
+    if (!nmsRotated(std::vector<Quad>(), std::vector<float>(), 0.5).empty() ||
+        !softNmsRotated(std::vector<Quad>(), std::vector<float>(), SoftNMSLinear, 0.5,
+                        0.5, 0.001, &kept).empty() || !kept.empty())
+        fail(name, "empty input keeps a box", 0);
+    if (!nmsRotated(Q, nanScores, 0.5).empty() ||
+        !softNmsRotated(Q, nanScores, SoftNMSGaussian, 0.5).empty())
+        fail(name, "NaN scores keep a box", 0);
+    if (!softNmsRotated(Q, scores, SoftNMSLinear, 0.5, 0.5, std::nan("")).empty())
+        fail(name, "NaN scoreThresh keeps a box", 0);
+    kept.assign(3, 1.0f);
+    const std::vector<float> fewer(9, 0.5f);
+    if (!nmsRotated(Q, fewer, 0.5).empty() ||
+        !softNmsRotated(Q, fewer, SoftNMSLinear, 0.5, 0.5, 0.001, &kept).empty() ||
+        !kept.empty())
+        fail(name, "mismatched scores keep a box", 0);
+}
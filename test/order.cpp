@@ -0,0 +1,208 @@
+/***********************************
+ * order.cpp
+ *
+ * Regression tests of the vertex order,
+ * and a fixed set of pairs bit for bit.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+
+namespace
+{
+
+// Results of a fixed set of pairs, pinned bit for bit: a change of the
+// ordering or of the intersection that moves any of them by an ulp
+// shows here. Pairs of quads also go through iou(Quad), -2 otherwise.
+struct RegressionCase {
+    int n1;
+    double C1[8][2];
+    int n2;
+    double C2[8][2];
+    double inter;
+    double iouEx;
+    double iouQuad;
+};
+const RegressionCase regressionSet[] = {
+    { 4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      100, 1, 1 },
+    { 4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      4, { { 5, 5 }, { 5, 15 }, { 15, 15 }, { 15, 5 } },
+      25, 0.14285714285714285, 0.14285714285714285 },
+    { 4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      4, { { 10, 0 }, { 10, 10 }, { 20, 10 }, { 20, 0 } },
+      0, 0, 0 },
+    { 4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      4, { { 10, 10 }, { 10, 15 }, { 15, 15 }, { 15, 10 } },
+      0, 0, 0 },
+    { 4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      4, { { 6, 2 }, { 6, 6 }, { 2, 6 }, { 2, 2 } },
+      16, 0.16, 0.16 },
+    { 4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      4, { { 20, 20 }, { 20, 25 }, { 25, 25 }, { 25, 20 } },
+      0, 0, 0 },
+    { 4, { { 0, 0 }, { 0, 4 }, { 10, 4 }, { 10, 0 } },
+      4, { { 3, -2 }, { 3, 6 }, { 7, 6 }, { 7, -2 } },
+      16, 0.2857142857142857, 0.2857142857142857 },
+    { 4, { { 0, 5 }, { 5, 10 }, { 10, 5 }, { 5, 0 } },
+      4, { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } },
+      50, 0.5, 0.5 },
+    { 4, { { 42.75, 39.33 }, { 51.21, 31.7 }, { 44.43, 21.69 }, { 34.66, 34.18 } },
+      4, { { 32.33, 30.57 }, { 24.23, 16.84 }, { 26.18, 16.51 }, { 29.71, 17.1 } },
+      0, 0, 0 },
+    { 4, { { 46.39, 46.74 }, { 40.26, 44.98 }, { 30.28, 29.51 }, { 58.3, 42.03 } },
+      4, { { 32.43, 50.04 }, { 50.32, 29.42 }, { 49.21, 28.16 }, { 34.38, 21.95 } },
+      61.38004702721237, 0.17297282376652942, 0.17297282376652942 },
+    { 4, { { 37.52, 31.77 }, { 33.72, 37.51 }, { 32.85, 52.44 }, { 34.39, 55.08 } },
+      4, { { 29.8, 42.89 }, { 27.95, 40.15 }, { 28.96, 33.66 }, { 50.13, 39.32 } },
+      17.779732195579413, 0.13380295381880664, 0.13380295381880664 },
+    { 4, { { 32.95, 49.25 }, { 39.34, 33.92 }, { 44.49, 29.08 }, { 50.12, 44.81 } },
+      4, { { 49.89, 57.57 }, { 44, 57.21 }, { 39.29, 56.1 }, { 62.45, 47.59 } },
+      0, 0, 0 },
+    { 4, { { 61.79, 34.76 }, { 59.66, 28.16 }, { 44.58, 25.72 }, { 43, 26.34 } },
+      4, { { 57.5, 49.14 }, { 28.6, 26.19 }, { 51.44, 52.19 }, { 54.8, 51.32 } },
+      0, 0, 0 },
+    { 4, { { 18.54, 47.73 }, { 16.28, 37.38 }, { 48.88, 43.68 }, { 48.82, 45.47 } },
+      4, { { 29.11, 44.46 }, { 24.35, 30.5 }, { 33.93, 18.05 }, { 51.59, 23.26 } },
+      13.176149236267964, 0.025451397849133833, 0.025451397849133833 },
+    { 4, { { 44.8, 64.19 }, { 46.42, 61.06 }, { 30.18, 44.24 }, { 31.57, 57.48 } },
+      4, { { 41.45, 58.54 }, { 27.34, 47.29 }, { 45.3, 44.25 }, { 57.95, 53.32 } },
+      43.288726826856873, 0.14009912274559611, 0.14009912274559611 },
+    { 4, { { 35.69, 65.88 }, { 32.68, 66.43 }, { 47.96, 51.7 }, { 45.32, 58.82 } },
+      4, { { 45.14, 33.28 }, { 17.55, 29.4 }, { 14.13, 36.24 }, { 22.51, 54.6 } },
+      0, 0, 0 },
+    { 4, { { 49.51, 41.26 }, { 39.44, 19.25 }, { 25.06, 32.34 }, { 26.01, 43.58 } },
+      4, { { 33.09, 33.23 }, { 28.8, 26.28 }, { 28.81, 25.75 }, { 47.16, 22.5 } },
+      63.439452844222245, 0.1711581314330787, 0.1711581314330787 },
+    { 4, { { 40.76, 59.39 }, { 33.72, 55.19 }, { 31.45, 38.4 }, { 48.57, 57.07 } },
+      4, { { 42.28, 63.23 }, { 19.21, 46.17 }, { 19.31, 45.38 }, { 20.29, 41.65 } },
+      0.17891305222613826, 0.00085821291973142309, 0.00085821291973142309 },
+    { 4, { { 53.73, 53.64 }, { 35.72, 35.58 }, { 38.59, 45.92 }, { 41.52, 52.38 } },
+      4, { { 40.48, 50.29 }, { 52.67, 41.27 }, { 50.45, 35.93 }, { 34.44, 42.53 } },
+      45.842185420206093, 0.24974480161094265, 0.24974480161094265 },
+    { 4, { { 32.7, 38.69 }, { 36.01, 33.96 }, { 56.96, 28.7 }, { 65.14, 34.4 } },
+      4, { { 50.53, 28.93 }, { 52.76, 29.05 }, { 29.41, 59.52 }, { 27.42, 58.52 } },
+      16.063961260678621, 0.076078545777591336, 0.076078545777591336 },
+    { 4, { { 43.41, 53.54 }, { 48.42, 47.25 }, { 48.56, 45.13 }, { 33.67, 42.74 } },
+      4, { { 26.83, 44.99 }, { 34.32, 39.67 }, { 58.08, 44.65 }, { 52.27, 48.7 } },
+      40.696555289603523, 0.22981277711990289, 0.22981277711990289 },
+    { 4, { { 33.96, 15.83 }, { 39.75, 14.9 }, { 42.32, 17.8 }, { 43.33, 20.52 } },
+      4, { { 51.42, 23.44 }, { 47.63, 16.76 }, { 33.74, 23.52 }, { 34.01, 25.02 } },
+      0.97078856690363469, 0.01061340998183515, 0.01061340998183515 },
+    { 4, { { 51.03, 35.22 }, { 48.69, 29.11 }, { 25.26, 58.12 }, { 31.69, 59.11 } },
+      4, { { 34.52, 42.43 }, { 51.62, 37.54 }, { 53.55, 40.38 }, { 36.47, 43.58 } },
+      20.70574479661412, 0.097147992719748666, 0.097147992719748666 },
+    { 4, { { 52.44, 51.51 }, { 51.67, 52.02 }, { 37.01, 52.55 }, { 35.81, 24.69 } },
+      4, { { 47.51, 50.72 }, { 42.05, 35.36 }, { 60.15, 35.2 }, { 58.91, 39.37 } },
+      30.920817451988384, 0.089793658705917365, 0.089793658705917365 },
+    { 3, { { 54.16, 40.8 }, { 45.05, 32.78 }, { 23.03, 29.66 } },
+      3, { { 40.76, 41.32 }, { 45.63, 31.73 }, { 44.52, 27.96 } },
+      6.0385547438602813, 0.073148102701551157, -2 },
+    { 4, { { 18.97, 21.12 }, { 20.3, 19.08 }, { 38.17, 47.12 }, { 34.81, 45.85 } },
+      3, { { 13.28, 45.39 }, { 29.55, 52.08 }, { 24.81, 55.33 } },
+      0, 0, -2 },
+    { 5, { { 41.49, 60.83 }, { 45.64, 58.24 }, { 49.48, 54.64 }, { 50.1, 53.96 },
+           { 51.14, 36.21 } },
+      4, { { 34.35, 37.54 }, { 37.64, 36.4 }, { 47.88, 44.76 }, { 51.45, 67.35 } },
+      36.346479593632097, 0.18235933074078933, -2 },
+    { 6, { { 38.9, 38.03 }, { 39.64, 33.52 }, { 49.15, 28.35 }, { 52.81, 34.2 },
+           { 50.16, 38.02 }, { 49.63, 38.47 } },
+      4, { { 54.59, 42.76 }, { 37.34, 46.91 }, { 36.13, 59.74 }, { 44.84, 56.59 } },
+      0, 0, -2 },
+    { 7, { { 54.87, 45.48 }, { 54.87, 28.79 }, { 54.32, 28.03 }, { 44.9, 22.48 },
+           { 41.83, 22.53 }, { 32.81, 41 }, { 50.13, 49.22 } },
+      5, { { 45.5, 34.36 }, { 46, 33.67 }, { 46.65, 32.91 }, { 55.64, 40.32 },
+           { 51.44, 47.22 } },
+      57.580376334816478, 0.14491559917823529, -2 },
+    { 8, { { 46.42, 42.3 }, { 29.63, 45.18 }, { 25.51, 38.75 }, { 27.45, 31.64 },
+           { 30.86, 29.28 }, { 34.83, 28.5 }, { 46.59, 36.52 }, { 47, 38.79 } },
+      5, { { 18.25, 42.34 }, { 24.5, 25.08 }, { 27.11, 23.9 }, { 46.59, 38.13 },
+           { 42.36, 46.23 } },
+      222.36827822003249, 0.56843184960890525, -2 },
+    { 3, { { 47.36, 29.12 }, { 45.68, 24.01 }, { 41.04, 19.82 } },
+      6, { { 35.29, 27.77 }, { 35.73, 22.74 }, { 33.6, 21.12 }, { 22.82, 21.76 },
+           { 20.09, 28.68 }, { 24.79, 31 } },
+      0, 0, -2 },
+    { 4, { { 30.1, 41.92 }, { 32.16, 37.19 }, { 46.44, 23.16 }, { 42.63, 39.51 } },
+      6, { { 52.3, 30.17 }, { 55.75, 36.65 }, { 55.67, 39.92 }, { 52.19, 43.12 },
+           { 46.04, 40.55 }, { 44.67, 39.01 } },
+      0, 0, -2 },
+    { 5, { { 42.37, 55.91 }, { 55.93, 51.87 }, { 62.09, 36.09 }, { 59.03, 31.23 },
+           { 40.96, 31.71 } },
+      7, { { 32.62, 57.06 }, { 30.21, 52.16 }, { 31.36, 39 }, { 31.48, 38.73 },
+           { 31.99, 37.7 }, { 33.84, 34.81 }, { 50.68, 30.77 } },
+      51.876338089524431, 0.091205104406237136, -2 },
+    { 6, { { 30.65, 49.77 }, { 27.2, 32.25 }, { 27.27, 32 }, { 30.98, 29.2 },
+           { 32.86, 30.19 }, { 42.18, 54.85 } },
+      7, { { 54.37, 48.21 }, { 48.66, 42.67 }, { 39.08, 40.32 }, { 38.47, 40.31 },
+           { 22.8, 47.67 }, { 24.05, 55.97 }, { 28.55, 59.43 } },
+      86.964558500611219, 0.20087722152629897, -2 },
+    { 7, { { 53.81, 47.15 }, { 47.11, 40.64 }, { 45.64, 40.44 }, { 40.26, 41.27 },
+           { 40.19, 41.3 }, { 36.63, 44.62 }, { 39.59, 51.37 } },
+      8, { { 54.13, 47.48 }, { 52.38, 47.65 }, { 50.55, 36.17 }, { 51.86, 34.87 },
+           { 54, 33.75 }, { 55.05, 33.58 }, { 56.66, 33.83 }, { 57.23, 34.1 } },
+      1.633140536864504, 0.0096608890414962654, -2 },
+    { 8, { { 49.3, 50.75 }, { 24.45, 51.93 }, { 16.52, 49.18 }, { 19.12, 40.61 },
+           { 24.19, 39.8 }, { 25.69, 39.69 }, { 28.55, 39.62 }, { 51.17, 46.12 } },
+      8, { { 11.15, 59.41 }, { 10.73, 58.94 }, { 9.31, 57.01 }, { 7.22, 51.85 },
+           { 7.93, 45.04 }, { 32.58, 40.3 }, { 38.08, 44.92 }, { 41.34, 56.78 } },
+      197.56864491371809, 0.33211752173517034, -2 },
+    { 3, { { 56.82, 42.37 }, { 59.07, 40.08 }, { 57.1, 16.69 } },
+      3, { { 68.4, 23.93 }, { 48.76, 12.5 }, { 42.63, 27.11 } },
+      3.4923838604933781, 0.017154833531770306, -2 },
+    { 4, { { 49.46, 53.19 }, { 35.25, 52.91 }, { 39.78, 45.49 }, { 51.21, 34.71 } },
+      3, { { 39.08, 47.85 }, { 66.55, 29.69 }, { 67.06, 39.29 } },
+      23.117434118227575, 0.087931297648823112, -2 },
+    { 5, { { 45.52, 49.03 }, { 45.93, 47.63 }, { 44.6, 45.14 }, { 42.27, 43.84 },
+           { 28.64, 42.82 } },
+      4, { { 20.18, 29.13 }, { 23.11, 28.18 }, { 26.5, 28.85 }, { 31.58, 44.67 } },
+      0.4049250829917439, 0.004402463806624457, -2 },
+    { 6, { { 40.69, 52 }, { 37.12, 52.86 }, { 36.7, 52.86 }, { 35.36, 52.75 },
+           { 29.05, 39.1 }, { 40.36, 36.12 } },
+      4, { { 28.57, 59.05 }, { 31.69, 61.61 }, { 33.14, 62.56 }, { 41.07, 65.47 } },
+      0, 0, -2 },
+    // Touching at one corner only, a soup of 1 point.
+    { 4, { { 59.393101552656191, 64.312899418214414 }, { 59.412676401863251, 64.291633080896929 },
+           { 58.183747586580317, 52.997887849309194 }, { 46.565437942218843, 53.766130812847685 } },
+      4, { { 48.073352701667957, 83.598489766188905 }, { 58.406437319075735, 63.501696515569925 },
+           { 55.724369750951013, 63.532313890683966 }, { 45.981804344377203, 73.377139025895104 } },
+      0, 0, 0 },
+};
+
+} // namespace
+
+// The regression set, and the quadrant order against the theta order it
+// replaced.
+void testOrder()
+{
+    const char *name = "order";
+    const int N = sizeof(regressionSet) / sizeof(regressionSet[0]);
+    for (int k = 0; k < N; ++k) {
+        const RegressionCase &c = regressionSet[k];
+        Vertexes C1(c.n1), C2(c.n2);
+        for (int i = 0; i < c.n1; ++i)
+            C1[i] = Point(c.C1[i][0], c.C1[i][1]);
+        for (int i = 0; i < c.n2; ++i)
+            C2[i] = Point(c.C2[i][0], c.C2[i][1]);
+        if (!(areaIntersectionEx(C1, C2) == c.inter) || !(iouEx(C1, C2) == c.iouEx))
+            fail(name, "iouEx moved", k);
+        if (c.n1 == 4 && c.n2 == 4 && !(iou(Quad(C1.data()), Quad(C2.data())) == c.iouQuad))
+            fail(name, "iou(Quad) moved", k);
+    }
+
+    Random r(11);
+    for (int k = 0; k < 20000; ++k) {
+        Vertexes C = ellipsePolygon(r, 3 + k % 10, r.uniform(-50.0, 50.0), r.uniform(-50.0, 50.0),
+                                    r.uniform(0.1, 30.0), r.uniform(0.1, 30.0),
+                                    r.uniform(0.0, 3.0), AntiClockWise);
+        r.shuffle(C.begin(), C.end());
+        const WiseType wise = (k % 2) ? ClockWise : AntiClockWise;
+        Vertexes byQuadrant = C, byTheta = C;
+        beInSomeWiseEx(byQuadrant, wise, QuadrantOrder);
+        beInSomeWiseEx(byTheta, wise, ThetaOrder);
+        if (byQuadrant != byTheta)
+            fail(name, "quadrant and theta orders differ", k);
+    }
+}
@@ -0,0 +1,97 @@
+/***********************************
+ * parallel.cpp
+ *
+ * Regression tests of the parallel iou
+ * matrices and of the thread pool.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/threadpool.h"
+#include <cstring>
+
+namespace
+{
+
+template <typename T>
+bool sameBits(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() == b.size() &&
+           std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+template <typename T>
+std::vector<std::vector<Vec2<T> > > toScalar(const std::vector<Vertexes> &P)
+{
+    std::vector<std::vector<Vec2<T> > > out(P.size());
+    for (size_t i = 0; i < P.size(); ++i)
+        for (size_t k = 0; k < P[i].size(); ++k)
+            out[i].push_back(Vec2<T>((T)P[i][k].x, (T)P[i][k].y));
+    return out;
+}
+
+template <typename T>
+std::vector<QuadT<T> > toScalar(const std::vector<Quad> &Q)
+{
+    std::vector<QuadT<T> > out(Q.size());
+    for (size_t i = 0; i < Q.size(); ++i)
+        for (int k = 0; k < 4; ++k)
+            out[i].vert[k] = Vec2<T>((T)Q[i].vert[k].x, (T)Q[i].vert[k].y);
+    return out;
+}
+
+// The parallel matrices of A and B, against the serial ones bit for bit.
+template <typename T>
+void checkMatrices(const char *name, const std::vector<Vertexes> &A,
+                   const std::vector<Vertexes> &B, const std::vector<Quad> &QA,
+                   const std::vector<Quad> &QB, const int nThreads)
+{
+    const std::vector<std::vector<Vec2<T> > > PA = toScalar<T>(A), PB = toScalar<T>(B);
+    const std::vector<QuadT<T> > TA = toScalar<T>(QA), TB = toScalar<T>(QB);
+    std::vector<T> serial(A.size() * B.size()), parallel(serial.size(), T(7));
+    iouMatrixEx(PA, PB, serial.data());
+    iouMatrixParallelEx(PA, PB, parallel.data(), nThreads);
+    if (!sameBits(serial, parallel))
+        fail(name, "iouMatrixParallelEx differs", nThreads);
+
+    std::vector<T> quadSerial(QA.size() * QB.size()), quadParallel(quadSerial.size(), T(7));
+    iouMatrix(TA, TB, quadSerial.data(), ConvexClip);
+    ThreadPool pool(nThreads);
+    iouMatrixParallel(TA, TB, quadParallel.data(), pool, ConvexClip);
+    if (!sameBits(quadSerial, quadParallel))
+        fail(name, "iouMatrixParallel differs", nThreads);
+}
+
+} // namespace
+
+// iouMatrixParallel(Ex) against iouMatrix(Ex) bit for bit, for a single
+// worker, a few, and more workers than tiles; then a matrix run on a pool
+// from within a task of that same pool.
+void testParallel()
+{
+    const char *name = "parallel";
+    Random r(4);
+    const std::vector<Vertexes> A = randomPolygons(r, 150, 100.0, 10.0);
+    const std::vector<Vertexes> B = randomPolygons(r, 200, 100.0, 10.0);
+    const std::vector<Quad> QA = randomQuads(r, 130, 100.0, 10.0);
+    const std::vector<Quad> QB = randomQuads(r, 70, 100.0, 10.0);
+    const int threadCounts[] = { 1, 2, 3, 8, 40 };
+    for (int c = 0; c < 5; ++c) {
+        checkMatrices<double>(name, A, B, QA, QB, threadCounts[c]);
+        checkMatrices<float>(name, A, B, QA, QB, threadCounts[c]);
+    }
+
+    std::vector<double> serial(A.size() * B.size());
+    iouMatrixEx(A, B, serial.data());
+    for (int c = 0; c < 5; ++c) {
+        ThreadPool pool(threadCounts[c]);
+        std::vector<std::vector<double> > nested(6, std::vector<double>(serial.size()));
+        pool.parallelFor(nested.size(), [&](const int t, int) {
+            iouMatrixParallelEx(A, B, nested[t].data(), pool);
+        });
+        for (size_t t = 0; t < nested.size(); ++t)
+            if (!sameBits(serial, nested[t]))
+                fail(name, "nested iouMatrixParallelEx differs", threadCounts[c]);
+    }
+}
@@ -0,0 +1,124 @@
+/***********************************
+ * rect.cpp
+ *
+ * Regression tests of the iou of axis-aligned
+ * and rotated rectangles.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/rect.h"
+#include <cmath>
+
+namespace
+{
+
+// Random rotated rectangle related to R by kind: parallel or at a right
+// angle, apart, inside it, equal, sharing its centre, empty, or at random.
+RotatedRect relatedRect(Random &r, const RotatedRect &R, const int kind)
+{
+    const double pi = 3.14159265358979323846;
+    const double c = std::cos(R.theta), s = std::sin(R.theta);
+    const double u = r.uniform(-1.0, 1.0), v = r.uniform(-1.0, 1.0);
+    switch (kind) {
+    case 0:
+        return RotatedRect(R.center.x + u * R.w * c - v * R.h * s,
+                           R.center.y + u * R.w * s + v * R.h * c,
+                           r.uniform(1.0, 30.0), r.uniform(1.0, 30.0),
+                           R.theta + r.index(4) * pi / 2.0);
+    case 1:
+        return RotatedRect(R.center.x + (R.w + R.h + 30.0) * c,
+                           R.center.y + (R.w + R.h + 30.0) * s,
+                           r.uniform(1.0, 20.0), r.uniform(1.0, 20.0), r.uniform(0.0, pi));
+    case 2:
+        return RotatedRect(R.center.x, R.center.y, R.w * 0.3, R.h * 0.3,
+                           R.theta + r.uniform(-0.2, 0.2));
+    case 3:
+        return R;
+    case 4:
+        return RotatedRect(R.center.x, R.center.y, r.uniform(1.0, 30.0),
+                           r.uniform(1.0, 30.0), r.uniform(0.0, pi));
+    case 5:
+        return RotatedRect(R.center.x, R.center.y, 0.0, r.uniform(1.0, 30.0), 0.0);
+    default:
+        return RotatedRect(r.uniform(0.0, 100.0), r.uniform(0.0, 100.0),
+                           r.uniform(1.0, 30.0), r.uniform(1.0, 30.0), r.uniform(0.0, pi));
+    }
+}
+
+bool close(const double a, const double b, const double tol = 1e-14)
+{
+    return std::fabs(a - b) <= tol;
+}
+
+} // namespace
+
+// iou of RotatedRect and Rect against iou of their quads, to 1e-14, for
+// every InterMethod, on parallel, apart, nested, equal, concentric and
+// random pairs; -1 for empty rectangles; and long boxes nearly parallel or
+// at nearly a right angle.
+void testRect()
+{
+    const char *name = "rect";
+    const double pi = 3.14159265358979323846;
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    Random r(7);
+    for (int k = 0; k < 20000; ++k) {
+        const RotatedRect R(r.uniform(20.0, 80.0), r.uniform(20.0, 80.0),
+                            r.uniform(2.0, 30.0), r.uniform(2.0, 30.0),
+                            (k % 4 == 0) ? 0.0 : r.uniform(0.0, pi));
+        const RotatedRect S = relatedRect(r, R, k % 7);
+        const double x = r.uniform(0.0, 80.0), y = r.uniform(0.0, 80.0);
+        const Rect A(x, y, x + r.uniform(0.0, 30.0), y + r.uniform(0.0, 30.0));
+        const Rect B = (k % 5 == 0) ? A : Rect(A.x1 + r.uniform(-10.0, 10.0), A.y1,
+                                              A.x2 + r.uniform(-10.0, 10.0),
+                                              A.y2 + r.uniform(-10.0, 10.0));
+        const double rotated = iou(R, S), axis = iou(A, B);
+        if ((S.w <= 0.0) != (rotated == -1.0))
+            fail(name, "iou of an empty RotatedRect not -1", k);
+        if ((B.x2 <= B.x1 || B.y2 <= B.y1 || A.x2 <= A.x1 || A.y2 <= A.y1) != (axis == -1.0))
+            fail(name, "iou of an empty Rect not -1", k);
+        for (int m = 0; m < 3; ++m) {
+            // PointSoup may fail to order the intersection of the quads.
+            const double quad = iou(R.toQuad(), S.toQuad(), methods[m]);
+            if (rotated != -1.0 && !close(rotated, quad) &&
+                !(methods[m] == PointSoup && quad == -1.0))
+                fail(name, "iou of RotatedRect and of its quads differ", k);
+            const double axisQuad = iou(A.toQuad(), B.toQuad(), methods[m]);
+            if (axis != -1.0 && !close(axis, axisQuad) &&
+                !(methods[m] == PointSoup && axisQuad == -1.0))
+                fail(name, "iou of Rect and of its quads differ", k);
+        }
+    }
+
+    // Long boxes turned by 1e-7 to 1e-6 from each other, or from a right
+    // angle, where the bounding extents of the turned one overestimate.
+    // Sides up to 1000 to 1 round to 1e-12.
+    const RotatedRect reported[][2] = {
+        { RotatedRect(0, 0, 1000, 1, 0), RotatedRect(0, 0.5, 1000, 1, 9e-7) },
+        { RotatedRect(0, 0, 100, 10, 0), RotatedRect(3, 1, 100, 10, 9e-7) }
+    };
+    for (int k = 0; k < 2002; ++k) {
+        RotatedRect R, S;
+        if (k < 2) {
+            R = reported[k][0];
+            S = reported[k][1];
+        }
+        else {
+            const double w = r.uniform(100.0, 1000.0), h = r.uniform(1.0, 10.0);
+            R = RotatedRect(r.uniform(-10.0, 10.0), r.uniform(-10.0, 10.0), w, h,
+                            (k % 3 == 0) ? 0.0 : r.uniform(0.0, pi));
+            const double tilt = (k % 2 ? 1.0 : -1.0) * r.uniform(1e-7, 1e-6);
+            const bool right = k % 4 >= 2;
+            S = RotatedRect(R.center.x + r.uniform(-0.2, 0.2) * w,
+                            R.center.y + r.uniform(-1.0, 1.0) * h,
+                            right ? h : w, right ? w : h,
+                            R.theta + tilt + (right ? pi / 2.0 : 0.0));
+        }
+        const double rotated = iou(R, S);
+        for (int m = 1; m < 3; ++m)
+            if (!close(rotated, iou(R.toQuad(), S.toQuad(), methods[m]), 1e-12))
+                fail(name, "iou of nearly parallel RotatedRects and of their quads differ", k);
+    }
+}
@@ -0,0 +1,156 @@
+/***********************************
+ * regression.cpp
+ *
+ * Regression tests of the kernels, against
+ * brute force, RobustSoup or pinned results.
+ * Not using OpenCV, run by ctest.
+ *
+ * Usage: iou_regression [test]
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+
+int failures = 0;
+
+} // namespace
+
+void fail(const char *test, const char *what, const int k)
+{
+    static const char *last = 0;
+    static int count = 0;
+    count = (test == last) ? count + 1 : 1;
+    last = test;
+    if (count <= 10)
+        std::printf("%s: %s, case %d\n", test, what, k);
+    ++failures;
+}
+
+Vertexes ellipsePolygon(Random &r, const int n, const double cx, const double cy,
+                        const double rx, const double ry, const double angle,
+                        const WiseType wise)
+{
+    const double pi = 3.14159265358979323846;
+    std::vector<double> t(n);
+    for (int i = 0; i < n; ++i)
+        t[i] = r.uniform(0.0, 2.0 * pi);
+    std::sort(t.begin(), t.end());
+    if (wise == ClockWise)
+        std::reverse(t.begin(), t.end());
+    const double c = std::cos(angle), s = std::sin(angle);
+    Vertexes C(n);
+    for (int i = 0; i < n; ++i) {
+        const double x = rx * std::cos(t[i]), y = ry * std::sin(t[i]);
+        C[i] = Point(cx + x * c - y * s, cy + x * s + y * c);
+    }
+    return C;
+}
+Vertexes randomPolygon(Random &r, const double cx, const double cy, const double size)
+{
+    for (;;) {
+        const Vertexes C = ellipsePolygon(r, 3 + r.index(6), cx, cy,
+                                          size * r.uniform(0.3, 1.0), size * r.uniform(0.3, 1.0),
+                                          r.uniform(0.0, 3.0),
+                                          r.index(2) ? ClockWise : AntiClockWise);
+        if (whichWiseEx(C) != NoneWise)
+            return C;
+    }
+}
+Quad randomQuad(Random &r, const double cx, const double cy, const double size)
+{
+    for (;;) {
+        const Vertexes C = ellipsePolygon(r, 4, cx, cy, size * r.uniform(0.3, 1.0),
+                                          size * r.uniform(0.3, 1.0), r.uniform(0.0, 3.0),
+                                          r.index(2) ? ClockWise : AntiClockWise);
+        if (whichWiseEx(C) != NoneWise)
+            return Quad(C.data());
+    }
+}
+std::vector<Vertexes> randomPolygons(Random &r, const int n, const double extent,
+                                     const double size)
+{
+    std::vector<Vertexes> P(n);
+    for (int i = 0; i < n; ++i) {
+        P[i] = randomPolygon(r, r.uniform(0.0, extent), r.uniform(0.0, extent), size);
+        if (i % 50 == 49)
+            P[i][2] = P[i][0] + (P[i][0] - P[i][1]);
+    }
+    return P;
+}
+std::vector<Quad> randomQuads(Random &r, const int n, const double extent, const double size)
+{
+    std::vector<Quad> Q(n);
+    for (int i = 0; i < n; ++i)
+        Q[i] = randomQuad(r, r.uniform(0.0, extent), r.uniform(0.0, extent), size);
+    return Q;
+}
+
+bool samePairs(const std::vector<IouPair> &a, const std::vector<IouPair> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t k = 0; k < a.size(); ++k) {
+        if (a[k].i != b[k].i || a[k].j != b[k].j || !(a[k].iou == b[k].iou))
+            return false;
+    }
+    return true;
+}
+
+namespace
+{
+
+struct Test {
+    const char *name;
+    void (*run)();
+};
+const Test tests[] = {
+    { "order", testOrder },
+    { "robust", testRobust },
+    { "incremental", testIncremental },
+    { "rtree", testRTree },
+    { "join", testJoin },
+    { "shard", testShard },
+    { "hull", testHull },
+    { "nms", testNms },
+    { "simd", testSimd },
+    { "parallel", testParallel },
+    { "matrix", testMatrix },
+    { "evaluator", testEvaluator },
+    { "intersection", testIntersection },
+    { "gpu", testGpu },
+    { "bounds", testBounds },
+    { "metrics", testMetrics },
+    { "convexset", testConvexSet },
+    { "fixed", testFixed },
+    { "rect", testRect },
+    { "view", testView },
+    { "stats", testStats }
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const int N = sizeof(tests) / sizeof(tests[0]);
+    bool found = false;
+    for (int k = 0; k < N; ++k) {
+        if (argc > 1 && std::strcmp(argv[1], tests[k].name) != 0)
+            continue;
+        found = true;
+        const int before = failures;
+        tests[k].run();
+        std::printf("%s: %s\n", tests[k].name, failures == before ? "passed" : "FAILED");
+    }
+    if (!found) {
+        std::printf("Usage: iou_regression [test]\n");
+        return 2;
+    }
+    return failures == 0 ? 0 : 1;
+}
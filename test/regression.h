@@ -0,0 +1,75 @@
+/***********************************
+ * regression.h
+ *
+ * Helpers shared by the regression tests,
+ * one file of tests per feature.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+#ifndef _IOU_REGRESSION_H_FILE_
+#define _IOU_REGRESSION_H_FILE_
+
+#include "../src/join.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace IOU;
+
+// Report a failure of test on case k, the first few of each test only.
+void fail(const char *test, const char *what, const int k);
+
+class Random {
+public:
+    explicit Random(const unsigned int seed) : rng(seed) {}
+    double uniform(const double a, const double b) {
+        return std::uniform_real_distribution<double>(a, b)(rng);
+    }
+    int index(const int n) { return int(rng() % (unsigned int)n); }
+    template <class It>
+    void shuffle(It begin, It end) { std::shuffle(begin, end, rng); }
+
+private:
+    std::mt19937 rng;
+};
+
+// Convex polygon of n vertexes on the ellipse of radii rx, ry around
+// (cx, cy), turned by angle, in wise.
+Vertexes ellipsePolygon(Random &r, const int n, const double cx, const double cy,
+                        const double rx, const double ry, const double angle,
+                        const WiseType wise);
+// Convex polygon of 3 to 8 vertexes of size about `size` at (cx, cy),
+// redrawn until it is not NoneWise.
+Vertexes randomPolygon(Random &r, const double cx, const double cy, const double size);
+Quad randomQuad(Random &r, const double cx, const double cy, const double size);
+// Scattered over [0, extent)^2, one in 50 made NoneWise.
+std::vector<Vertexes> randomPolygons(Random &r, const int n, const double extent,
+                                     const double size);
+std::vector<Quad> randomQuads(Random &r, const int n, const double extent, const double size);
+
+bool samePairs(const std::vector<IouPair> &a, const std::vector<IouPair> &b);
+
+// The tests, each in the file of its feature.
+void testOrder();
+void testRobust();
+void testIncremental();
+void testRTree();
+void testJoin();
+void testShard();
+void testHull();
+void testNms();
+void testSimd();
+void testParallel();
+void testMatrix();
+void testEvaluator();
+void testIntersection();
+void testGpu();
+void testBounds();
+void testMetrics();
+void testConvexSet();
+void testFixed();
+void testRect();
+void testView();
+void testStats();
+
+#endif // !_IOU_REGRESSION_H_FILE_
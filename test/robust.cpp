@@ -0,0 +1,43 @@
+/***********************************
+ * robust.cpp
+ *
+ * Regression tests of the RobustSoup
+ * intersection.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cmath>
+
+// RobustSoup never fails on convex pairs, degenerate ones included, and
+// agrees with ConvexClip.
+void testRobust()
+{
+    const char *name = "robust";
+    Random r(12);
+    for (int k = 0; k < 20000; ++k) {
+        const Vertexes A = randomPolygon(r, r.uniform(20.0, 80.0), r.uniform(20.0, 80.0), 30.0);
+        Vertexes B = randomPolygon(r, r.uniform(20.0, 80.0), r.uniform(20.0, 80.0), 30.0);
+        if (k % 5 == 0)
+            B = A;
+        else if (k % 5 == 1) {
+            B = A;
+            for (size_t i = 0; i < B.size(); ++i)
+                B[i].x += 1e-9;
+        }
+        else if (k % 5 == 2) {
+            // Mirrored about the vertical through A[0], touching there.
+            B = A;
+            for (size_t i = 0; i < B.size(); ++i)
+                B[i].x = 2.0 * A[0].x - B[i].x;
+            std::reverse(B.begin(), B.end());
+        }
+        const double robust = areaIntersectionEx(A, B, RobustSoup);
+        const double clip = areaIntersectionEx(A, B, ConvexClip);
+        if (robust < 0.0)
+            fail(name, "RobustSoup returned -1", k);
+        else if (clip >= 0.0 && std::fabs(robust - clip) > 1e-13 * std::max(1.0, clip))
+            fail(name, "RobustSoup and ConvexClip differ", k);
+    }
+}
@@ -0,0 +1,70 @@
+/***********************************
+ * rtree.cpp
+ *
+ * Regression tests of the packed R-tree.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/rtree.h"
+
+// Threshold and top-k queries of the R-tree against every polygon. Those
+// whose bounding box misses that of the query have an iou of 0, neither
+// above a threshold >= 0 nor positive, and are not computed.
+void testRTree()
+{
+    const char *name = "rtree";
+    Random r(15);
+    const std::vector<Vertexes> P = randomPolygons(r, 20000, 1000.0, 10.0);
+    const std::vector<Quad> Q = randomQuads(r, 20000, 1000.0, 10.0);
+    const PolygonRTree TP(P), TQ(Q);
+    const double thresholds[] = { 0.0, 0.3 };
+    const int K = 5;
+    for (int k = 0; k < 300; ++k) {
+        const Vertexes query = randomPolygon(r, r.uniform(0.0, 1000.0),
+                                             r.uniform(0.0, 1000.0), 15.0);
+        const Quad quadQuery = randomQuad(r, r.uniform(0.0, 1000.0), r.uniform(0.0, 1000.0), 15.0);
+        const AABB box = boundingBoxEx(query), quadBox = quadQuery.boundingBox();
+
+        std::vector<std::pair<double, int> > ious, quadIous;
+        for (int i = 0; i < (int)P.size(); ++i) {
+            if (boundingBoxEx(P[i]).overlaps(box))
+                ious.push_back(std::make_pair(iouEx(query, P[i]), i));
+            if (Q[i].boundingBox().overlaps(quadBox))
+                quadIous.push_back(std::make_pair(iou(quadQuery, Q[i]), i));
+        }
+        for (int t = 0; t < 2; ++t) {
+            std::vector<int> above, quadAbove;
+            for (size_t m = 0; m < ious.size(); ++m)
+                if (ious[m].first > thresholds[t])
+                    above.push_back(ious[m].second);
+            for (size_t m = 0; m < quadIous.size(); ++m)
+                if (quadIous[m].first > thresholds[t])
+                    quadAbove.push_back(quadIous[m].second);
+            if (TP.queryAbove(query, thresholds[t]) != above)
+                fail(name, "queryAbove differs", k);
+            if (TQ.queryAbove(quadQuery, thresholds[t]) != quadAbove)
+                fail(name, "queryAbove(Quad) differs", k);
+        }
+
+        // By decreasing iou then ascending index.
+        for (int q = 0; q < 2; ++q) {
+            std::vector<std::pair<double, int> > &S = q ? quadIous : ious;
+            std::vector<std::pair<double, int> > best;
+            for (size_t m = 0; m < S.size(); ++m)
+                if (S[m].first > 0.0)
+                    best.push_back(std::make_pair(-S[m].first, S[m].second));
+            std::sort(best.begin(), best.end());
+            best.resize(std::min((int)best.size(), K));
+            std::vector<double> topIous;
+            const std::vector<int> top = q ? TQ.topK(quadQuery, K, &topIous)
+                                           : TP.topK(query, K, &topIous);
+            bool same = top.size() == best.size();
+            for (size_t m = 0; same && m < best.size(); ++m)
+                same = top[m] == best[m].second && topIous[m] == -best[m].first;
+            if (!same)
+                fail(name, q ? "topK(Quad) differs" : "topK differs", k);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/***********************************
+ * shard.cpp
+ *
+ * Regression tests of the sharded join.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/shard.h"
+#include <cstdio>
+#include <limits>
+
+// Every tile of a plan read back from its file, joined and merged, against
+// iouJoinPairsEx of the whole sets.
+void testShard()
+{
+    const char *name = "shard";
+    const std::string pathA = "regression_a.poly";
+    const std::string pathB = "regression_b.poly";
+    const std::string pathPlan = "regression.plan";
+    Random r(30);
+    const std::vector<Vertexes> A = randomPolygons(r, 3000, 300.0, 8.0);
+    const std::vector<Vertexes> B = randomPolygons(r, 2000, 300.0, 8.0);
+    PolygonFile FA, FB;
+    if (!writePolygonFile(pathA, A) || !writePolygonFile(pathB, B, 0) ||
+        !FA.open(pathA) || !FB.open(pathB)) {
+        fail(name, "cannot write the polygon files", 0);
+        return;
+    }
+    const double thresh = 0.1;
+    const std::vector<IouPair> joined = iouJoinPairsEx(A, B, thresh);
+    std::vector<IouPair> selfJoined;
+    const std::vector<IouPair> all = iouJoinPairsEx(A, A, thresh);
+    for (size_t k = 0; k < all.size(); ++k)
+        if (all[k].i < all[k].j)
+            selfJoined.push_back(all[k]);
+
+    const int tileCounts[] = { 1, 7, 16, 37 };
+    for (int c = 0; c < 4; ++c) {
+        for (int self = 0; self < 2; ++self) {
+            ShardPlan plan;
+            if (self)
+                plan.build(FA, tileCounts[c]);
+            else
+                plan.build(FA, FB, tileCounts[c]);
+            const int T = plan.write(pathPlan) ? shardTileCount(pathPlan) : -1;
+            if (T != plan.size()) {
+                fail(name, "cannot read the plan back", c);
+                continue;
+            }
+            const double inf = std::numeric_limits<double>::infinity();
+            if (plan.tileBox(0).xMin != -inf || plan.tileBox(0).yMin != -inf ||
+                plan.tileBox(T - 1).xMax != inf || plan.tileBox(T - 1).yMax != inf)
+                fail(name, "outer tiles do not reach infinity", tileCounts[c]);
+            std::vector<std::vector<IouPair> > parts(T);
+            ShardTile tile;
+            bool ok = true;
+            for (int t = 0; t < T; ++t)
+                ok = ok && readShardTile(pathPlan, t, tile) &&
+                     shardJoin(FA, FB, tile, thresh, parts[t]);
+            // A tile run twice is merged once.
+            if (T > 0)
+                parts.push_back(parts[0]);
+            if (!ok || !samePairs(mergeShardPairs(parts), self ? selfJoined : joined))
+                fail(name, self ? "self join differs" : "join differs", tileCounts[c]);
+        }
+    }
+
+    ShardTile bad;
+    bad.box = AABB();
+    bad.selfJoin = true;
+    bad.membersA.push_back(FA.size());
+    std::vector<IouPair> pairs;
+    if (shardJoin(FA, FB, bad, thresh, pairs))
+        fail(name, "shardJoin accepted a member outside its file", 0);
+
+    FA.close();
+    FB.close();
+    std::remove(pathA.c_str());
+    std::remove(pathB.c_str());
+    std::remove(pathPlan.c_str());
+}
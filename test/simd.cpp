@@ -0,0 +1,149 @@
+/***********************************
+ * simd.cpp
+ *
+ * Regression tests of the SIMD one-vs-many
+ * iou of rectangles.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/simd.h"
+#include <cmath>
+
+namespace
+{
+
+// Rounded to float, so that the double iou sees the inputs of the batch.
+double f(const double v)
+{
+    return (float)v;
+}
+
+// Random rotated rectangle around the query, or parallel to it, apart
+// from it, inside it, around it, equal to it or empty, by kind.
+RotatedRect relatedRect(Random &r, const RotatedRect &q, const int kind)
+{
+    const double pi = 3.14159265358979323846;
+    const double c = std::cos(q.theta), s = std::sin(q.theta);
+    const double u = r.uniform(-1.0, 1.0), v = r.uniform(-1.0, 1.0);
+    switch (kind) {
+    case 0: // Parallel or at a right angle, shifted.
+        return RotatedRect(f(q.center.x + u * q.w * c - v * q.h * s),
+                           f(q.center.y + u * q.w * s + v * q.h * c),
+                           f(r.uniform(1.0, 30.0)), f(r.uniform(1.0, 30.0)),
+                           q.theta + r.index(4) * pi / 2.0);
+    case 1: // Apart, along the w axis of the query.
+        return RotatedRect(f(q.center.x + (q.w + q.h + 30.0) * c),
+                           f(q.center.y + (q.w + q.h + 30.0) * s),
+                           f(r.uniform(1.0, 20.0)), f(r.uniform(1.0, 20.0)),
+                           r.uniform(0.0, pi));
+    case 2: // Inside the query.
+        return RotatedRect(f(q.center.x + u * 0.1 * q.w * c), f(q.center.y + u * 0.1 * q.w * s),
+                           f(q.w * 0.3), f(q.h * 0.3), q.theta + r.uniform(-0.2, 0.2));
+    case 3: // Around the query.
+        return RotatedRect(f(q.center.x), f(q.center.y), f(q.w * 3.0 + q.h), f(q.h * 3.0 + q.w),
+                           r.uniform(0.0, pi));
+    case 4:
+        return q;
+    case 5:
+        return RotatedRect(f(q.center.x), f(q.center.y), 0.0, f(r.uniform(1.0, 30.0)), 0.0);
+    default:
+        return RotatedRect(f(r.uniform(0.0, 100.0)), f(r.uniform(0.0, 100.0)),
+                           f(r.uniform(1.0, 30.0)), f(r.uniform(1.0, 30.0)), r.uniform(0.0, pi));
+    }
+}
+
+// Long rectangle turned by 1e-7 to 1e-6 from the long query, or from a
+// right angle to it, and shifted along it.
+RotatedRect nearlyParallel(Random &r, const RotatedRect &q, const int kind)
+{
+    const double pi = 3.14159265358979323846;
+    const double c = std::cos(q.theta), s = std::sin(q.theta);
+    const double u = r.uniform(-0.3, 0.3) * q.w, v = r.uniform(-1.0, 1.0) * q.h;
+    const double tilt = (kind % 2 ? 1.0 : -1.0) * r.uniform(1e-7, 1e-6);
+    const double w = r.uniform(0.5, 1.0) * q.w, h = r.uniform(0.5, 2.0) * q.h;
+    const bool right = kind >= 2;
+    return RotatedRect(f(q.center.x + u * c - v * s), f(q.center.y + u * s + v * c),
+                       f(right ? h : w), f(right ? w : h),
+                       q.theta + tilt + (right ? pi / 2.0 : 0.0));
+}
+
+// The double iou of the quads of the rectangles, -1 if either is empty as
+// for the batch.
+double quadIou(const RotatedRect &q, const RotatedRect &R)
+{
+    if (!(q.w > 0.0 && q.h > 0.0 && R.w > 0.0 && R.h > 0.0))
+        return -1.0;
+    return iou(q.toQuad(), R.toQuad(), ConvexClip);
+}
+
+Rect relatedRect(Random &r, const Rect &q, const int kind)
+{
+    const double x = r.uniform(q.x1, q.x2), y = r.uniform(q.y1, q.y2);
+    switch (kind) {
+    case 0: // Sharing an edge line.
+        return Rect(q.x1, f(y), f(q.x2 + r.uniform(0.0, 10.0)), f(y + r.uniform(1.0, 20.0)));
+    case 1: // Apart.
+        return Rect(f(q.x2 + 1.0), q.y1, f(q.x2 + 10.0), q.y2);
+    case 2: // Inside the query.
+        return Rect(f(x), f(y), f(x + (q.x2 - x) * 0.5), f(y + (q.y2 - y) * 0.5));
+    case 3: // Around the query.
+        return Rect(f(q.x1 - 3.0), f(q.y1 - 2.0), f(q.x2 + 1.0), f(q.y2 + 5.0));
+    case 4:
+        return q;
+    case 5:
+        return Rect(f(x), f(y), f(x), f(y + 3.0));
+    default:
+        return Rect(f(x - 15.0), f(y - 15.0), f(x + r.uniform(0.5, 20.0)),
+                    f(y + r.uniform(0.5, 20.0)));
+    }
+}
+
+} // namespace
+
+// iouOneToMany at every level against the double iou of Rect and of the
+// quads of RotatedRect, within 2e-4, also for long rectangles nearly
+// parallel or at nearly a right angle. A level the CPU lacks runs the one
+// below it, which is then checked twice.
+void testSimd()
+{
+    const char *name = "simd";
+    const double pi = 3.14159265358979323846;
+    const SimdLevel levels[] = { SimdScalar, SimdSSE2, SimdAVX2, SimdNEON, SimdAuto };
+    Random r(8);
+    for (int k = 0; k < 500; ++k) {
+        // Not a multiple of the lane counts, for the tails.
+        const int N = 37 + r.index(40);
+        const bool thin = k % 5 == 4;
+        const RotatedRect query(f(r.uniform(20.0, 80.0)), f(r.uniform(20.0, 80.0)),
+                                f(thin ? r.uniform(100.0, 500.0) : r.uniform(2.0, 30.0)),
+                                f(thin ? r.uniform(1.0, 5.0) : r.uniform(2.0, 30.0)),
+                                (k % 4 == 0) ? 0.0 : r.uniform(0.0, pi));
+        const double x1 = f(r.uniform(0.0, 80.0)), y1 = f(r.uniform(0.0, 80.0));
+        const Rect rectQuery(x1, y1, f(x1 + r.uniform(2.0, 30.0)), f(y1 + r.uniform(2.0, 30.0)));
+        RotatedRectBatch batch;
+        RectBatch rectBatch;
+        std::vector<double> expected(N), rectExpected(N);
+        for (int i = 0; i < N; ++i) {
+            const RotatedRect R = thin ? nearlyParallel(r, query, i % 4)
+                                       : relatedRect(r, query, i % 7);
+            const Rect S = relatedRect(r, rectQuery, i % 7);
+            batch.push_back(R);
+            rectBatch.push_back(S);
+            expected[i] = quadIou(query, R);
+            rectExpected[i] = iou(rectQuery, S);
+        }
+        for (int l = 0; l < 5; ++l) {
+            std::vector<float> out(N), rectOut(N);
+            iouOneToMany(query, batch, out.data(), levels[l]);
+            iouOneToMany(rectQuery, rectBatch, rectOut.data(), levels[l]);
+            for (int i = 0; i < N; ++i) {
+                if (!(std::fabs(out[i] - expected[i]) <= 2e-4))
+                    fail(name, "rotated iou differs", k);
+                if (!(std::fabs(rectOut[i] - rectExpected[i]) <= 2e-4))
+                    fail(name, "rect iou differs", k);
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/***********************************
+ * stats.cpp
+ *
+ * Regression tests of the counters and stage
+ * timings of the intersection paths.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include "../src/stats.h"
+#include <cstdio>
+
+namespace
+{
+
+Quad square(const double x, const double y, const double size)
+{
+    return Quad(Point(x, y), Point(x, y + size), Point(x + size, y + size), Point(x + size, y));
+}
+
+// Stage calls of one intersection of two quads at method.
+void expectedStages(const InterMethod method, uint64_t stages[StatStageCount])
+{
+    for (int s = 0; s < StatStageCount; ++s)
+        stages[s] = 0;
+    if (method == PointSoup) {
+        stages[StageInterPoints] = 1;
+        stages[StageInnerPoints] = 2;
+        stages[StageOrder] = 1;
+    }
+    else
+        stages[StageClip] = 1;
+    stages[StageArea] = 1;
+}
+
+} // namespace
+
+// The counters of a few pairs of quads, for every InterMethod: one
+// overlapping, one disjoint and one NoneWise, every pair counted once as
+// NoneWise, rejected or intersected, and the stages run by each method;
+// then resetStats zeroing them. Skipped when built without
+// IOU_ENABLE_STATS.
+void testStats()
+{
+    const char *name = "stats";
+    if (!statsEnabled()) {
+        std::printf("stats: skipped, built without IOU_ENABLE_STATS\n");
+        return;
+    }
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    const Quad A = square(0, 0, 10), B = square(5, 5, 10), far = square(30, 30, 10);
+    const Quad flat(Point(0, 0), Point(5, 5), Point(10, 10), Point(0, 0));
+    for (int m = 0; m < 3; ++m) {
+        resetStats();
+        IouStats s = collectStats();
+        for (int c = 0; c < StatCounterCount; ++c)
+            if (s.counters[c] != 0)
+                fail(name, "counter not zero after resetStats", m);
+        for (int k = 0; k < StatStageCount; ++k)
+            if (s.stageCalls[k] != 0 || s.stageNanoseconds[k] != 0)
+                fail(name, "stage not zero after resetStats", m);
+
+        if (areaIntersection(A, B, methods[m]) != 25.0 ||
+            areaIntersection(A, far, methods[m]) != 0.0 ||
+            areaIntersection(A, flat, methods[m]) != -1.0)
+            fail(name, "areaIntersection of the quads wrong", m);
+        s = collectStats();
+        const uint64_t *n = s.counters;
+        if (n[StatPairs] != 3 || n[StatNoneWise] != 1 || n[StatRejected] != 1 ||
+            n[StatIntersections] != 1)
+            fail(name, "pairs not counted once as NoneWise, rejected or intersected", m);
+        if (n[StatPairs] != n[StatNoneWise] + n[StatRejected] + n[StatIntersections])
+            fail(name, "pairs not the sum of NoneWise, rejected and intersected", m);
+        if (n[StatSoupFailures] != 0 || n[StatInterVertexes] != 4)
+            fail(name, "soup failures or intersection vertexes wrong", m);
+        uint64_t stages[StatStageCount];
+        expectedStages(methods[m], stages);
+        for (int k = 0; k < StatStageCount; ++k)
+            if (s.stageCalls[k] != stages[k])
+                fail(name, "stage calls wrong", m);
+    }
+    resetStats();
+    const IouStats s = collectStats();
+    if (s.counters[StatPairs] != 0 || s.stageCalls[StageArea] != 0)
+        fail(name, "counters not zero after resetStats", 3);
+}
@@ -0,0 +1,171 @@
+/***********************************
+ * view.cpp
+ *
+ * Regression tests of the polygon views over
+ * caller-owned vertexes and coordinates.
+ *
+ * Github: https://github.com/CheckBoxStudio/IoU
+ ***********************************/
+
+#include "regression.h"
+#include <cstring>
+
+namespace
+{
+
+template <typename T>
+bool sameBits(const T a, const T b)
+{
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+template <typename T>
+bool sameBits(const AABBT<T> &a, const AABBT<T> &b)
+{
+    return sameBits(a.xMin, b.xMin) && sameBits(a.yMin, b.yMin) &&
+           sameBits(a.xMax, b.xMax) && sameBits(a.yMax, b.yMax);
+}
+template <typename T>
+bool sameBits(const std::vector<Vec2<T> > &a, const std::vector<Vec2<T> > &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (!sameBits(a[i].x, b[i].x) || !sameBits(a[i].y, b[i].y))
+            return false;
+    return true;
+}
+
+// The vertexes of C, in T, in every layout a view reads: in the middle of
+// an array of points, as interleaved x,y pairs, as separate x and y
+// arrays, and as x,y,z records.
+template <typename T>
+struct Layouts {
+    std::vector<Vec2<T> > vert;
+    std::vector<Vec2<T> > padded;
+    std::vector<T> xy, x, y, xyz;
+
+    explicit Layouts(const Vertexes &C) : padded(1, Vec2<T>(T(-7), T(-7))) {
+        for (size_t i = 0; i < C.size(); ++i) {
+            const Vec2<T> p((T)C[i].x, (T)C[i].y);
+            vert.push_back(p);
+            padded.push_back(p);
+            xy.push_back(p.x);
+            xy.push_back(p.y);
+            x.push_back(p.x);
+            y.push_back(p.y);
+            xyz.push_back(p.x);
+            xyz.push_back(p.y);
+            xyz.push_back(T(-7));
+        }
+        padded.push_back(Vec2<T>(T(7), T(7)));
+    }
+    PolygonViewT<T> view() const { return PolygonViewT<T>(&padded[1], vert.size()); }
+    StridedPolygonViewT<T> strided(const int layout) const {
+        const size_t n = vert.size();
+        if (layout == 0)
+            return StridedPolygonViewT<T>(xy.data(), n);
+        if (layout == 1)
+            return StridedPolygonViewT<T>(x.data(), y.data(), n, 1);
+        return StridedPolygonViewT<T>(xyz.data(), xyz.data() + 1, n, 3);
+    }
+};
+
+// Every PolygonView and StridedPolygonView overload against the Vertexes
+// one, bit for bit.
+template <typename T>
+void checkViews(const char *name, const Vertexes &A, const Vertexes &B, const int k)
+{
+    const InterMethod methods[] = { PointSoup, ConvexClip, RobustSoup };
+    const Layouts<T> LA(A), LB(B);
+    const std::vector<Vec2<T> > &CA = LA.vert, &CB = LB.vert;
+    const PolygonViewT<T> VA = LA.view(), VB = LB.view();
+    const Vec2<T> probes[] = { CA[0], (CA[0] + CA[1]) * T(0.5), CB[0], Vec2<T>(T(30), T(30)) };
+    const LineT<T> line(CB[0], CB[1]);
+
+    std::vector<Vec2<T> > expected, got;
+    if (!sameBits(boundingBoxEx(VA), boundingBoxEx(CA)) ||
+        !sameBits(areaEx(VA), areaEx(CA)) || whichWiseEx(VA) != whichWiseEx(CA))
+        fail(name, "PolygonView differs on one polygon", k);
+    for (int p = 0; p < 4; ++p)
+        if (locationEx(VA, probes[p]) != locationEx(CA, probes[p]))
+            fail(name, "locationEx of PolygonView differs", k);
+    if (interPtsEx(VA, line, got) != interPtsEx(CA, line, expected) ||
+        !sameBits(got, expected))
+        fail(name, "interPtsEx of PolygonView differs", k);
+    if (findInterPointsEx(VA, VB, got) != findInterPointsEx(CA, CB, expected) ||
+        !sameBits(got, expected) ||
+        findInnerPointsEx(VA, VB, got) != findInnerPointsEx(CA, CB, expected) ||
+        !sameBits(got, expected) ||
+        clipConvexEx(VA, VB, got) != clipConvexEx(CA, CB, expected) ||
+        !sameBits(got, expected))
+        fail(name, "intersection points of PolygonView differ", k);
+    for (int m = 0; m < 3; ++m) {
+        if (!sameBits(areaIntersectionEx(VA, VB, methods[m]),
+                      areaIntersectionEx(CA, CB, methods[m])) ||
+            !sameBits(areaUnionEx(VA, VB, methods[m]), areaUnionEx(CA, CB, methods[m])) ||
+            !sameBits(iouEx(VA, VB, methods[m]), iouEx(CA, CB, methods[m])))
+            fail(name, "iouEx of PolygonView differs", k);
+        if (intersectionPolygonEx(VA, VB, got, methods[m]) !=
+                intersectionPolygonEx(CA, CB, expected, methods[m]) ||
+            !sameBits(got, expected))
+            fail(name, "intersectionPolygonEx of PolygonView differs", k);
+    }
+
+    for (int l = 0; l < 3; ++l) {
+        const StridedPolygonViewT<T> SA = LA.strided(l), SB = LB.strided(l);
+        if (!sameBits(boundingBoxEx(SA), boundingBoxEx(CA)) ||
+            !sameBits(areaEx(SA), areaEx(CA)) || whichWiseEx(SA) != whichWiseEx(CA))
+            fail(name, "StridedPolygonView differs on one polygon", k);
+        for (int p = 0; p < 4; ++p)
+            if (locationEx(SA, probes[p]) != locationEx(CA, probes[p]))
+                fail(name, "locationEx of StridedPolygonView differs", k);
+        for (int m = 0; m < 3; ++m) {
+            if (!sameBits(areaIntersectionEx(SA, SB, methods[m]),
+                          areaIntersectionEx(CA, CB, methods[m])) ||
+                !sameBits(areaUnionEx(SA, SB, methods[m]), areaUnionEx(CA, CB, methods[m])) ||
+                !sameBits(iouEx(SA, SB, methods[m]), iouEx(CA, CB, methods[m])))
+                fail(name, "iouEx of StridedPolygonView differs", k);
+        }
+    }
+}
+
+} // namespace
+
+// Every PolygonView and StridedPolygonView overload against the Vertexes
+// one, bit for bit, in double and float: views into the middle of a
+// buffer, interleaved, separate and record coordinates, NoneWise polygons,
+// more vertexes than the stack buffer of the strided view, and a pair
+// touching at a corner.
+void testView()
+{
+    const char *name = "view";
+    Random r(18);
+    for (int k = 0; k < 2000; ++k) {
+        Vertexes A = randomPolygon(r, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0), 10.0);
+        Vertexes B = randomPolygon(r, r.uniform(20.0, 40.0), r.uniform(20.0, 40.0), 10.0);
+        if (k % 10 == 0)
+            B = ellipsePolygon(r, 33 + r.index(20), r.uniform(20.0, 40.0), r.uniform(20.0, 40.0),
+                               r.uniform(5.0, 10.0), r.uniform(5.0, 10.0), r.uniform(0.0, 3.0),
+                               r.index(2) ? ClockWise : AntiClockWise);
+        else if (k % 10 == 1)
+            A[2] = A[0];
+        else if (k % 10 == 2)
+            B = A;
+        checkViews<double>(name, A, B, k);
+        checkViews<float>(name, A, B, k);
+    }
+
+    // Touching at a corner in float, a PointSoup soup of 2 points.
+    const double touching[][2] = {
+        { 17.443836212158203, 32.544845581054688 }, { 18.888463973999023, 26.008543014526367 },
+        { 26.049341201782227, 25.992647171020508 }, { 26.211183547973633, 26.575965881347656 },
+        { 26.469623565673828, 30.937080383300781 }, { 26.253463745117188, 32.412761688232422 },
+        { 25.895526885986328, 33.851459503173828 },
+        { 18.786228179931641, 26.472755432128906 }, { 13.439206123352051, 25.928293228149414 },
+        { 13.09555721282959, 25.286222457885742 }
+    };
+    Vertexes TA, TB;
+    for (int i = 0; i < 10; ++i)
+        (i < 7 ? TA : TB).push_back(Point(touching[i][0], touching[i][1]));
+    checkViews<float>(name, TA, TB, 2000);
+}